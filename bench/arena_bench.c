@@ -0,0 +1,77 @@
+/*
+  Parse and release the generated package registry with one allocation per item (cJSON_ParseWithLength and
+  cJSON_Delete) and from an arena (cJSON_ParseWithArena and cJSON_ArenaFree).
+
+  The first run of each shows the cost of touching fresh memory, the best run the cost once the allocator hands back
+  memory that was used before. Arena chunks are large, so whether they are reused depends on the allocator's mmap
+  threshold; run the arena first to see it on its own.
+
+  usage: arena_bench [records] [arena-first]
+*/
+
+#include "bench.h"
+#include "cJSON.h"
+
+static void measure(const bench_text* const text, const int arena)
+{
+    double first_parse = 0;
+    double best_parse = 0;
+    double best_free = 0;
+    int run = 0;
+
+    for (run = 0; run < BENCH_RUNS; run++)
+    {
+        double start = bench_now_ms();
+        double parsed = 0;
+        double freed = 0;
+        cJSON* document = arena ? cJSON_ParseWithArena(text->text, text->length) : cJSON_ParseWithLength(text->text, text->length);
+
+        parsed = bench_now_ms();
+        if (document == NULL)
+        {
+            fprintf(stderr, "parse failed\n");
+            exit(EXIT_FAILURE);
+        }
+        if (arena)
+        {
+            cJSON_ArenaFree(document);
+        }
+        else
+        {
+            cJSON_Delete(document);
+        }
+        freed = bench_now_ms();
+
+        if (run == 0)
+        {
+            first_parse = parsed - start;
+        }
+        if ((run == 0) || ((parsed - start) < best_parse))
+        {
+            best_parse = parsed - start;
+        }
+        if ((run == 0) || ((freed - parsed) < best_free))
+        {
+            best_free = freed - parsed;
+        }
+    }
+
+    bench_report(arena ? "cJSON_ParseWithArena, first" : "cJSON_ParseWithLength, first", first_parse, text->length);
+    bench_report(arena ? "cJSON_ParseWithArena, best" : "cJSON_ParseWithLength, best", best_parse, text->length);
+    bench_report(arena ? "cJSON_ArenaFree, best" : "cJSON_Delete, best", best_free, text->length);
+}
+
+int main(int argc, char** argv)
+{
+    size_t records = (argc > 1) ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    int arena_first = (argc > 2) && (atoi(argv[2]) != 0);
+    bench_text text = { NULL, 0, 0 };
+
+    bench_document(&text, records, 0);
+
+    printf("%lu records, %lu bytes\n", (unsigned long)records, (unsigned long)text.length);
+    measure(&text, arena_first);
+    measure(&text, !arena_first);
+    free(text.text);
+    return EXIT_SUCCESS;
+}
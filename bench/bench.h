@@ -0,0 +1,157 @@
+/*
+  Shared helpers for the benchmark drivers in bench/. The inputs are generated from a fixed seed, so every run
+  measures the same document. Times are wall-clock milliseconds, the best of several runs is reported.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+/* for clock_gettime */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RUNS 7
+
+static inline double bench_now_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((double)now.tv_sec * 1000.0) + ((double)now.tv_nsec / 1000000.0);
+}
+
+/* xorshift64 with a fixed seed */
+static uint64_t bench_random_state = UINT64_C(0x9E3779B97F4A7C15);
+
+static inline uint64_t bench_random(void)
+{
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 7;
+    bench_random_state ^= bench_random_state << 17;
+    return bench_random_state;
+}
+
+/* a growing text buffer for building the input documents */
+typedef struct
+{
+    char* text;
+    size_t length;
+    size_t capacity;
+} bench_text;
+
+static inline void bench_append(bench_text* const text, const char* const piece, const size_t length)
+{
+    if ((text->length + length + 1) > text->capacity)
+    {
+        text->capacity = (text->capacity + length + 1) * 2;
+        text->text = (char*)realloc(text->text, text->capacity);
+        if (text->text == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(text->text + text->length, piece, length);
+    text->length += length;
+    text->text[text->length] = '\0';
+}
+
+static inline void bench_append_string(bench_text* const text, const char* const piece)
+{
+    bench_append(text, piece, strlen(piece));
+}
+
+static inline void bench_indent(bench_text* const text, const int pretty, const int depth)
+{
+    static const char spaces[] = "                ";
+
+    if (pretty)
+    {
+        bench_append(text, "\n", 1);
+        bench_append(text, spaces, (size_t)(depth * 2));
+    }
+}
+
+/* A package-registry-like document: an array of records with short strings, a longer description, numbers, a tag array
+ * and an array of dependency objects. pretty indents it by two spaces per level, as most tools write JSON. */
+static inline void bench_document(bench_text* const text, const size_t records, const int pretty)
+{
+    static const char* const words[] = { "fast", "json", "parser", "build", "tool", "cli", "config", "test", "web", "data" };
+    const char* separator = pretty ? ": " : ":";
+    char piece[160];
+    size_t record = 0;
+    size_t i = 0;
+
+    bench_append_string(text, "[");
+    for (record = 0; record < records; record++)
+    {
+        uint64_t random = bench_random();
+        size_t dependencies = (size_t)(random % 6);
+
+        if (record > 0)
+        {
+            bench_append_string(text, ",");
+        }
+        bench_indent(text, pretty, 1);
+        bench_append_string(text, "{");
+        bench_indent(text, pretty, 2);
+        sprintf(piece, "\"name\"%s\"tool-%lu\",", separator, (unsigned long)record);
+        bench_append_string(text, piece);
+        bench_indent(text, pretty, 2);
+        sprintf(piece, "\"version\"%s\"%d.%d.%d\",", separator, (int)((random >> 8) % 10), (int)((random >> 16) % 30), (int)((random >> 24) % 100));
+        bench_append_string(text, piece);
+        bench_indent(text, pretty, 2);
+        sprintf(piece, "\"description\"%s\"", separator);
+        bench_append_string(text, piece);
+        for (i = 0; i < 8; i++)
+        {
+            sprintf(piece, "%s%s", (i > 0) ? " " : "", words[bench_random() % 10]);
+            bench_append_string(text, piece);
+        }
+        bench_append_string(text, "\",");
+        bench_indent(text, pretty, 2);
+        sprintf(piece, "\"tags\"%s[\"%s\",%s\"%s\"],", separator, words[(random >> 32) % 10], pretty ? " " : "", words[(random >> 40) % 10]);
+        bench_append_string(text, piece);
+        bench_indent(text, pretty, 2);
+        sprintf(piece, "\"downloads\"%s%lu,", separator, (unsigned long)((random >> 20) % 1000000));
+        bench_append_string(text, piece);
+        bench_indent(text, pretty, 2);
+        sprintf(piece, "\"score\"%s0.%04d,", separator, (int)((random >> 44) % 10000));
+        bench_append_string(text, piece);
+        bench_indent(text, pretty, 2);
+        sprintf(piece, "\"dependencies\"%s[", separator);
+        bench_append_string(text, piece);
+        for (i = 0; i < dependencies; i++)
+        {
+            if (i > 0)
+            {
+                bench_append_string(text, ",");
+            }
+            bench_indent(text, pretty, 3);
+            sprintf(piece, "{\"name\"%s\"tool-%lu\",%s\"version\"%s\"^%d.0.0\"}", separator, (unsigned long)(bench_random() % (record + 1)), pretty ? " " : "", separator, (int)(i + 1));
+            bench_append_string(text, piece);
+        }
+        if (dependencies > 0)
+        {
+            bench_indent(text, pretty, 2);
+        }
+        bench_append_string(text, "]");
+        bench_indent(text, pretty, 1);
+        bench_append_string(text, "}");
+    }
+    bench_indent(text, pretty, 0);
+    bench_append_string(text, "]");
+}
+
+static inline void bench_report(const char* const name, const double best_ms, const size_t bytes)
+{
+    printf("%-32s %9.2f ms %9.1f MB/s\n", name, best_ms, ((double)bytes / (1024.0 * 1024.0)) / (best_ms / 1000.0));
+}
+
+#endif
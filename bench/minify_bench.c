@@ -0,0 +1,86 @@
+/*
+  cJSON_Minify throughput, in place, on the generated package registry pretty-printed and already minified, on a
+  pretty-printed string-heavy document and on a pretty-printed array of numbers.
+
+  usage: minify_bench [records]
+*/
+
+#include "bench.h"
+#include "cJSON.h"
+
+static void measure(const char* const name, const bench_text* const text)
+{
+    char* copy = (char*)malloc(text->length + 1);
+    double best = 0;
+    int run = 0;
+
+    if (copy == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (run = 0; run < BENCH_RUNS; run++)
+    {
+        double start = 0;
+        double elapsed = 0;
+
+        memcpy(copy, text->text, text->length + 1);
+        start = bench_now_ms();
+        cJSON_Minify(copy);
+        elapsed = bench_now_ms() - start;
+        if ((run == 0) || (elapsed < best))
+        {
+            best = elapsed;
+        }
+    }
+    bench_report(name, best, text->length);
+    free(copy);
+}
+
+int main(int argc, char** argv)
+{
+    static const char* const words[] = { "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "\\\"quoted\\\"", "tab\\t" };
+    size_t records = (argc > 1) ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    bench_text pretty = { NULL, 0, 0 };
+    bench_text minified = { NULL, 0, 0 };
+    bench_text strings = { NULL, 0, 0 };
+    bench_text numbers = { NULL, 0, 0 };
+    char piece[64];
+    size_t i = 0;
+    size_t j = 0;
+
+    bench_document(&pretty, records, 1);
+    bench_document(&minified, records, 0);
+
+    bench_append_string(&strings, "[");
+    for (i = 0; i < (records * 4); i++)
+    {
+        bench_append_string(&strings, (i > 0) ? ",\n    \"" : "\n    \"");
+        for (j = 0; j < 12; j++)
+        {
+            sprintf(piece, "%s%s", (j > 0) ? " " : "", words[bench_random() % 10]);
+            bench_append_string(&strings, piece);
+        }
+        bench_append_string(&strings, "\"");
+    }
+    bench_append_string(&strings, "\n]");
+
+    bench_append_string(&numbers, "[");
+    for (i = 0; i < (records * 10); i++)
+    {
+        sprintf(piece, "%s\n    %d.%02d", (i > 0) ? "," : "", (int)(bench_random() % 100000), (int)(bench_random() % 100));
+        bench_append_string(&numbers, piece);
+    }
+    bench_append_string(&numbers, "\n]");
+
+    measure("registry, pretty-printed", &pretty);
+    measure("strings, pretty-printed", &strings);
+    measure("numbers, pretty-printed", &numbers);
+    measure("registry, already minified", &minified);
+
+    free(numbers.text);
+    free(strings.text);
+    free(minified.text);
+    free(pretty.text);
+    return EXIT_SUCCESS;
+}
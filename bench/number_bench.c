@@ -0,0 +1,83 @@
+/*
+  Number parsing throughput: parses an array of generated numbers with cJSON_Parse.
+
+  The numbers mix the shapes found in real documents: small integers, ids up to 2^53, prices and coordinates
+  with a few decimals, exponent notation and doubles printed with all 17 digits. The last kind is left to strtod,
+  the others take the fast path.
+
+  usage: number_bench [count]
+*/
+
+#include "bench.h"
+#include "cJSON.h"
+
+static void append_number(bench_text* const text)
+{
+    char numeral[64];
+    uint64_t random = bench_random();
+    double number = 0;
+
+    switch (random % 5)
+    {
+    case 0:
+        sprintf(numeral, "%d", (int)((random >> 8) % 10000));
+        break;
+    case 1:
+        sprintf(numeral, "%llu", (unsigned long long)((random >> 8) % (UINT64_C(1) << 53)));
+        break;
+    case 2:
+        sprintf(numeral, "%d.%02d", (int)((random >> 8) % 100000), (int)((random >> 40) % 100));
+        break;
+    case 3:
+        sprintf(numeral, "%d.%de%d", (int)((random >> 8) % 10), (int)((random >> 16) % 1000), (int)((random >> 40) % 40) - 20);
+        break;
+    default:
+        number = (double)(random >> 11) / (double)(UINT64_C(1) << 53) * 1000.0;
+        sprintf(numeral, "%.17g", number);
+        break;
+    }
+    bench_append_string(text, numeral);
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = (argc > 1) ? (size_t)strtoul(argv[1], NULL, 10) : 1000000;
+    bench_text text = { NULL, 0, 0 };
+    double best = 0;
+    size_t i = 0;
+    int run = 0;
+
+    bench_append_string(&text, "[");
+    for (i = 0; i < count; i++)
+    {
+        if (i > 0)
+        {
+            bench_append_string(&text, ",");
+        }
+        append_number(&text);
+    }
+    bench_append_string(&text, "]");
+
+    for (run = 0; run < BENCH_RUNS; run++)
+    {
+        double start = bench_now_ms();
+        cJSON* document = cJSON_ParseWithLength(text.text, text.length);
+        double elapsed = bench_now_ms() - start;
+
+        if (document == NULL)
+        {
+            fprintf(stderr, "parse failed\n");
+            return EXIT_FAILURE;
+        }
+        cJSON_Delete(document);
+        if ((run == 0) || (elapsed < best))
+        {
+            best = elapsed;
+        }
+    }
+
+    printf("%lu numbers, %lu bytes\n", (unsigned long)count, (unsigned long)text.length);
+    bench_report("cJSON_ParseWithLength", best, text.length);
+    free(text.text);
+    return EXIT_SUCCESS;
+}
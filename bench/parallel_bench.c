@@ -0,0 +1,78 @@
+/*
+  cJSON_ParseParallel against cJSON_ParseWithLength on the generated package registry, for 1 to 8 threads. The result
+  of each thread count is printed and compared with the sequential one once, outside the timing.
+
+  usage: parallel_bench [records]
+*/
+
+#include "bench.h"
+#include "cJSON.h"
+
+static double measure(const bench_text* const text, const int threads)
+{
+    double best = 0;
+    int run = 0;
+
+    for (run = 0; run < BENCH_RUNS; run++)
+    {
+        double start = bench_now_ms();
+        cJSON* document = (threads == 0) ? cJSON_ParseWithLength(text->text, text->length) : cJSON_ParseParallel(text->text, text->length, threads);
+        double elapsed = bench_now_ms() - start;
+
+        if (document == NULL)
+        {
+            fprintf(stderr, "parse failed\n");
+            exit(EXIT_FAILURE);
+        }
+        cJSON_Delete(document);
+        if ((run == 0) || (elapsed < best))
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    static const int thread_counts[] = { 1, 2, 4, 8 };
+    size_t records = (argc > 1) ? (size_t)strtoul(argv[1], NULL, 10) : 200000;
+    bench_text text = { NULL, 0, 0 };
+    cJSON* sequential = NULL;
+    char* expected = NULL;
+    char name[64];
+    size_t i = 0;
+
+    bench_document(&text, records, 0);
+    sequential = cJSON_ParseWithLength(text.text, text.length);
+    expected = cJSON_PrintUnformatted(sequential);
+    cJSON_Delete(sequential);
+    if (expected == NULL)
+    {
+        fprintf(stderr, "parse failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%lu records, %lu bytes\n", (unsigned long)records, (unsigned long)text.length);
+    bench_report("cJSON_ParseWithLength", measure(&text, 0), text.length);
+    for (i = 0; i < (sizeof(thread_counts) / sizeof(thread_counts[0])); i++)
+    {
+        cJSON* parallel = cJSON_ParseParallel(text.text, text.length, thread_counts[i]);
+        char* printed = cJSON_PrintUnformatted(parallel);
+
+        if ((printed == NULL) || (strcmp(printed, expected) != 0))
+        {
+            fprintf(stderr, "%d threads give a different document\n", thread_counts[i]);
+            return EXIT_FAILURE;
+        }
+        cJSON_free(printed);
+        cJSON_Delete(parallel);
+
+        sprintf(name, "cJSON_ParseParallel, %d thread%s", thread_counts[i], (thread_counts[i] > 1) ? "s" : "");
+        bench_report(name, measure(&text, thread_counts[i]), text.length);
+    }
+
+    cJSON_free(expected);
+    free(text.text);
+    return EXIT_SUCCESS;
+}
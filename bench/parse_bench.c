@@ -0,0 +1,52 @@
+/*
+  Parse throughput on a generated package registry, pretty-printed with two-space indentation and minified. About a
+  fifth of the pretty-printed text is indentation and line breaks, which the vectorized whitespace skipping is for.
+
+  usage: parse_bench [records]
+*/
+
+#include "bench.h"
+#include "cJSON.h"
+
+static void measure(const char* const name, const bench_text* const text)
+{
+    double best = 0;
+    int run = 0;
+
+    for (run = 0; run < BENCH_RUNS; run++)
+    {
+        double start = bench_now_ms();
+        cJSON* document = cJSON_ParseWithLength(text->text, text->length);
+        double elapsed = bench_now_ms() - start;
+
+        if (document == NULL)
+        {
+            fprintf(stderr, "parse failed\n");
+            exit(EXIT_FAILURE);
+        }
+        cJSON_Delete(document);
+        if ((run == 0) || (elapsed < best))
+        {
+            best = elapsed;
+        }
+    }
+    bench_report(name, best, text->length);
+}
+
+int main(int argc, char** argv)
+{
+    size_t records = (argc > 1) ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    bench_text pretty = { NULL, 0, 0 };
+    bench_text minified = { NULL, 0, 0 };
+
+    bench_document(&pretty, records, 1);
+    bench_document(&minified, records, 0);
+
+    printf("%lu records, %lu bytes pretty-printed, %lu bytes minified\n", (unsigned long)records, (unsigned long)pretty.length, (unsigned long)minified.length);
+    measure("parse, pretty-printed", &pretty);
+    measure("parse, minified", &minified);
+
+    free(minified.text);
+    free(pretty.text);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+/*
+  cJSON_Print and cJSON_PrintUnformatted against cJSON_PrintExact, on the generated package registry and on an array
+  of doubles. Times are measured with the default hooks. Allocations and peak heap of the printing are counted in a
+  second pass through counting hooks, where cJSON can't realloc, so growing a buffer means allocating and copying.
+
+  usage: print_bench [records]
+*/
+
+#include "bench.h"
+#include "cJSON.h"
+
+typedef char* (*print_function)(const cJSON* item, cJSON_bool format);
+
+static size_t allocations = 0;
+static size_t live_bytes = 0;
+static size_t peak_bytes = 0;
+
+/* the size is kept in front of each block, 16 bytes keep the alignment */
+static void* counting_malloc(size_t size)
+{
+    size_t* block = (size_t*)malloc(size + 16);
+
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    block[0] = size;
+    allocations++;
+    live_bytes += size;
+    if (live_bytes > peak_bytes)
+    {
+        peak_bytes = live_bytes;
+    }
+    return (char*)block + 16;
+}
+
+static void counting_free(void* pointer)
+{
+    size_t* block = NULL;
+
+    if (pointer == NULL)
+    {
+        return;
+    }
+    block = (size_t*)(void*)((char*)pointer - 16);
+    live_bytes -= block[0];
+    free(block);
+}
+
+static char* print_growing(const cJSON* item, cJSON_bool format)
+{
+    return format ? cJSON_Print(item) : cJSON_PrintUnformatted(item);
+}
+
+static void measure(const char* const name, const cJSON* const document, const print_function print, const cJSON_bool format)
+{
+    cJSON_Hooks counting = { counting_malloc, counting_free };
+    char* text = NULL;
+    size_t length = 0;
+    double best = 0;
+    int run = 0;
+
+    for (run = 0; run < BENCH_RUNS; run++)
+    {
+        double start = bench_now_ms();
+        double elapsed = 0;
+
+        text = print(document, format);
+        elapsed = bench_now_ms() - start;
+        if (text == NULL)
+        {
+            fprintf(stderr, "print failed\n");
+            exit(EXIT_FAILURE);
+        }
+        length = strlen(text);
+        cJSON_free(text);
+        if ((run == 0) || (elapsed < best))
+        {
+            best = elapsed;
+        }
+    }
+
+    /* the document was allocated with the default hooks, so only the printing goes through the counting ones */
+    cJSON_InitHooks(&counting);
+    allocations = 0;
+    live_bytes = 0;
+    peak_bytes = 0;
+    text = print(document, format);
+    cJSON_free(text);
+    cJSON_InitHooks(NULL);
+
+    printf("%-32s %9.2f ms %6lu allocations, peak %6.1f MB for %.1f MB of text\n", name, best, (unsigned long)allocations,
+           (double)peak_bytes / (1024.0 * 1024.0), (double)length / (1024.0 * 1024.0));
+}
+
+static void measure_document(const char* const name, const bench_text* const text)
+{
+    cJSON* document = cJSON_ParseWithLength(text->text, text->length);
+
+    if (document == NULL)
+    {
+        fprintf(stderr, "parse failed\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("%s\n", name);
+    measure("  cJSON_PrintUnformatted", document, print_growing, 0);
+    measure("  cJSON_PrintExact, unformatted", document, cJSON_PrintExact, 0);
+    measure("  cJSON_Print", document, print_growing, 1);
+    measure("  cJSON_PrintExact, formatted", document, cJSON_PrintExact, 1);
+    cJSON_Delete(document);
+}
+
+int main(int argc, char** argv)
+{
+    size_t records = (argc > 1) ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    bench_text registry = { NULL, 0, 0 };
+    bench_text numbers = { NULL, 0, 0 };
+    char numeral[32];
+    size_t i = 0;
+
+    bench_document(&registry, records, 0);
+    bench_append_string(&numbers, "[");
+    for (i = 0; i < (records * 5); i++)
+    {
+        sprintf(numeral, "%s%.17g", (i > 0) ? "," : "", (double)(bench_random() >> 11) / (double)(UINT64_C(1) << 40));
+        bench_append_string(&numbers, numeral);
+    }
+    bench_append_string(&numbers, "]");
+
+    measure_document("registry", &registry);
+    measure_document("numbers", &numbers);
+
+    free(numbers.text);
+    free(registry.text);
+    return EXIT_SUCCESS;
+}
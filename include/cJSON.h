@@ -129,8 +129,64 @@ extern "C"
         void (CJSON_CDECL* free_fn)(void* ptr);
     } cJSON_Hooks;
 
+    /* An allocator for single documents, as opposed to the process wide cJSON_Hooks. context is passed to every call,
+     * realloc_fn may be NULL. The allocator is only referenced, so it has to stay valid as long as anything allocated from it. */
+    typedef struct cJSON_Allocator
+    {
+        void* (CJSON_CDECL* malloc_fn)(void* context, size_t size);
+        void (CJSON_CDECL* free_fn)(void* context, void* pointer);
+        void* (CJSON_CDECL* realloc_fn)(void* context, void* pointer, size_t size);
+        void* context;
+    } cJSON_Allocator;
+
     typedef int cJSON_bool;
 
+    /* Callbacks of cJSON_ParseSAX, each one may be NULL. Returning false from a callback stops parsing.
+     * The strings passed to key and string are only valid until the callback returns. */
+    typedef struct cJSON_SAXHandler
+    {
+        cJSON_bool (*start_object)(void* context);
+        cJSON_bool (*end_object)(void* context);
+        cJSON_bool (*start_array)(void* context);
+        cJSON_bool (*end_array)(void* context);
+        cJSON_bool (*key)(void* context, const char* key);
+        cJSON_bool (*string)(void* context, const char* string);
+        cJSON_bool (*number)(void* context, double number);
+        cJSON_bool (*boolean)(void* context, cJSON_bool boolean);
+        cJSON_bool (*null)(void* context);
+    } cJSON_SAXHandler;
+
+    /* Why and where parsing failed, see cJSON_ParseEx. */
+    typedef struct cJSON_ParseError
+    {
+        size_t offset; /* in bytes from the start of the input */
+        size_t line; /* starting with 1 */
+        size_t column; /* in bytes, starting with 1 */
+        const char* reason; /* a static English description, NULL if there was no error */
+    } cJSON_ParseError;
+
+    /* Receives the output of cJSON_PrintToWriter piece by piece, returning false aborts printing. */
+    typedef cJSON_bool (*cJSON_WriteFunction)(void* context, const char* data, size_t length);
+
+    /* State of an incremental parse, see cJSON_PushParserNew. */
+    typedef struct cJSON_PushParser cJSON_PushParser;
+
+    /* Stores object keys once for any number of documents, see cJSON_ParseWithKeyTable. */
+    typedef struct cJSON_KeyTable cJSON_KeyTable;
+
+    /* A read-only document in a compact layout, see cJSON_ParseTape. */
+    typedef struct cJSON_Tape cJSON_Tape;
+
+    /* A compiled JSON Pointer or path query, see cJSON_PathCompile. */
+    typedef struct cJSON_Path cJSON_Path;
+    /* Receives the matches of cJSON_PathForEach in document order, returning false stops the search. */
+    typedef cJSON_bool (*cJSON_PathCallback)(cJSON* item, void* context);
+
+    /* A compiled JSON Schema, see cJSON_SchemaCompile. */
+    typedef struct cJSON_Schema cJSON_Schema;
+    /* Receives each error of cJSON_SchemaValidate: the JSON Pointer of the item ("" for root, NULL when out of memory) and what is wrong with it. */
+    typedef void (*cJSON_SchemaErrorCallback)(void* context, const char* path, const char* message);
+
     /* Limits how deeply nested arrays/objects can be before cJSON rejects to parse them.
      * This is to prevent stack overflows. */
 #ifndef CJSON_NESTING_LIMIT
@@ -141,6 +197,15 @@ extern "C"
       * This is to prevent stack overflows. */
 #ifndef CJSON_CIRCULAR_LIMIT
 #define CJSON_CIRCULAR_LIMIT 10000
+#endif
+
+      /* Arrays and objects with this many children get an index when they are parsed or duplicated, or once the Add/Insert
+       * functions make them this large. It caches the size, makes access by position constant time and gives objects a hash
+       * table for lookup by key. 0 disables indexing. The index is kept up to date by the Add/Insert/Detach/Replace functions,
+       * so change the children of an array or object through those rather than through ->next/->prev. Lookups only read the
+       * index, so a document that isn't changed can be read from several threads (except lazy ones, see cJSON_ParseLazy). */
+#ifndef CJSON_INDEX_THRESHOLD
+#define CJSON_INDEX_THRESHOLD 16
 #endif
 
       /* returns the version of cJSON as a string */
@@ -157,6 +222,84 @@ extern "C"
     /* If you supply a ptr in return_parse_end and parsing fails, then return_parse_end will contain a pointer to the error so will match cJSON_GetErrorPtr(). */
     CJSON_PUBLIC(cJSON*) cJSON_ParseWithOpts(const char* value, const char** return_parse_end, cJSON_bool require_null_terminated);
     CJSON_PUBLIC(cJSON*) cJSON_ParseWithLengthOpts(const char* value, size_t buffer_length, const char** return_parse_end, cJSON_bool require_null_terminated);
+    /* ParseEx works like ParseWithLengthOpts, but doesn't touch the error state behind cJSON_GetErrorPtr: if parse_error isn't
+     * NULL it receives where and why parsing failed, or is cleared on success. It is safe to call from several threads at once
+     * (as long as cJSON_InitHooks isn't called meanwhile); the other parse functions keep their error state per thread as well. */
+    CJSON_PUBLIC(cJSON*) cJSON_ParseEx(const char* value, size_t buffer_length, const char** return_parse_end, cJSON_bool require_null_terminated, cJSON_ParseError* parse_error);
+    /* ParseWithArena allocates all items and strings of the document from a few large chunks instead of one allocation each.
+     * Free the result with cJSON_ArenaFree (or cJSON_Delete on the returned root), which releases the whole document at once;
+     * cJSON_Delete on any other item of the document does nothing. The document is meant to be read: items added to it
+     * after parsing are not freed with it, and cJSON_SetValuestring can't make its strings longer. */
+    CJSON_PUBLIC(cJSON*) cJSON_ParseWithArena(const char* value, size_t buffer_length);
+    CJSON_PUBLIC(void) cJSON_ArenaFree(cJSON* item);
+    /* ParseWithAllocator allocates the items and strings of the document with allocator instead of the cJSON_Hooks. Every item
+     * remembers its allocator, so cJSON_Delete releases the document (or any part of it, also after detaching) to where it came from.
+     * Items that the Add...ToObject helpers create get the allocator of the object. A NULL allocator means the cJSON_Hooks. */
+    CJSON_PUBLIC(cJSON*) cJSON_ParseWithAllocator(const char* value, size_t buffer_length, const cJSON_Allocator* allocator);
+    /* ParseInSitu decodes strings in place inside value instead of copying them, so value must be writable and must outlive
+     * the returned document (duplicates made with cJSON_Duplicate don't depend on it). Keys are marked cJSON_StringIsConst and
+     * string values cJSON_IsReference, so cJSON_Delete leaves them alone. cJSON_SetValuestring still works on those values: a string
+     * that fits is written over the old one in value, a longer one is copied. The content of value is unspecified afterwards, also on failure. */
+    CJSON_PUBLIC(cJSON*) cJSON_ParseInSitu(char* value, size_t buffer_length);
+    /* ParseLazy only matches the brackets of the document; an array or object is parsed from value the first time its children
+     * are needed (by cJSON_GetObjectItem, cJSON_GetArrayItem, cJSON_GetArraySize, cJSON_ArrayForEach, printing, comparing...),
+     * so value must not change and must outlive the document. Keys and values of an array or object are parsed together, so
+     * item->valuestring etc. can be read as usual, but item->child of an array or object that wasn't accessed yet is NULL.
+     * Syntax errors other than unbalanced brackets and unterminated strings are only found when the array or object that
+     * contains them is parsed: it then looks empty to the lookup functions and printing it fails. Free the document with
+     * cJSON_Delete on the root; items detached from it are parsed completely first, so they don't depend on it. Accessing
+     * a lazy document from several threads at once is not safe, not even reading. */
+    CJSON_PUBLIC(cJSON*) cJSON_ParseLazy(const char* value, size_t buffer_length);
+    /* ParseParallel parses value on thread_count threads (one per processor if it is 0 or less) and returns an ordinary document.
+     * The brackets of the whole text are matched first, then its arrays and objects are parsed by the threads, so it pays off for
+     * large documents made of many arrays and objects, like long lists of records. Documents below about a megabyte and builds
+     * without threads (CJSON_DISABLE_THREADS) are parsed like by cJSON_ParseWithLength, which also reports syntax errors.
+     * The cJSON_Hooks are called from all the threads at once. */
+    CJSON_PUBLIC(cJSON*) cJSON_ParseParallel(const char* value, size_t buffer_length, int thread_count);
+    /* ParseWithKeyTable stores every object key once in table instead of once per item, which saves an allocation per key when
+     * the same keys repeat. The keys are marked cJSON_StringIsConst, so the table must outlive the document (and everything
+     * detached from it); it can be reused for further documents, e.g. when reloading. cJSON_GetObjectItemCaseSensitive
+     * finds keys passed as returned by cJSON_KeyTableIntern by their address. Keys of the table are never removed,
+     * cJSON_KeyTableDelete frees them all. A table must not be used by several threads at once. */
+    CJSON_PUBLIC(cJSON_KeyTable*) cJSON_KeyTableNew(void);
+    CJSON_PUBLIC(void) cJSON_KeyTableDelete(cJSON_KeyTable* table);
+    CJSON_PUBLIC(const char*) cJSON_KeyTableIntern(cJSON_KeyTable* table, const char* key);
+    CJSON_PUBLIC(cJSON*) cJSON_ParseWithKeyTable(const char* value, size_t buffer_length, cJSON_KeyTable* table);
+    /* ParseSAX reads the document without building any items: every value is reported to handler in document order instead.
+     * Memory use doesn't grow with the document, only with its longest string. Returns false if the JSON is invalid or a
+     * callback stopped parsing, cJSON_GetErrorPtr then points to where parsing stopped. */
+    CJSON_PUBLIC(cJSON_bool) cJSON_ParseSAX(const char* value, size_t buffer_length, const cJSON_SAXHandler* handler, void* context);
+    /* ParseTape reads a document into a compact read-only form instead of cJSON items: all nodes in one array with 32 bit
+     * indices, small integers stored in the node, all strings in one buffer. That takes about 13 bytes per node plus the
+     * strings, in a handful of allocations. Nodes are identified by numbers: 0 is "no node", the root is
+     * cJSON_TapeRoot and the accessors behave like their cJSON counterparts (GetType returns cJSON_False ... cJSON_Object,
+     * or cJSON_Invalid for 0). Free the document with cJSON_TapeDelete, strings returned by it are valid until then.
+     * Documents with 2^32 nodes or more, or 4 GB of strings, are rejected. */
+    CJSON_PUBLIC(cJSON_Tape*) cJSON_ParseTape(const char* value, size_t buffer_length);
+    CJSON_PUBLIC(void) cJSON_TapeDelete(cJSON_Tape* tape);
+    CJSON_PUBLIC(size_t) cJSON_TapeRoot(const cJSON_Tape* tape);
+    CJSON_PUBLIC(int) cJSON_TapeGetType(const cJSON_Tape* tape, size_t node);
+    /* number of children of an array or object, 0 for anything else */
+    CJSON_PUBLIC(size_t) cJSON_TapeGetSize(const cJSON_Tape* tape, size_t node);
+    /* traversal: the first child of an array or object, the next child of the same parent */
+    CJSON_PUBLIC(size_t) cJSON_TapeGetChild(const cJSON_Tape* tape, size_t node);
+    CJSON_PUBLIC(size_t) cJSON_TapeGetNext(const cJSON_Tape* tape, size_t node);
+    CJSON_PUBLIC(size_t) cJSON_TapeGetArrayItem(const cJSON_Tape* tape, size_t array, size_t index);
+    CJSON_PUBLIC(size_t) cJSON_TapeGetObjectItem(const cJSON_Tape* tape, size_t object, const char* string);
+    CJSON_PUBLIC(size_t) cJSON_TapeGetObjectItemCaseSensitive(const cJSON_Tape* tape, size_t object, const char* string);
+    /* the key of an object member, NULL for other nodes */
+    CJSON_PUBLIC(const char*) cJSON_TapeGetKey(const cJSON_Tape* tape, size_t node);
+    CJSON_PUBLIC(const char*) cJSON_TapeGetStringValue(const cJSON_Tape* tape, size_t node);
+    CJSON_PUBLIC(double) cJSON_TapeGetNumberValue(const cJSON_Tape* tape, size_t node);
+    /* Incremental parsing for input that arrives in chunks: feed the chunks in order with cJSON_PushParserFeed, which may split
+     * them anywhere, also inside of tokens, then cJSON_PushParserFinish returns the document, or NULL if it is invalid or
+     * incomplete, and frees the parser. If parse_error isn't NULL it receives where and why parsing failed. Only whitespace may
+     * follow the document. Feed returns false as soon as the input can't be valid anymore; cJSON_PushParserDelete frees a parser
+     * that won't be finished. cJSON_GetErrorPtr isn't set. */
+    CJSON_PUBLIC(cJSON_PushParser*) cJSON_PushParserNew(void);
+    CJSON_PUBLIC(cJSON_bool) cJSON_PushParserFeed(cJSON_PushParser* parser, const char* chunk, size_t length);
+    CJSON_PUBLIC(cJSON*) cJSON_PushParserFinish(cJSON_PushParser* parser, cJSON_ParseError* parse_error);
+    CJSON_PUBLIC(void) cJSON_PushParserDelete(cJSON_PushParser* parser);
 
     /* Render a cJSON entity to text for transfer/storage. */
     CJSON_PUBLIC(char*) cJSON_Print(const cJSON* item);
@@ -167,6 +310,22 @@ extern "C"
     /* Render a cJSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
     /* NOTE: cJSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
     CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON* item, char* buffer, const int length, const cJSON_bool format);
+    /* Render a cJSON entity to text with a single allocation: a first pass over the tree computes the exact length of the text. */
+    CJSON_PUBLIC(char*) cJSON_PrintExact(const cJSON* item, cJSON_bool format);
+    /* Render a cJSON entity to text and stream it to write_fn in pieces of a few KB, without holding the whole text in memory.
+     * Only a string longer than that needs a buffer of its own. The text is not null terminated. Returns false if printing
+     * failed or write_fn returned false, in which case part of the text may have been written already. */
+    CJSON_PUBLIC(cJSON_bool) cJSON_PrintToWriter(const cJSON* item, cJSON_WriteFunction write_fn, void* context, const cJSON_bool format);
+    /* Render a cJSON entity to text allocated with allocator, free it with allocator->free_fn. */
+    CJSON_PUBLIC(char*) cJSON_PrintWithAllocator(const cJSON* item, cJSON_bool format, const cJSON_Allocator* allocator);
+    /* Encode a cJSON entity as CBOR (RFC 8949), free the result with cJSON_free. length receives its size in bytes.
+     * Whole numbers become CBOR integers and other numbers the smallest float that holds them exactly; NaN and infinity
+     * become null like in text. Raw items become byte strings tagged 262 (embedded JSON). */
+    CJSON_PUBLIC(unsigned char*) cJSON_ToCBOR(const cJSON* item, size_t* length);
+    /* Decode a single CBOR item that fills all of data. Indefinite lengths, half floats and tags are accepted (tags other than 262
+     * are ignored), map keys have to be text strings and byte strings are only accepted as embedded JSON. On failure
+     * cJSON_GetErrorPtr points at the byte of data where decoding failed. */
+    CJSON_PUBLIC(cJSON*) cJSON_FromCBOR(const unsigned char* data, size_t length);
     /* Delete a cJSON entity and all subentities. */
     CJSON_PUBLIC(void) cJSON_Delete(cJSON* item);
 
@@ -178,7 +337,28 @@ extern "C"
     CJSON_PUBLIC(cJSON*) cJSON_GetObjectItem(const cJSON* const object, const char* const string);
     CJSON_PUBLIC(cJSON*) cJSON_GetObjectItemCaseSensitive(const cJSON* const object, const char* const string);
     CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON* object, const char* string);
-    /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
+    /* Get the item a JSON Pointer (RFC 6901) like "/tools/0/name" refers to, "" being root itself. Keys are case sensitive.
+     * NULL if there is no such item or the pointer is invalid. Compile pointers that are used repeatedly with cJSON_PathCompile. */
+    CJSON_PUBLIC(cJSON*) cJSON_GetPointer(const cJSON* root, const char* pointer);
+    /* Compile a JSON Pointer into a path, in which a step that is just an asterisk matches every element of an array or member
+     * of an object, so one path can reach e.g. the command of every tool of every framework of every category. Keys are decoded
+     * and hashed here once, evaluating a path allocates nothing.
+     * NULL if path is not a valid pointer. A path can be used with any number of documents and threads, free it with cJSON_PathDelete. */
+    CJSON_PUBLIC(cJSON_Path*) cJSON_PathCompile(const char* path);
+    CJSON_PUBLIC(void) cJSON_PathDelete(cJSON_Path* path);
+    /* Get the first item that path matches in root, in document order. */
+    CJSON_PUBLIC(cJSON*) cJSON_PathGet(const cJSON_Path* path, const cJSON* root);
+    /* Pass every item that path matches in root to callback (which may be NULL to only count them), returns the number of matches passed. */
+    CJSON_PUBLIC(size_t) cJSON_PathForEach(const cJSON_Path* path, const cJSON* root, cJSON_PathCallback callback, void* context);
+    /* Compile a JSON Schema, which has to be an object or true. Supported keywords are type (a name or an array of null, boolean,
+     * number, integer, string, array and object), properties, required, additionalProperties (a boolean or a schema), items (one
+     * schema for all elements), minLength/maxLength (in code points), minItems/maxItems and minimum/maximum; others are ignored.
+     * NULL if the schema uses a keyword in a way that isn't supported. Free it with cJSON_SchemaDelete, it can be shared by threads. */
+    CJSON_PUBLIC(cJSON_Schema*) cJSON_SchemaCompile(const cJSON* schema);
+    /* Check item against schema and pass every error to callback (which may be NULL), returns the number of errors. */
+    CJSON_PUBLIC(size_t) cJSON_SchemaValidate(const cJSON_Schema* schema, const cJSON* item, cJSON_SchemaErrorCallback callback, void* context);
+    CJSON_PUBLIC(void) cJSON_SchemaDelete(cJSON_Schema* schema);
+    /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. The error is kept per thread. */
     CJSON_PUBLIC(const char*) cJSON_GetErrorPtr(void);
 
     /* Check item type and return its value */
@@ -208,6 +388,16 @@ extern "C"
     CJSON_PUBLIC(cJSON*) cJSON_CreateRaw(const char* raw);
     CJSON_PUBLIC(cJSON*) cJSON_CreateArray(void);
     CJSON_PUBLIC(cJSON*) cJSON_CreateObject(void);
+    /* The same with memory from allocator, see cJSON_ParseWithAllocator. */
+    CJSON_PUBLIC(cJSON*) cJSON_CreateObjectWithAllocator(const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateArrayWithAllocator(const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateStringWithAllocator(const char* string, const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateNumberWithAllocator(double num, const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateNullWithAllocator(const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateTrueWithAllocator(const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateFalseWithAllocator(const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateBoolWithAllocator(cJSON_bool boolean, const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateRawWithAllocator(const char* raw, const cJSON_Allocator* allocator);
 
     /* Create a string where valuestring references a string so
      * it will not be freed by cJSON_Delete */
@@ -216,6 +406,10 @@ extern "C"
      * they will not be freed by cJSON_Delete */
     CJSON_PUBLIC(cJSON*) cJSON_CreateObjectReference(const cJSON* child);
     CJSON_PUBLIC(cJSON*) cJSON_CreateArrayReference(const cJSON* child);
+    /* The same with the item (not what it references) from allocator. */
+    CJSON_PUBLIC(cJSON*) cJSON_CreateStringReferenceWithAllocator(const char* string, const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateObjectReferenceWithAllocator(const cJSON* child, const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateArrayReferenceWithAllocator(const cJSON* child, const cJSON_Allocator* allocator);
 
     /* These utilities create an Array of count items.
      * The parameter count cannot be greater than the number of elements in the number array, otherwise array access will be out of bounds.*/
@@ -223,6 +417,11 @@ extern "C"
     CJSON_PUBLIC(cJSON*) cJSON_CreateFloatArray(const float* numbers, int count);
     CJSON_PUBLIC(cJSON*) cJSON_CreateDoubleArray(const double* numbers, int count);
     CJSON_PUBLIC(cJSON*) cJSON_CreateStringArray(const char* const* strings, int count);
+    /* The same with the array and all its items from allocator. */
+    CJSON_PUBLIC(cJSON*) cJSON_CreateIntArrayWithAllocator(const int* numbers, int count, const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateFloatArrayWithAllocator(const float* numbers, int count, const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateDoubleArrayWithAllocator(const double* numbers, int count, const cJSON_Allocator* allocator);
+    CJSON_PUBLIC(cJSON*) cJSON_CreateStringArrayWithAllocator(const char* const* strings, int count, const cJSON_Allocator* allocator);
 
     /* Append item to the specified array/object. */
     CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToArray(cJSON* array, cJSON* item);
@@ -253,12 +452,24 @@ extern "C"
 
     /* Duplicate a cJSON item */
     CJSON_PUBLIC(cJSON*) cJSON_Duplicate(const cJSON* item, cJSON_bool recurse);
+    /* Duplicate into memory from allocator, see cJSON_ParseWithAllocator. */
+    CJSON_PUBLIC(cJSON*) cJSON_DuplicateWithAllocator(const cJSON* item, cJSON_bool recurse, const cJSON_Allocator* allocator);
+    /* Copy-on-write duplicate. The copy shares children and strings with item, and an array or object only gets
+     * children of its own once they are looked up or changed through the cJSON functions, so a copy costs about
+     * as much as the paths that are used. Like a reference, the copy must not outlive item, and item must not
+     * be changed while the copy is in use. Walk the copy with cJSON_GetArrayItem / cJSON_GetObjectItem before
+     * changing what you find: an untouched copy's ->child still points into item. */
+    CJSON_PUBLIC(cJSON*) cJSON_DuplicateShared(const cJSON* item);
     /* Duplicate will create a new, identical cJSON item to the one you pass, in new memory that will
      * need to be released. With recurse!=0, it will duplicate any children connected to the item.
      * The item->next and ->prev pointers are always zero on return from Duplicate. */
      /* Recursively compare two cJSON items for equality. If either a or b is NULL or invalid, they will be considered unequal.
       * case_sensitive determines if object keys are treated case sensitive (1) or case insensitive (0) */
     CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON* const a, const cJSON* const b, const cJSON_bool case_sensitive);
+    /* Hash a cJSON item and its children. Object members are hashed in any order, array elements in order.
+     * Items that cJSON_Compare considers equal hash the same unless their numbers differ by rounding error.
+     * Returns 0 if item is NULL or there is not enough memory. */
+    CJSON_PUBLIC(size_t) cJSON_Hash(const cJSON* const item);
 
     /* Minify a strings, remove blank characters(such as ' ', '\t', '\r', '\n') from strings.
      * The input pointer json cannot point to a read-only address area, such as a string constant,
@@ -292,8 +503,8 @@ extern "C"
     cJSON_Invalid\
 )
 
-/* Macro for iterating over an array or object */
-#define cJSON_ArrayForEach(element, array) for(element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
+/* Macro for iterating over an array or object (the first element is looked up, so that lazy documents are parsed) */
+#define cJSON_ArrayForEach(element, array) for(element = cJSON_GetArrayItem(array, 0); element != NULL; element = element->next)
 
 /* malloc/free objects using the malloc/free functions that have been set with cJSON_InitHooks */
     CJSON_PUBLIC(void*) cJSON_malloc(size_t size);
@@ -45,10 +45,49 @@
 #include <ctype.h>
 #include <float.h>
 
+#include <stdint.h>
+
 #ifdef ENABLE_LOCALES
 #include <locale.h>
 #endif
 
+/* Vector instruction sets used by the scanning kernels. Define CJSON_DISABLE_SIMD to build the scalar code only. */
+#if !defined(CJSON_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define CJSON_SIMD_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+/* AVX2 kernels are compiled per function, so the rest of the file doesn't require -mavx2 */
+#define CJSON_SIMD_AVX2
+#define CJSON_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define CJSON_SIMD_AVX2
+#define CJSON_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CJSON_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+/* Threads used by cJSON_ParseParallel. Define CJSON_DISABLE_THREADS to parse on the calling thread only. */
+#if !defined(CJSON_DISABLE_THREADS)
+#if defined(_WIN32)
+#define CJSON_THREADS_WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define CJSON_THREADS_POSIX
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#endif
+
 #if defined(_MSC_VER)
 #pragma warning (pop)
 #endif
@@ -85,11 +124,22 @@
 #endif
 #endif
 
+/* the error of the last parse is kept per thread, so threads can parse concurrently */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define CJSON_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define CJSON_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#define CJSON_THREAD_LOCAL __thread
+#else
+#define CJSON_THREAD_LOCAL
+#endif
+
 typedef struct {
     const unsigned char* json;
     size_t position;
 } error;
-static error global_error = { NULL, 0 };
+static CJSON_THREAD_LOCAL error global_error = { NULL, 0 };
 
 CJSON_PUBLIC(const char*) cJSON_GetErrorPtr(void)
 {
@@ -158,6 +208,7 @@ typedef struct internal_hooks
     void* (CJSON_CDECL* allocate)(size_t size);
     void (CJSON_CDECL* deallocate)(void* pointer);
     void* (CJSON_CDECL* reallocate)(void* pointer, size_t size);
+    const cJSON_Allocator* allocator; /* if set, used instead of the functions above */
 } internal_hooks;
 
 #if defined(_MSC_VER)
@@ -183,7 +234,102 @@ static void* CJSON_CDECL internal_realloc(void* pointer, size_t size)
 /* strlen of character literals resolved at compile time */
 #define static_strlen(string_literal) (sizeof(string_literal) - sizeof(""))
 
-static internal_hooks global_hooks = { internal_malloc, internal_free, internal_realloc };
+static internal_hooks global_hooks = { internal_malloc, internal_free, internal_realloc, NULL };
+
+/* Allocation through hooks that may carry a per document allocator. */
+static void* hooks_allocate(const internal_hooks* const hooks, size_t size)
+{
+    if (hooks->allocator != NULL)
+    {
+        return hooks->allocator->malloc_fn(hooks->allocator->context, size);
+    }
+
+    return hooks->allocate(size);
+}
+
+static void hooks_deallocate(const internal_hooks* const hooks, void* pointer)
+{
+    if (hooks->allocator != NULL)
+    {
+        hooks->allocator->free_fn(hooks->allocator->context, pointer);
+        return;
+    }
+
+    hooks->deallocate(pointer);
+}
+
+static cJSON_bool hooks_can_reallocate(const internal_hooks* const hooks)
+{
+    if (hooks->allocator != NULL)
+    {
+        return hooks->allocator->realloc_fn != NULL;
+    }
+
+    return hooks->reallocate != NULL;
+}
+
+/* only if hooks_can_reallocate */
+static void* hooks_reallocate(const internal_hooks* const hooks, void* pointer, size_t size)
+{
+    if (hooks->allocator != NULL)
+    {
+        return hooks->allocator->realloc_fn(hooks->allocator->context, pointer, size);
+    }
+
+    return hooks->reallocate(pointer, size);
+}
+
+/* resize an array allocated with hooks from count to new_count elements */
+static void* resize_array(const internal_hooks* const hooks, void* const array, const size_t element_size, const size_t count, const size_t new_count)
+{
+    void* new_array = NULL;
+
+    if (new_count > (((size_t)-1) / element_size))
+    {
+        return NULL;
+    }
+    if ((array != NULL) && hooks_can_reallocate(hooks))
+    {
+        return hooks_reallocate(hooks, array, new_count * element_size);
+    }
+
+    new_array = hooks_allocate(hooks, new_count * element_size);
+    if ((new_array != NULL) && (array != NULL))
+    {
+        memcpy(new_array, array, ((count < new_count) ? count : new_count) * element_size);
+        hooks_deallocate(hooks, array);
+    }
+
+    return new_array;
+}
+
+/* the hooks to use for an allocator passed to the public API, which may be NULL */
+static internal_hooks allocator_hooks(const cJSON_Allocator* const allocator)
+{
+    internal_hooks hooks = global_hooks;
+
+    if ((allocator != NULL) && (allocator->malloc_fn != NULL) && (allocator->free_fn != NULL))
+    {
+        hooks.allocator = allocator;
+    }
+
+    return hooks;
+}
+
+#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+#pragma GCC diagnostic push
+#endif
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#endif
+/* helper function to cast away const */
+static void* cast_away_const(const void* string)
+{
+    return (void*)string;
+}
+#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+#pragma GCC diagnostic pop
+#endif
 
 static unsigned char* cJSON_strdup(const unsigned char* string, const internal_hooks* const hooks)
 {
@@ -196,7 +342,7 @@ static unsigned char* cJSON_strdup(const unsigned char* string, const internal_h
     }
 
     length = strlen((const char*)string) + sizeof("");
-    copy = (unsigned char*)hooks->allocate(length);
+    copy = (unsigned char*)hooks_allocate(hooks, length);
     if (copy == NULL)
     {
         return NULL;
@@ -237,10 +383,52 @@ CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
     }
 }
 
+/* Internal type flag for items allocated from a cJSON_Allocator. The allocator is stored right behind such an item,
+ * so the item, its strings and its index can be released on their own, also after the item was detached. */
+#define cJSON_HasAllocator (1 << 14)
+
+typedef struct
+{
+    cJSON item; /* must be the first member */
+    const cJSON_Allocator* allocator;
+} allocator_item;
+
+/* Internal type flag for arrays and objects allocated as a container_item. Only they can have an index (see index_children),
+ * which keeps it out of every other item. */
+#define cJSON_Indexable (1 << 13)
+
+typedef struct
+{
+    cJSON item; /* must be the first member */
+    const cJSON_Allocator* allocator; /* at the same place as in allocator_item, NULL without cJSON_HasAllocator */
+    struct cJSON_Index* index;
+    size_t unindexed_count; /* children added while there is no index, it's built when this reaches CJSON_INDEX_THRESHOLD */
+} container_item;
+
+#define item_index(item) (((item)->type & cJSON_Indexable) ? ((const container_item*)(item))->index : NULL)
+
+/* set the type of an item that may have just been allocated, without losing what it was allocated as */
+#define set_item_type(item, new_type) ((item)->type = ((item)->type & (cJSON_HasAllocator | cJSON_Indexable)) | (new_type))
+
 /* Internal constructor. */
 static cJSON* cJSON_New_Item(const internal_hooks* const hooks)
 {
-    cJSON* node = (cJSON*)hooks->allocate(sizeof(cJSON));
+    cJSON* node = NULL;
+
+    if (hooks->allocator != NULL)
+    {
+        allocator_item* tagged = (allocator_item*)hooks_allocate(hooks, sizeof(allocator_item));
+        if (tagged)
+        {
+            memset(tagged, '\0', sizeof(allocator_item));
+            tagged->item.type = cJSON_HasAllocator;
+            tagged->allocator = hooks->allocator;
+        }
+
+        return (cJSON*)tagged;
+    }
+
+    node = (cJSON*)hooks_allocate(hooks, sizeof(cJSON));
     if (node)
     {
         memset(node, '\0', sizeof(cJSON));
@@ -249,1706 +437,8173 @@ static cJSON* cJSON_New_Item(const internal_hooks* const hooks)
     return node;
 }
 
-/* Delete a cJSON structure. */
-CJSON_PUBLIC(void) cJSON_Delete(cJSON* item)
+/* allocate an item that is going to be an array or object, with room for an index */
+static cJSON* new_container_item(const internal_hooks* const hooks)
 {
-    cJSON* next = NULL;
-    while (item != NULL)
+    container_item* container = NULL;
+
+    if (CJSON_INDEX_THRESHOLD == 0)
     {
-        next = item->next;
-        if (!(item->type & cJSON_IsReference) && (item->child != NULL))
+        return cJSON_New_Item(hooks);
+    }
+
+    container = (container_item*)hooks_allocate(hooks, sizeof(container_item));
+    if (container)
+    {
+        memset(container, '\0', sizeof(container_item));
+        container->item.type = cJSON_Indexable;
+        if (hooks->allocator != NULL)
         {
-            cJSON_Delete(item->child);
+            container->item.type |= cJSON_HasAllocator;
+            container->allocator = hooks->allocator;
         }
-        if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL))
+    }
+
+    return (cJSON*)container;
+}
+
+/* the hooks that own the memory of an item */
+static internal_hooks item_hooks(const cJSON* const item)
+{
+    internal_hooks hooks = global_hooks;
+
+    if ((item != NULL) && (item->type & cJSON_HasAllocator))
+    {
+        hooks.allocator = ((const allocator_item*)item)->allocator;
+    }
+
+    return hooks;
+}
+
+/* Internal type flags for items that live in an arena (see cJSON_ParseWithArena).
+ * Their memory, including the strings, belongs to the arena and is released with it. */
+#define cJSON_InArena (1 << 10)
+#define cJSON_ArenaRoot (1 << 11)
+/* Internal type flag for items parsed in situ (see cJSON_ParseInSitu). Their strings point into the
+ * caller's buffer and are additionally marked cJSON_IsReference / cJSON_StringIsConst. */
+#define cJSON_InSitu (1 << 12)
+/* Internal type flag for copy-on-write copies (see cJSON_DuplicateShared). A shared item is always also marked
+ * cJSON_IsReference / cJSON_StringIsConst: its children, value string and key belong to the item it was copied from. */
+#define cJSON_Shared (1 << 15)
+/* Internal type flag for items whose key belongs to a cJSON_KeyTable, they are also marked cJSON_StringIsConst. */
+#define cJSON_InternedKey (1 << 16)
+/* Internal type flags for lazily parsed documents (see cJSON_ParseLazy). The children of a cJSON_Lazy array or object
+ * haven't been parsed yet, its valuestring points to the document (so it's also marked cJSON_IsReference) and its
+ * valuedouble holds the number of its span. The root of the document is allocated together with it. */
+#define cJSON_Lazy (1 << 17)
+#define cJSON_LazyRoot (1 << 18)
+
+/* smallest chunk size, and alignment of every arena allocation */
+#define ARENA_MIN_CHUNK_SIZE ((size_t)16384)
+#define ARENA_ALIGNMENT ((size_t)8)
+
+typedef struct arena_chunk
+{
+    struct arena_chunk* next;
+    size_t size; /* usable bytes after the (aligned) header */
+} arena_chunk;
+
+typedef struct
+{
+    arena_chunk* chunks; /* newest chunk first */
+    unsigned char* position;
+    size_t remaining;
+    size_t next_chunk_size;
+    internal_hooks hooks;
+} parse_arena;
+
+/* The root item of an arena document is allocated together with its arena, so it can find it again. */
+typedef struct
+{
+    cJSON root; /* must be the first member */
+    parse_arena arena;
+} arena_document;
+
+#define arena_chunk_header_size (((sizeof(arena_chunk) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT) * ARENA_ALIGNMENT)
+
+static void* arena_allocate(parse_arena* const arena, size_t size)
+{
+    void* allocation = NULL;
+
+    size = ((size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT) * ARENA_ALIGNMENT;
+    if (size > arena->remaining)
+    {
+        size_t chunk_size = arena->next_chunk_size;
+        arena_chunk* chunk = NULL;
+
+        if (chunk_size < ARENA_MIN_CHUNK_SIZE)
         {
-            global_hooks.deallocate(item->valuestring);
-            item->valuestring = NULL;
+            chunk_size = ARENA_MIN_CHUNK_SIZE;
         }
-        if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
+        if (chunk_size < size)
         {
-            global_hooks.deallocate(item->string);
-            item->string = NULL;
+            chunk_size = size;
         }
-        global_hooks.deallocate(item);
-        item = next;
+        if (chunk_size > ((size_t)-1 - arena_chunk_header_size))
+        {
+            return NULL;
+        }
+
+        chunk = (arena_chunk*)arena->hooks.allocate(arena_chunk_header_size + chunk_size);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+        chunk->next = arena->chunks;
+        chunk->size = chunk_size;
+        arena->chunks = chunk;
+        arena->position = (unsigned char*)chunk + arena_chunk_header_size;
+        arena->remaining = chunk_size;
+        /* grow geometrically so a document needs only a handful of chunks */
+        arena->next_chunk_size = chunk_size * 2;
     }
+
+    allocation = arena->position;
+    arena->position += size;
+    arena->remaining -= size;
+
+    return allocation;
 }
 
-/* get the decimal point character of the current locale */
-static unsigned char get_decimal_point(void)
+static void free_arena_document(cJSON* const root)
 {
-#ifdef ENABLE_LOCALES
-    struct lconv* lconv = localeconv();
-    return (unsigned char)lconv->decimal_point[0];
-#else
-    return '.';
-#endif
+    arena_document* document = (arena_document*)root;
+    arena_chunk* chunk = document->arena.chunks;
+    void (CJSON_CDECL* deallocate)(void* pointer) = document->arena.hooks.deallocate;
+
+    while (chunk != NULL)
+    {
+        arena_chunk* next = chunk->next;
+        deallocate(chunk);
+        chunk = next;
+    }
+    deallocate(document);
 }
 
+/* Where an array or object of a lazy document starts and ends, spans are numbered in the order of their opening bracket. */
 typedef struct
 {
-    const unsigned char* content;
+    size_t open;
+    size_t close;
+    size_t next; /* the first span after the ones nested in this one */
+} lazy_span;
+
+typedef struct
+{
+    container_item root; /* must be the first member */
+    const unsigned char* text; /* the text of the root, in the buffer of the caller */
     size_t length;
-    size_t offset;
-    size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
+    lazy_span* spans;
+    size_t span_count;
     internal_hooks hooks;
-} parse_buffer;
-
-/* check if the given size is left to read in a given parse buffer (starting with 1) */
-#define can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
-/* check if the buffer can be accessed at the given index (starting with 0) */
-#define can_access_at_index(buffer, index) ((buffer != NULL) && (((buffer)->offset + index) < (buffer)->length))
-#define cannot_access_at_index(buffer, index) (!can_access_at_index(buffer, index))
-/* get a pointer to the buffer at the position */
-#define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
+} lazy_document;
 
-/* Parse the input text to generate a number, and populate the result into item. */
-static cJSON_bool parse_number(cJSON* const item, parse_buffer* const input_buffer)
+static void free_lazy_document(cJSON* const root)
 {
-    double number = 0;
-    unsigned char* after_end = NULL;
-    unsigned char number_c_string[64];
-    unsigned char decimal_point = get_decimal_point();
-    size_t i = 0;
+    lazy_document* document = (lazy_document*)root;
+    internal_hooks hooks = document->hooks;
 
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    if (document->spans != NULL)
     {
-        return false;
+        hooks_deallocate(&hooks, document->spans);
     }
+    hooks_deallocate(&hooks, document);
+}
+
+/* Child index of large arrays and objects.
+ * It caches the number of children and a vector of them in list order, so counting and indexed access don't have
+ * to walk the list. Objects whose members all have keys also get a hash table: open addressing with linear probing
+ * over the case-folded key hash, so the case sensitive and the case insensitive lookup can both use it. Every slot
+ * remembers the position of its member in the list, because with duplicate keys a lookup has to return the first
+ * one like the linear search does.
+ * An index is built where children are linked all at once (parsing, duplicating) and by the list functions once a
+ * container grows to CJSON_INDEX_THRESHOLD children. Lookups only read it, so they never write to the document. */
+typedef struct
+{
+    cJSON* item; /* NULL for an empty slot */
+    size_t hash;
+    size_t ordinal;
+} index_slot;
+
+struct cJSON_Index
+{
+    /* all children in list order */
+    cJSON** items;
+    size_t count;
+    size_t capacity;
+    /* objects only, slot_count is 0 if there is no hash table */
+    index_slot* slots;
+    size_t slot_count; /* power of two */
+    size_t next_ordinal;
+    internal_hooks hooks; /* those of the indexed item */
+};
+
+#define INDEX_MIN_SLOTS ((size_t)32)
+#define INDEX_MIN_CAPACITY ((size_t)16)
+
+/* FNV-1a over the case-folded key */
+static size_t hash_key(const unsigned char* key)
+{
+    size_t hash = (size_t)2166136261U;
 
-    /* copy the number into a temporary buffer and replace '.' with the decimal point
-     * of the current locale (for strtod)
-     * This also takes care of '\0' not necessarily being available for marking the end of the input */
-    for (i = 0; (i < (sizeof(number_c_string) - 1)) && can_access_at_index(input_buffer, i); i++)
+    for (; *key != '\0'; key++)
     {
-        switch (buffer_at_offset(input_buffer)[i])
-        {
-        case '0':
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9':
-        case '+':
-        case '-':
-        case 'e':
-        case 'E':
-            number_c_string[i] = buffer_at_offset(input_buffer)[i];
-            break;
+        hash ^= (size_t)(unsigned char)tolower(*key);
+        hash *= (size_t)16777619U;
+    }
 
-        case '.':
-            number_c_string[i] = decimal_point;
-            break;
+    return hash;
+}
 
-        default:
-            goto loop_end;
+static void free_index(cJSON* const item)
+{
+    struct cJSON_Index* index = item_index(item);
+
+    if (index != NULL)
+    {
+        internal_hooks hooks = index->hooks;
+        if (index->slots != NULL)
+        {
+            hooks_deallocate(&hooks, index->slots);
         }
+        hooks_deallocate(&hooks, index->items);
+        hooks_deallocate(&hooks, index);
+        ((container_item*)item)->index = NULL;
+        ((container_item*)item)->unindexed_count = 0;
     }
-loop_end:
-    number_c_string[i] = '\0';
+}
+
+static void index_place(index_slot* const slots, size_t slot_count, cJSON* const member, size_t hash, size_t ordinal)
+{
+    size_t position = hash & (slot_count - 1);
 
-    number = strtod((const char*)number_c_string, (char**)&after_end);
-    if (number_c_string == after_end)
+    while (slots[position].item != NULL)
     {
-        return false; /* parse_error */
+        position = (position + 1) & (slot_count - 1);
     }
+    slots[position].item = member;
+    slots[position].hash = hash;
+    slots[position].ordinal = ordinal;
+}
 
-    item->valuedouble = number;
+/* make room for count members in the hash table, keeping the load factor at or below one half */
+static cJSON_bool index_reserve_slots(struct cJSON_Index* const index, size_t count)
+{
+    size_t slot_count = INDEX_MIN_SLOTS;
+    index_slot* slots = NULL;
+    size_t i = 0;
 
-    /* use saturation in case of overflow */
-    if (number >= INT_MAX)
+    while (slot_count < (count * 2))
     {
-        item->valueint = INT_MAX;
+        if (slot_count > (((size_t)-1) / (2 * sizeof(index_slot))))
+        {
+            return false;
+        }
+        slot_count *= 2;
     }
-    else if (number <= (double)INT_MIN)
+    if (slot_count <= index->slot_count)
     {
-        item->valueint = INT_MIN;
+        return true;
     }
-    else
+
+    slots = (index_slot*)hooks_allocate(&index->hooks, slot_count * sizeof(index_slot));
+    if (slots == NULL)
     {
-        item->valueint = (int)number;
+        return false;
     }
+    memset(slots, '\0', slot_count * sizeof(index_slot));
 
-    item->type = cJSON_Number;
+    for (i = 0; i < index->slot_count; i++)
+    {
+        if (index->slots[i].item != NULL)
+        {
+            index_place(slots, slot_count, index->slots[i].item, index->slots[i].hash, index->slots[i].ordinal);
+        }
+    }
+    if (index->slots != NULL)
+    {
+        hooks_deallocate(&index->hooks, index->slots);
+    }
+    index->slots = slots;
+    index->slot_count = slot_count;
 
-    input_buffer->offset += (size_t)(after_end - number_c_string);
     return true;
 }
 
-/* don't ask me, but the original cJSON_SetNumberValue returns an integer or double */
-CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON* object, double number)
+static cJSON_bool index_reserve_items(struct cJSON_Index* const index, size_t count)
 {
-    if (number >= INT_MAX)
+    size_t capacity = (index->capacity > 0) ? index->capacity : INDEX_MIN_CAPACITY;
+    cJSON** items = NULL;
+
+    while (capacity < count)
     {
-        object->valueint = INT_MAX;
+        if (capacity > (((size_t)-1) / (2 * sizeof(cJSON*))))
+        {
+            return false;
+        }
+        capacity *= 2;
     }
-    else if (number <= (double)INT_MIN)
+    if (capacity <= index->capacity)
     {
-        object->valueint = INT_MIN;
+        return true;
     }
-    else
+
+    items = (cJSON**)hooks_allocate(&index->hooks, capacity * sizeof(cJSON*));
+    if (items == NULL)
     {
-        object->valueint = (int)number;
+        return false;
+    }
+    if (index->items != NULL)
+    {
+        memcpy(items, index->items, index->count * sizeof(cJSON*));
+        hooks_deallocate(&index->hooks, index->items);
     }
+    index->items = items;
+    index->capacity = capacity;
 
-    return object->valuedouble = number;
+    return true;
 }
 
-/* Note: when passing a NULL valuestring, cJSON_SetValuestring treats this as an error and return NULL */
-CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON* object, const char* valuestring)
+/* Build the index of an array or object, fails silently; the lookups fall back to walking the list. */
+static void index_children(cJSON* const container)
 {
-    char* copy = NULL;
-    size_t v1_len;
-    size_t v2_len;
-    /* if object's type is not cJSON_String or is cJSON_IsReference, it should not set valuestring */
-    if ((object == NULL) || !(object->type & cJSON_String) || (object->type & cJSON_IsReference))
-    {
-        return NULL;
-    }
-    /* return NULL if the object is corrupted or valuestring is NULL */
-    if (object->valuestring == NULL || valuestring == NULL)
+    struct cJSON_Index* index = NULL;
+    internal_hooks hooks;
+    cJSON* child = NULL;
+    size_t count = 0;
+    cJSON_bool all_keyed = true;
+
+    /* references share their children with the original, and arena items can't own memory */
+    if (!(container->type & cJSON_Indexable) || (item_index(container) != NULL) || !(container->type & (cJSON_Array | cJSON_Object)) || (container->type & (cJSON_IsReference | cJSON_InArena)))
     {
-        return NULL;
+        return;
     }
 
-    v1_len = strlen(valuestring);
-    v2_len = strlen(object->valuestring);
-
-    if (v1_len <= v2_len)
+    for (child = container->child; child != NULL; child = child->next)
     {
-        /* strcpy does not handle overlapping string: [X1, X2] [Y1, Y2] => X2 < Y1 or Y2 < X1 */
-        if (!(valuestring + v1_len < object->valuestring || object->valuestring + v2_len < valuestring))
-        {
-            return NULL;
-        }
-        strcpy(object->valuestring, valuestring);
-        return object->valuestring;
+        all_keyed = all_keyed && (child->string != NULL);
+        count++;
     }
-    copy = (char*)cJSON_strdup((const unsigned char*)valuestring, &global_hooks);
-    if (copy == NULL)
+
+    hooks = item_hooks(container);
+    index = (struct cJSON_Index*)hooks_allocate(&hooks, sizeof(struct cJSON_Index));
+    if (index == NULL)
     {
-        return NULL;
+        /* count again before the next attempt */
+        ((container_item*)container)->unindexed_count = 0;
+        return;
     }
-    if (object->valuestring != NULL)
+    memset(index, '\0', sizeof(struct cJSON_Index));
+    index->hooks = hooks;
+    ((container_item*)container)->index = index;
+    if (!index_reserve_items(index, count)
+        || (((container->type & 0xFF) == cJSON_Object) && all_keyed && !index_reserve_slots(index, count)))
     {
-        cJSON_free(object->valuestring);
+        free_index(container);
+        return;
     }
-    object->valuestring = copy;
 
-    return copy;
+    for (child = container->child; child != NULL; child = child->next)
+    {
+        if (index->slot_count > 0)
+        {
+            index_place(index->slots, index->slot_count, child, hash_key((const unsigned char*)child->string), index->count);
+        }
+        index->items[index->count++] = child;
+    }
+    index->next_ordinal = index->count;
 }
 
-typedef struct
-{
-    unsigned char* buffer;
-    size_t length;
-    size_t offset;
-    size_t depth; /* current nesting depth (for formatted printing) */
-    cJSON_bool noalloc;
-    cJSON_bool format; /* is this print a formatted print */
-    internal_hooks hooks;
-} printbuffer;
-
-/* realloc printbuffer if necessary to have at least "needed" bytes more */
-static unsigned char* ensure(printbuffer* const p, size_t needed)
+/* the children of container were linked all at once, there are count of them */
+static void index_linked_children(cJSON* const container, const size_t count)
 {
-    unsigned char* newbuffer = NULL;
-    size_t newsize = 0;
-
-    if ((p == NULL) || (p->buffer == NULL))
+#if CJSON_INDEX_THRESHOLD > 0
+    if (!(container->type & cJSON_Indexable))
     {
-        return NULL;
+        return;
     }
-
-    if ((p->length > 0) && (p->offset >= p->length))
+    if (count >= CJSON_INDEX_THRESHOLD)
     {
-        /* make sure that offset is valid */
-        return NULL;
+        index_children(container);
+        return;
     }
+    ((container_item*)container)->unindexed_count = count;
+#else
+    (void)container;
+    (void)count;
+#endif
+}
 
-    if (needed > INT_MAX)
-    {
-        /* sizes bigger than INT_MAX are currently not supported */
-        return NULL;
-    }
+/* hash is hash_key(name), or 0 if the caller doesn't know it yet */
+static cJSON* index_find(const struct cJSON_Index* const index, const char* const name, size_t hash, const cJSON_bool case_sensitive)
+{
+    size_t position = 0;
+    const index_slot* found = NULL;
 
-    needed += p->offset + 1;
-    if (needed <= p->length)
+    if (hash == 0)
     {
-        return p->buffer + p->offset;
-    }
-
-    if (p->noalloc) {
-        return NULL;
+        hash = hash_key((const unsigned char*)name);
     }
+    position = hash & (index->slot_count - 1);
 
-    /* calculate new buffer size */
-    if (needed > (INT_MAX / 2))
+    /* the whole cluster has to be checked, a duplicate key further down may come first in the list */
+    for (; index->slots[position].item != NULL; position = (position + 1) & (index->slot_count - 1))
     {
-        /* overflow of int, use INT_MAX if possible */
-        if (needed <= INT_MAX)
+        const index_slot* slot = &index->slots[position];
+        if ((slot->hash != hash) || ((found != NULL) && (found->ordinal < slot->ordinal)))
         {
-            newsize = INT_MAX;
+            continue;
         }
-        else
+        if (case_sensitive ? ((name == slot->item->string) || (strcmp(name, slot->item->string) == 0)) : (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)slot->item->string) == 0))
         {
-            return NULL;
+            found = slot;
         }
     }
-    else
+
+    return (found != NULL) ? found->item : NULL;
+}
+
+/* remove member from the hash table, returns its ordinal */
+static size_t index_unhash(cJSON* const object, const cJSON* const member)
+{
+    struct cJSON_Index* index = item_index(object);
+    size_t mask = index->slot_count - 1;
+    size_t position = hash_key((const unsigned char*)member->string) & mask;
+    size_t ordinal = 0;
+
+    while ((index->slots[position].item != NULL) && (index->slots[position].item != member))
     {
-        newsize = needed * 2;
+        position = (position + 1) & mask;
+    }
+    if (index->slots[position].item == NULL)
+    {
+        /* the member's key was changed behind our back */
+        free_index(object);
+        return 0;
     }
+    ordinal = index->slots[position].ordinal;
 
-    if (p->hooks.reallocate != NULL)
+    /* backward shift deletion, so no tombstones are needed */
+    for (;;)
     {
-        /* reallocate with realloc if available */
-        newbuffer = (unsigned char*)p->hooks.reallocate(p->buffer, newsize);
-        if (newbuffer == NULL)
-        {
-            p->hooks.deallocate(p->buffer);
-            p->length = 0;
-            p->buffer = NULL;
+        size_t next = (position + 1) & mask;
+        size_t home = 0;
 
-            return NULL;
+        index->slots[position].item = NULL;
+        for (;; next = (next + 1) & mask)
+        {
+            if (index->slots[next].item == NULL)
+            {
+                return ordinal;
+            }
+            home = index->slots[next].hash & mask;
+            /* move the entry back unless its home lies cyclically in (position, next] */
+            if ((position <= next) ? ((home <= position) || (home > next)) : ((home <= position) && (home > next)))
+            {
+                break;
+            }
         }
+        index->slots[position] = index->slots[next];
+        position = next;
     }
-    else
-    {
-        /* otherwise reallocate manually */
-        newbuffer = (unsigned char*)p->hooks.allocate(newsize);
-        if (!newbuffer)
-        {
-            p->hooks.deallocate(p->buffer);
-            p->length = 0;
-            p->buffer = NULL;
+}
 
-            return NULL;
-        }
+static void index_hash(cJSON* const object, cJSON* const member, size_t ordinal)
+{
+    struct cJSON_Index* index = item_index(object);
 
-        memcpy(newbuffer, p->buffer, p->offset + 1);
-        p->hooks.deallocate(p->buffer);
+    if ((member->string == NULL) || !index_reserve_slots(index, index->count))
+    {
+        free_index(object);
+        return;
     }
-    p->length = newsize;
-    p->buffer = newbuffer;
-
-    return newbuffer + p->offset;
+    index_place(index->slots, index->slot_count, member, hash_key((const unsigned char*)member->string), ordinal);
 }
 
-/* calculate the new length of the string in a printbuffer and update the offset */
-static void update_offset(printbuffer* const buffer)
+static size_t index_position(const struct cJSON_Index* const index, const cJSON* const child)
 {
-    const unsigned char* buffer_pointer = NULL;
-    if ((buffer == NULL) || (buffer->buffer == NULL))
+    size_t position = index->count;
+
+    /* removing the last child is the most common case, so search from the back */
+    while ((position > 0) && (index->items[position - 1] != child))
     {
-        return;
+        position--;
     }
-    buffer_pointer = buffer->buffer + buffer->offset;
 
-    buffer->offset += strlen((const char*)buffer_pointer);
+    return (position > 0) ? (position - 1) : index->count;
 }
 
-/* securely comparison of floating-point variables */
-static cJSON_bool compare_double(double a, double b)
+/* a child was added to container, which has no index yet */
+static void index_count_child(cJSON* const container)
 {
-    double maxVal = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
-    return (fabs(a - b) <= maxVal * DBL_EPSILON);
+#if CJSON_INDEX_THRESHOLD > 0
+    if ((container->type & cJSON_Indexable) && (++((container_item*)container)->unindexed_count >= CJSON_INDEX_THRESHOLD))
+    {
+        index_children(container);
+    }
+#else
+    (void)container;
+#endif
 }
 
-/* Render the number nicely from the given item into a string. */
-static cJSON_bool print_number(const cJSON* const item, printbuffer* const output_buffer)
+/* Index maintenance for the list functions, they are called after the list has been updated.
+ * Dropping the index is always a valid fallback. */
+static void index_append(cJSON* const container, cJSON* const child)
 {
-    unsigned char* output_pointer = NULL;
-    double d = item->valuedouble;
-    int length = 0;
-    size_t i = 0;
-    unsigned char number_buffer[26] = { 0 }; /* temporary buffer to print the number into */
-    unsigned char decimal_point = get_decimal_point();
-    double test = 0.0;
+    struct cJSON_Index* index = item_index(container);
 
-    if (output_buffer == NULL)
+    if (index == NULL)
     {
-        return false;
+        index_count_child(container);
+        return;
     }
-
-    /* This checks for NaN and Infinity */
-    if (isnan(d) || isinf(d))
+    if (!index_reserve_items(index, index->count + 1))
     {
-        length = sprintf((char*)number_buffer, "null");
+        free_index(container);
+        return;
     }
-    else if (d == (double)item->valueint)
+    index->items[index->count++] = child;
+    if (index->slot_count > 0)
     {
-        length = sprintf((char*)number_buffer, "%d", item->valueint);
+        index_hash(container, child, index->next_ordinal++);
     }
-    else
+}
+
+static void index_insert(cJSON* const container, size_t position, cJSON* const child)
+{
+    struct cJSON_Index* index = item_index(container);
+
+    if (index == NULL)
     {
-        /* Try 15 decimal places of precision to avoid nonsignificant nonzero digits */
-        length = sprintf((char*)number_buffer, "%1.15g", d);
+        index_count_child(container);
+        return;
+    }
+    /* inserting would shift the ordinals of the hash table, so objects get a new index instead */
+    if ((index->slot_count > 0) || (position > index->count) || !index_reserve_items(index, index->count + 1))
+    {
+        free_index(container);
+        index_children(container);
+        return;
+    }
+    memmove(index->items + position + 1, index->items + position, (index->count - position) * sizeof(cJSON*));
+    index->items[position] = child;
+    index->count++;
+}
+
+static void index_remove(cJSON* const container, const cJSON* const child)
+{
+    struct cJSON_Index* index = item_index(container);
+    size_t position = 0;
 
-        /* Check whether the original double can be recovered */
-        if ((sscanf((char*)number_buffer, "%lg", &test) != 1) || !compare_double((double)test, d))
+    if (index == NULL)
+    {
+        if ((container->type & cJSON_Indexable) && (((container_item*)container)->unindexed_count > 0))
         {
-            /* If not, print with 17 decimal places of precision */
-            length = sprintf((char*)number_buffer, "%1.17g", d);
+            ((container_item*)container)->unindexed_count--;
         }
+        return;
     }
-
-    /* sprintf failed or buffer overrun occurred */
-    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
+    position = index_position(index, child);
+    if (position == index->count)
     {
-        return false;
+        free_index(container);
+        return;
     }
-
-    /* reserve appropriate space in the output */
-    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
-    if (output_pointer == NULL)
+    memmove(index->items + position, index->items + position + 1, (index->count - position - 1) * sizeof(cJSON*));
+    index->count--;
+    if (index->slot_count > 0)
     {
-        return false;
+        index_unhash(container, child);
     }
+}
+
+static void index_replace(cJSON* const container, const cJSON* const child, cJSON* const replacement)
+{
+    struct cJSON_Index* index = item_index(container);
+    size_t position = 0;
 
-    /* copy the printed number to the output and replace locale
-     * dependent decimal point with '.' */
-    for (i = 0; i < ((size_t)length); i++)
+    if (index == NULL)
     {
-        if (number_buffer[i] == decimal_point)
+        return;
+    }
+    position = index_position(index, child);
+    if (position == index->count)
+    {
+        free_index(container);
+        return;
+    }
+    index->items[position] = replacement;
+    if (index->slot_count > 0)
+    {
+        /* the replacement takes over the position of child */
+        size_t ordinal = index_unhash(container, child);
+        if (item_index(container) != NULL)
         {
-            output_pointer[i] = '.';
-            continue;
+            index_hash(container, replacement, ordinal);
         }
-
-        output_pointer[i] = number_buffer[i];
     }
-    output_pointer[i] = '\0';
-
-    output_buffer->offset += (size_t)length;
-
-    return true;
 }
 
-/* parse 4 digit hexadecimal number */
-static unsigned parse_hex4(const unsigned char* const input)
+/* Delete a cJSON structure. */
+CJSON_PUBLIC(void) cJSON_Delete(cJSON* item)
 {
-    unsigned int h = 0;
-    size_t i = 0;
-
-    for (i = 0; i < 4; i++)
+    cJSON* next = NULL;
+    internal_hooks hooks;
+    while (item != NULL)
     {
-        /* parse digit */
-        if ((input[i] >= '0') && (input[i] <= '9'))
+        next = item->next;
+        if (item->type & cJSON_InArena)
         {
-            h += (unsigned int)input[i] - '0';
+            /* arena items are only released together with the whole document */
+            if (item->type & cJSON_ArenaRoot)
+            {
+                free_arena_document(item);
+            }
+            item = next;
+            continue;
         }
-        else if ((input[i] >= 'A') && (input[i] <= 'F'))
+        if (!(item->type & cJSON_IsReference) && (item->child != NULL))
         {
-            h += (unsigned int)10 + input[i] - 'A';
+            cJSON_Delete(item->child);
         }
-        else if ((input[i] >= 'a') && (input[i] <= 'f'))
+        free_index(item);
+        hooks = item_hooks(item);
+        if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL))
         {
-            h += (unsigned int)10 + input[i] - 'a';
+            hooks_deallocate(&hooks, item->valuestring);
+            item->valuestring = NULL;
         }
-        else /* invalid */
+        if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
         {
-            return 0;
+            hooks_deallocate(&hooks, item->string);
+            item->string = NULL;
         }
-
-        if (i < 3)
+        if (item->type & cJSON_LazyRoot)
         {
-            /* shift left to make place for the next nibble */
-            h = h << 4;
+            free_lazy_document(item);
+        }
+        else
+        {
+            hooks_deallocate(&hooks, item);
         }
+        item = next;
     }
+}
 
-    return h;
+/* get the decimal point character of the current locale */
+static unsigned char get_decimal_point(void)
+{
+#ifdef ENABLE_LOCALES
+    struct lconv* lconv = localeconv();
+    return (unsigned char)lconv->decimal_point[0];
+#else
+    return '.';
+#endif
 }
 
-/* converts a UTF-16 literal to UTF-8
- * A literal can be one or two sequences of the form \uXXXX */
-static unsigned char utf16_literal_to_utf8(const unsigned char* const input_pointer, const unsigned char* const input_end, unsigned char** output_pointer)
+/* The event parser hands every string to a callback and forgets it afterwards,
+ * so all its strings are decoded into one buffer that only grows. */
+typedef struct
 {
-    long unsigned int codepoint = 0;
-    unsigned int first_code = 0;
-    const unsigned char* first_sequence = input_pointer;
-    unsigned char utf8_length = 0;
-    unsigned char utf8_position = 0;
-    unsigned char sequence_length = 0;
-    unsigned char first_byte_mark = 0;
+    unsigned char* buffer;
+    size_t size;
+    internal_hooks hooks;
+} parse_scratch;
 
-    if ((input_end - first_sequence) < 6)
-    {
-        /* input ends unexpectedly */
-        goto fail;
-    }
+/* Keys of a key table are stored in an arena and found again through an open addressing hash set (linear probing). Keys are decoded into the scratch buffer first, so a key that is already known costs no allocation. */
+typedef struct
+{
+    const char* key; /* NULL for an empty slot */
+    size_t hash;
+} key_slot;
 
-    /* get the first utf16 sequence */
-    first_code = parse_hex4(first_sequence + 2);
+struct cJSON_KeyTable
+{
+    parse_arena storage;
+    parse_scratch scratch;
+    key_slot* slots;
+    size_t slot_count; /* power of two */
+    size_t count;
+};
 
-    /* check that the code is valid */
-    if (((first_code >= 0xDC00) && (first_code <= 0xDFFF)))
-    {
-        goto fail;
-    }
+typedef struct
+{
+    const unsigned char* content;
+    size_t length;
+    size_t offset;
+    size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
+    internal_hooks hooks;
+    parse_arena* arena; /* if set, items and strings are allocated from here instead of hooks */
+    cJSON_bool in_situ; /* decode strings in place, content is writable */
+    parse_scratch* scratch; /* if set, strings are decoded into this and only live until the next one */
+    cJSON_KeyTable* keys; /* if set, object keys are stored once in this table instead of once per item */
+    lazy_document* lazy; /* if set, nested arrays and objects are only parsed when they are accessed */
+    size_t next_span; /* of lazy, the span of the next array or object */
+    const char* error_reason; /* why parsing failed, set where the failure is detected */
+} parse_buffer;
 
-    /* UTF16 surrogate pair */
-    if ((first_code >= 0xD800) && (first_code <= 0xDBFF))
-    {
-        const unsigned char* second_sequence = first_sequence + 6;
-        unsigned int second_code = 0;
-        sequence_length = 12; /* \uXXXX\uXXXX */
+/* check if the given size is left to read in a given parse buffer (starting with 1) */
+#define can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
+/* check if the buffer can be accessed at the given index (starting with 0) */
+#define can_access_at_index(buffer, index) ((buffer != NULL) && (((buffer)->offset + index) < (buffer)->length))
+#define cannot_access_at_index(buffer, index) (!can_access_at_index(buffer, index))
+/* get a pointer to the buffer at the position */
+#define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
 
-        if ((input_end - second_sequence) < 6)
-        {
-            /* input ends unexpectedly */
-            goto fail;
-        }
+/* remember why parsing failed, the innermost failure is the most precise one */
+static void set_error_reason(parse_buffer* const buffer, const char* const reason)
+{
+    if ((buffer != NULL) && (buffer->error_reason == NULL))
+    {
+        buffer->error_reason = reason;
+    }
+}
 
-        if ((second_sequence[0] != '\\') || (second_sequence[1] != 'u'))
-        {
-            /* missing second half of the surrogate pair */
-            goto fail;
-        }
+/* Scanning kernels.
+ * Skipping whitespace and finding structural characters runs between every token, so these loops
+ * have SSE2/AVX2 and NEON variants. The widest variant the CPU supports is picked on first use. */
 
-        /* get the second utf16 sequence */
-        second_code = parse_hex4(second_sequence + 2);
-        /* check that the code is valid */
-        if ((second_code < 0xDC00) || (second_code > 0xDFFF))
-        {
-            /* invalid second half of the surrogate pair */
-            goto fail;
-        }
+/* number of bytes handled by classify_block */
+#define SCAN_BLOCK_SIZE 64
 
+/* one bit per byte of a block, bit 0 being the first byte */
+typedef struct
+{
+    uint64_t whitespace; /* everything <= ' ', which is what buffer_skip_whitespace skips */
+    uint64_t structural; /* { } [ ] : , */
+    uint64_t bracket; /* { } [ ] */
+    uint64_t quote;
+    uint64_t backslash;
+} block_classes;
 
-        /* calculate the unicode codepoint from the surrogate pair */
-        codepoint = 0x10000 + (((first_code & 0x3FF) << 10) | (second_code & 0x3FF));
-    }
-    else
+typedef struct
+{
+    /* returns the number of whitespace bytes at the start of input */
+    size_t (*skip_whitespace)(const unsigned char* input, size_t length);
+    /* returns the offset of the first '\"' or '\\' in input, or length if there is none */
+    size_t (*find_quote_or_backslash)(const unsigned char* input, size_t length);
+    /* classify SCAN_BLOCK_SIZE bytes starting at input */
+    void (*classify_block)(const unsigned char* input, block_classes* classes);
+    /* returns the offset of the first byte that has to be escaped when printing ('\"', '\\' or below ' '), or length if there is none */
+    size_t (*find_escape)(const unsigned char* input, size_t length);
+    /* copies input up to the first '\"' or '/' to output, leaving out ' ', '\t', '\r' and '\n'.
+     * returns the number of bytes consumed and sets written. output points into the same buffer, at or before input. */
+    size_t (*compact_whitespace)(const unsigned char* input, size_t length, unsigned char* output, size_t* written);
+} scan_kernels;
+
+/* index of the lowest set bit, bits must not be 0 */
+static unsigned int count_trailing_zeros(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctzll(bits);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index = 0;
+    _BitScanForward64(&index, bits);
+    return (unsigned int)index;
+#else
+    unsigned int count = 0;
+    while ((bits & 1) == 0)
     {
-        sequence_length = 6; /* \uXXXX */
-        codepoint = first_code;
+        bits >>= 1;
+        count++;
     }
+    return count;
+#endif
+}
 
-    /* encode as UTF-8
-     * takes at maximum 4 bytes to encode:
-     * 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx */
-    if (codepoint < 0x80)
-    {
-        /* normal ascii, encoding 0xxxxxxx */
-        utf8_length = 1;
-    }
-    else if (codepoint < 0x800)
-    {
-        /* two bytes, encoding 110xxxxx 10xxxxxx */
-        utf8_length = 2;
-        first_byte_mark = 0xC0; /* 11000000 */
-    }
-    else if (codepoint < 0x10000)
+static size_t skip_whitespace_scalar(const unsigned char* input, size_t length)
+{
+    size_t offset = 0;
+    while ((offset < length) && (input[offset] <= 32))
     {
-        /* three bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx */
-        utf8_length = 3;
-        first_byte_mark = 0xE0; /* 11100000 */
+        offset++;
     }
-    else if (codepoint <= 0x10FFFF)
+
+    return offset;
+}
+
+static size_t find_quote_or_backslash_scalar(const unsigned char* input, size_t length)
+{
+    size_t offset = 0;
+    while ((offset < length) && (input[offset] != '\"') && (input[offset] != '\\'))
     {
-        /* four bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx 10xxxxxx */
-        utf8_length = 4;
-        first_byte_mark = 0xF0; /* 11110000 */
+        offset++;
     }
-    else
+
+    return offset;
+}
+
+static void classify_block_scalar(const unsigned char* input, block_classes* classes)
+{
+    size_t i = 0;
+
+    memset(classes, 0, sizeof(block_classes));
+    for (i = 0; i < SCAN_BLOCK_SIZE; i++)
     {
-        /* invalid unicode codepoint */
-        goto fail;
+        uint64_t bit = (uint64_t)1 << i;
+        switch (input[i])
+        {
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+            classes->bracket |= bit;
+            classes->structural |= bit;
+            break;
+        case ':':
+        case ',':
+            classes->structural |= bit;
+            break;
+        case '\"':
+            classes->quote |= bit;
+            break;
+        case '\\':
+            classes->backslash |= bit;
+            break;
+        default:
+            if (input[i] <= 32)
+            {
+                classes->whitespace |= bit;
+            }
+            break;
+        }
     }
+}
 
-    /* encode as utf8 */
-    for (utf8_position = (unsigned char)(utf8_length - 1); utf8_position > 0; utf8_position--)
+static size_t find_escape_scalar(const unsigned char* input, size_t length)
+{
+    size_t offset = 0;
+    while ((offset < length) && (input[offset] >= 32) && (input[offset] != '\"') && (input[offset] != '\\'))
     {
-        /* 10xxxxxx */
-        (*output_pointer)[utf8_position] = (unsigned char)((codepoint | 0x80) & 0xBF);
-        codepoint >>= 6;
+        offset++;
     }
-    /* encode first byte */
-    if (utf8_length > 1)
+
+    return offset;
+}
+
+static size_t compact_whitespace_scalar(const unsigned char* input, size_t length, unsigned char* output, size_t* written)
+{
+    size_t offset = 0;
+    size_t count = 0;
+
+    for (offset = 0; (offset < length) && (input[offset] != '\"') && (input[offset] != '/'); offset++)
     {
-        (*output_pointer)[0] = (unsigned char)((codepoint | first_byte_mark) & 0xFF);
+        /* output never runs ahead of input, so the byte is stored unconditionally and only kept if it isn't whitespace */
+        output[count] = input[offset];
+        if ((input[offset] != ' ') && (input[offset] != '\t') && (input[offset] != '\r') && (input[offset] != '\n'))
+        {
+            count++;
+        }
     }
-    else
+
+    *written = count;
+    return offset;
+}
+
+static const scan_kernels scalar_kernels = { skip_whitespace_scalar, find_quote_or_backslash_scalar, classify_block_scalar, find_escape_scalar, compact_whitespace_scalar };
+
+#if defined(CJSON_SIMD_AVX2) || defined(CJSON_SIMD_NEON)
+/* compact_shuffle[mask] lists the positions of the bits set in mask, so shuffling 8 bytes with it
+ * moves the bytes selected by mask to the front. */
+static const unsigned char compact_shuffle[256][8] = {
+    { 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0 }, { 1, 0, 0, 0, 0, 0, 0, 0 }, { 0, 1, 0, 0, 0, 0, 0, 0 },
+    { 2, 0, 0, 0, 0, 0, 0, 0 }, { 0, 2, 0, 0, 0, 0, 0, 0 }, { 1, 2, 0, 0, 0, 0, 0, 0 }, { 0, 1, 2, 0, 0, 0, 0, 0 },
+    { 3, 0, 0, 0, 0, 0, 0, 0 }, { 0, 3, 0, 0, 0, 0, 0, 0 }, { 1, 3, 0, 0, 0, 0, 0, 0 }, { 0, 1, 3, 0, 0, 0, 0, 0 },
+    { 2, 3, 0, 0, 0, 0, 0, 0 }, { 0, 2, 3, 0, 0, 0, 0, 0 }, { 1, 2, 3, 0, 0, 0, 0, 0 }, { 0, 1, 2, 3, 0, 0, 0, 0 },
+    { 4, 0, 0, 0, 0, 0, 0, 0 }, { 0, 4, 0, 0, 0, 0, 0, 0 }, { 1, 4, 0, 0, 0, 0, 0, 0 }, { 0, 1, 4, 0, 0, 0, 0, 0 },
+    { 2, 4, 0, 0, 0, 0, 0, 0 }, { 0, 2, 4, 0, 0, 0, 0, 0 }, { 1, 2, 4, 0, 0, 0, 0, 0 }, { 0, 1, 2, 4, 0, 0, 0, 0 },
+    { 3, 4, 0, 0, 0, 0, 0, 0 }, { 0, 3, 4, 0, 0, 0, 0, 0 }, { 1, 3, 4, 0, 0, 0, 0, 0 }, { 0, 1, 3, 4, 0, 0, 0, 0 },
+    { 2, 3, 4, 0, 0, 0, 0, 0 }, { 0, 2, 3, 4, 0, 0, 0, 0 }, { 1, 2, 3, 4, 0, 0, 0, 0 }, { 0, 1, 2, 3, 4, 0, 0, 0 },
+    { 5, 0, 0, 0, 0, 0, 0, 0 }, { 0, 5, 0, 0, 0, 0, 0, 0 }, { 1, 5, 0, 0, 0, 0, 0, 0 }, { 0, 1, 5, 0, 0, 0, 0, 0 },
+    { 2, 5, 0, 0, 0, 0, 0, 0 }, { 0, 2, 5, 0, 0, 0, 0, 0 }, { 1, 2, 5, 0, 0, 0, 0, 0 }, { 0, 1, 2, 5, 0, 0, 0, 0 },
+    { 3, 5, 0, 0, 0, 0, 0, 0 }, { 0, 3, 5, 0, 0, 0, 0, 0 }, { 1, 3, 5, 0, 0, 0, 0, 0 }, { 0, 1, 3, 5, 0, 0, 0, 0 },
+    { 2, 3, 5, 0, 0, 0, 0, 0 }, { 0, 2, 3, 5, 0, 0, 0, 0 }, { 1, 2, 3, 5, 0, 0, 0, 0 }, { 0, 1, 2, 3, 5, 0, 0, 0 },
+    { 4, 5, 0, 0, 0, 0, 0, 0 }, { 0, 4, 5, 0, 0, 0, 0, 0 }, { 1, 4, 5, 0, 0, 0, 0, 0 }, { 0, 1, 4, 5, 0, 0, 0, 0 },
+    { 2, 4, 5, 0, 0, 0, 0, 0 }, { 0, 2, 4, 5, 0, 0, 0, 0 }, { 1, 2, 4, 5, 0, 0, 0, 0 }, { 0, 1, 2, 4, 5, 0, 0, 0 },
+    { 3, 4, 5, 0, 0, 0, 0, 0 }, { 0, 3, 4, 5, 0, 0, 0, 0 }, { 1, 3, 4, 5, 0, 0, 0, 0 }, { 0, 1, 3, 4, 5, 0, 0, 0 },
+    { 2, 3, 4, 5, 0, 0, 0, 0 }, { 0, 2, 3, 4, 5, 0, 0, 0 }, { 1, 2, 3, 4, 5, 0, 0, 0 }, { 0, 1, 2, 3, 4, 5, 0, 0 },
+    { 6, 0, 0, 0, 0, 0, 0, 0 }, { 0, 6, 0, 0, 0, 0, 0, 0 }, { 1, 6, 0, 0, 0, 0, 0, 0 }, { 0, 1, 6, 0, 0, 0, 0, 0 },
+    { 2, 6, 0, 0, 0, 0, 0, 0 }, { 0, 2, 6, 0, 0, 0, 0, 0 }, { 1, 2, 6, 0, 0, 0, 0, 0 }, { 0, 1, 2, 6, 0, 0, 0, 0 },
+    { 3, 6, 0, 0, 0, 0, 0, 0 }, { 0, 3, 6, 0, 0, 0, 0, 0 }, { 1, 3, 6, 0, 0, 0, 0, 0 }, { 0, 1, 3, 6, 0, 0, 0, 0 },
+    { 2, 3, 6, 0, 0, 0, 0, 0 }, { 0, 2, 3, 6, 0, 0, 0, 0 }, { 1, 2, 3, 6, 0, 0, 0, 0 }, { 0, 1, 2, 3, 6, 0, 0, 0 },
+    { 4, 6, 0, 0, 0, 0, 0, 0 }, { 0, 4, 6, 0, 0, 0, 0, 0 }, { 1, 4, 6, 0, 0, 0, 0, 0 }, { 0, 1, 4, 6, 0, 0, 0, 0 },
+    { 2, 4, 6, 0, 0, 0, 0, 0 }, { 0, 2, 4, 6, 0, 0, 0, 0 }, { 1, 2, 4, 6, 0, 0, 0, 0 }, { 0, 1, 2, 4, 6, 0, 0, 0 },
+    { 3, 4, 6, 0, 0, 0, 0, 0 }, { 0, 3, 4, 6, 0, 0, 0, 0 }, { 1, 3, 4, 6, 0, 0, 0, 0 }, { 0, 1, 3, 4, 6, 0, 0, 0 },
+    { 2, 3, 4, 6, 0, 0, 0, 0 }, { 0, 2, 3, 4, 6, 0, 0, 0 }, { 1, 2, 3, 4, 6, 0, 0, 0 }, { 0, 1, 2, 3, 4, 6, 0, 0 },
+    { 5, 6, 0, 0, 0, 0, 0, 0 }, { 0, 5, 6, 0, 0, 0, 0, 0 }, { 1, 5, 6, 0, 0, 0, 0, 0 }, { 0, 1, 5, 6, 0, 0, 0, 0 },
+    { 2, 5, 6, 0, 0, 0, 0, 0 }, { 0, 2, 5, 6, 0, 0, 0, 0 }, { 1, 2, 5, 6, 0, 0, 0, 0 }, { 0, 1, 2, 5, 6, 0, 0, 0 },
+    { 3, 5, 6, 0, 0, 0, 0, 0 }, { 0, 3, 5, 6, 0, 0, 0, 0 }, { 1, 3, 5, 6, 0, 0, 0, 0 }, { 0, 1, 3, 5, 6, 0, 0, 0 },
+    { 2, 3, 5, 6, 0, 0, 0, 0 }, { 0, 2, 3, 5, 6, 0, 0, 0 }, { 1, 2, 3, 5, 6, 0, 0, 0 }, { 0, 1, 2, 3, 5, 6, 0, 0 },
+    { 4, 5, 6, 0, 0, 0, 0, 0 }, { 0, 4, 5, 6, 0, 0, 0, 0 }, { 1, 4, 5, 6, 0, 0, 0, 0 }, { 0, 1, 4, 5, 6, 0, 0, 0 },
+    { 2, 4, 5, 6, 0, 0, 0, 0 }, { 0, 2, 4, 5, 6, 0, 0, 0 }, { 1, 2, 4, 5, 6, 0, 0, 0 }, { 0, 1, 2, 4, 5, 6, 0, 0 },
+    { 3, 4, 5, 6, 0, 0, 0, 0 }, { 0, 3, 4, 5, 6, 0, 0, 0 }, { 1, 3, 4, 5, 6, 0, 0, 0 }, { 0, 1, 3, 4, 5, 6, 0, 0 },
+    { 2, 3, 4, 5, 6, 0, 0, 0 }, { 0, 2, 3, 4, 5, 6, 0, 0 }, { 1, 2, 3, 4, 5, 6, 0, 0 }, { 0, 1, 2, 3, 4, 5, 6, 0 },
+    { 7, 0, 0, 0, 0, 0, 0, 0 }, { 0, 7, 0, 0, 0, 0, 0, 0 }, { 1, 7, 0, 0, 0, 0, 0, 0 }, { 0, 1, 7, 0, 0, 0, 0, 0 },
+    { 2, 7, 0, 0, 0, 0, 0, 0 }, { 0, 2, 7, 0, 0, 0, 0, 0 }, { 1, 2, 7, 0, 0, 0, 0, 0 }, { 0, 1, 2, 7, 0, 0, 0, 0 },
+    { 3, 7, 0, 0, 0, 0, 0, 0 }, { 0, 3, 7, 0, 0, 0, 0, 0 }, { 1, 3, 7, 0, 0, 0, 0, 0 }, { 0, 1, 3, 7, 0, 0, 0, 0 },
+    { 2, 3, 7, 0, 0, 0, 0, 0 }, { 0, 2, 3, 7, 0, 0, 0, 0 }, { 1, 2, 3, 7, 0, 0, 0, 0 }, { 0, 1, 2, 3, 7, 0, 0, 0 },
+    { 4, 7, 0, 0, 0, 0, 0, 0 }, { 0, 4, 7, 0, 0, 0, 0, 0 }, { 1, 4, 7, 0, 0, 0, 0, 0 }, { 0, 1, 4, 7, 0, 0, 0, 0 },
+    { 2, 4, 7, 0, 0, 0, 0, 0 }, { 0, 2, 4, 7, 0, 0, 0, 0 }, { 1, 2, 4, 7, 0, 0, 0, 0 }, { 0, 1, 2, 4, 7, 0, 0, 0 },
+    { 3, 4, 7, 0, 0, 0, 0, 0 }, { 0, 3, 4, 7, 0, 0, 0, 0 }, { 1, 3, 4, 7, 0, 0, 0, 0 }, { 0, 1, 3, 4, 7, 0, 0, 0 },
+    { 2, 3, 4, 7, 0, 0, 0, 0 }, { 0, 2, 3, 4, 7, 0, 0, 0 }, { 1, 2, 3, 4, 7, 0, 0, 0 }, { 0, 1, 2, 3, 4, 7, 0, 0 },
+    { 5, 7, 0, 0, 0, 0, 0, 0 }, { 0, 5, 7, 0, 0, 0, 0, 0 }, { 1, 5, 7, 0, 0, 0, 0, 0 }, { 0, 1, 5, 7, 0, 0, 0, 0 },
+    { 2, 5, 7, 0, 0, 0, 0, 0 }, { 0, 2, 5, 7, 0, 0, 0, 0 }, { 1, 2, 5, 7, 0, 0, 0, 0 }, { 0, 1, 2, 5, 7, 0, 0, 0 },
+    { 3, 5, 7, 0, 0, 0, 0, 0 }, { 0, 3, 5, 7, 0, 0, 0, 0 }, { 1, 3, 5, 7, 0, 0, 0, 0 }, { 0, 1, 3, 5, 7, 0, 0, 0 },
+    { 2, 3, 5, 7, 0, 0, 0, 0 }, { 0, 2, 3, 5, 7, 0, 0, 0 }, { 1, 2, 3, 5, 7, 0, 0, 0 }, { 0, 1, 2, 3, 5, 7, 0, 0 },
+    { 4, 5, 7, 0, 0, 0, 0, 0 }, { 0, 4, 5, 7, 0, 0, 0, 0 }, { 1, 4, 5, 7, 0, 0, 0, 0 }, { 0, 1, 4, 5, 7, 0, 0, 0 },
+    { 2, 4, 5, 7, 0, 0, 0, 0 }, { 0, 2, 4, 5, 7, 0, 0, 0 }, { 1, 2, 4, 5, 7, 0, 0, 0 }, { 0, 1, 2, 4, 5, 7, 0, 0 },
+    { 3, 4, 5, 7, 0, 0, 0, 0 }, { 0, 3, 4, 5, 7, 0, 0, 0 }, { 1, 3, 4, 5, 7, 0, 0, 0 }, { 0, 1, 3, 4, 5, 7, 0, 0 },
+    { 2, 3, 4, 5, 7, 0, 0, 0 }, { 0, 2, 3, 4, 5, 7, 0, 0 }, { 1, 2, 3, 4, 5, 7, 0, 0 }, { 0, 1, 2, 3, 4, 5, 7, 0 },
+    { 6, 7, 0, 0, 0, 0, 0, 0 }, { 0, 6, 7, 0, 0, 0, 0, 0 }, { 1, 6, 7, 0, 0, 0, 0, 0 }, { 0, 1, 6, 7, 0, 0, 0, 0 },
+    { 2, 6, 7, 0, 0, 0, 0, 0 }, { 0, 2, 6, 7, 0, 0, 0, 0 }, { 1, 2, 6, 7, 0, 0, 0, 0 }, { 0, 1, 2, 6, 7, 0, 0, 0 },
+    { 3, 6, 7, 0, 0, 0, 0, 0 }, { 0, 3, 6, 7, 0, 0, 0, 0 }, { 1, 3, 6, 7, 0, 0, 0, 0 }, { 0, 1, 3, 6, 7, 0, 0, 0 },
+    { 2, 3, 6, 7, 0, 0, 0, 0 }, { 0, 2, 3, 6, 7, 0, 0, 0 }, { 1, 2, 3, 6, 7, 0, 0, 0 }, { 0, 1, 2, 3, 6, 7, 0, 0 },
+    { 4, 6, 7, 0, 0, 0, 0, 0 }, { 0, 4, 6, 7, 0, 0, 0, 0 }, { 1, 4, 6, 7, 0, 0, 0, 0 }, { 0, 1, 4, 6, 7, 0, 0, 0 },
+    { 2, 4, 6, 7, 0, 0, 0, 0 }, { 0, 2, 4, 6, 7, 0, 0, 0 }, { 1, 2, 4, 6, 7, 0, 0, 0 }, { 0, 1, 2, 4, 6, 7, 0, 0 },
+    { 3, 4, 6, 7, 0, 0, 0, 0 }, { 0, 3, 4, 6, 7, 0, 0, 0 }, { 1, 3, 4, 6, 7, 0, 0, 0 }, { 0, 1, 3, 4, 6, 7, 0, 0 },
+    { 2, 3, 4, 6, 7, 0, 0, 0 }, { 0, 2, 3, 4, 6, 7, 0, 0 }, { 1, 2, 3, 4, 6, 7, 0, 0 }, { 0, 1, 2, 3, 4, 6, 7, 0 },
+    { 5, 6, 7, 0, 0, 0, 0, 0 }, { 0, 5, 6, 7, 0, 0, 0, 0 }, { 1, 5, 6, 7, 0, 0, 0, 0 }, { 0, 1, 5, 6, 7, 0, 0, 0 },
+    { 2, 5, 6, 7, 0, 0, 0, 0 }, { 0, 2, 5, 6, 7, 0, 0, 0 }, { 1, 2, 5, 6, 7, 0, 0, 0 }, { 0, 1, 2, 5, 6, 7, 0, 0 },
+    { 3, 5, 6, 7, 0, 0, 0, 0 }, { 0, 3, 5, 6, 7, 0, 0, 0 }, { 1, 3, 5, 6, 7, 0, 0, 0 }, { 0, 1, 3, 5, 6, 7, 0, 0 },
+    { 2, 3, 5, 6, 7, 0, 0, 0 }, { 0, 2, 3, 5, 6, 7, 0, 0 }, { 1, 2, 3, 5, 6, 7, 0, 0 }, { 0, 1, 2, 3, 5, 6, 7, 0 },
+    { 4, 5, 6, 7, 0, 0, 0, 0 }, { 0, 4, 5, 6, 7, 0, 0, 0 }, { 1, 4, 5, 6, 7, 0, 0, 0 }, { 0, 1, 4, 5, 6, 7, 0, 0 },
+    { 2, 4, 5, 6, 7, 0, 0, 0 }, { 0, 2, 4, 5, 6, 7, 0, 0 }, { 1, 2, 4, 5, 6, 7, 0, 0 }, { 0, 1, 2, 4, 5, 6, 7, 0 },
+    { 3, 4, 5, 6, 7, 0, 0, 0 }, { 0, 3, 4, 5, 6, 7, 0, 0 }, { 1, 3, 4, 5, 6, 7, 0, 0 }, { 0, 1, 3, 4, 5, 6, 7, 0 },
+    { 2, 3, 4, 5, 6, 7, 0, 0 }, { 0, 2, 3, 4, 5, 6, 7, 0 }, { 1, 2, 3, 4, 5, 6, 7, 0 }, { 0, 1, 2, 3, 4, 5, 6, 7 }
+};
+
+static unsigned int count_bits_8(unsigned int bits)
+{
+    bits = bits - ((bits >> 1) & 0x55);
+    bits = (bits & 0x33) + ((bits >> 2) & 0x33);
+    return (bits + (bits >> 4)) & 0x0F;
+}
+#endif
+
+#ifdef CJSON_SIMD_SSE2
+static size_t skip_whitespace_sse2(const unsigned char* input, size_t length)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    size_t offset = 0;
+
+    while ((offset + 16) <= length)
     {
-        (*output_pointer)[0] = (unsigned char)(codepoint & 0x7F);
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(input + offset));
+        /* there is no unsigned compare, but max(c, ' ') == ' ' is the same as c <= ' ' */
+        unsigned int whitespace = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(chunk, space), space));
+        if (whitespace != 0xFFFF)
+        {
+            return offset + count_trailing_zeros(~whitespace);
+        }
+        offset += 16;
     }
 
-    *output_pointer += utf8_length;
+    return offset + skip_whitespace_scalar(input + offset, length - offset);
+}
 
-    return sequence_length;
+static size_t find_quote_or_backslash_sse2(const unsigned char* input, size_t length)
+{
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    size_t offset = 0;
 
-fail:
-    return 0;
+    while ((offset + 16) <= length)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(input + offset));
+        unsigned int special = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+        if (special != 0)
+        {
+            return offset + count_trailing_zeros(special);
+        }
+        offset += 16;
+    }
+
+    return offset + find_quote_or_backslash_scalar(input + offset, length - offset);
 }
 
-/* Parse the input text into an unescaped cinput, and populate item. */
-static cJSON_bool parse_string(cJSON* const item, parse_buffer* const input_buffer)
+static void classify_block_sse2(const unsigned char* input, block_classes* classes)
 {
-    const unsigned char* input_pointer = buffer_at_offset(input_buffer) + 1;
-    const unsigned char* input_end = buffer_at_offset(input_buffer) + 1;
-    unsigned char* output_pointer = NULL;
-    unsigned char* output = NULL;
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i bracket_bit = _mm_set1_epi8(0x20);
+    const __m128i open_brace = _mm_set1_epi8('{');
+    const __m128i close_brace = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    size_t i = 0;
 
-    /* not a string */
-    if (buffer_at_offset(input_buffer)[0] != '\"')
+    memset(classes, 0, sizeof(block_classes));
+    for (i = 0; i < SCAN_BLOCK_SIZE; i += 16)
     {
-        goto fail;
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(input + i));
+        /* '[' and ']' only differ from '{' and '}' in bit 5 */
+        __m128i folded = _mm_or_si128(chunk, bracket_bit);
+        __m128i brackets = _mm_or_si128(_mm_cmpeq_epi8(folded, open_brace), _mm_cmpeq_epi8(folded, close_brace));
+        __m128i structural = _mm_or_si128(brackets, _mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma)));
+
+        classes->whitespace |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(chunk, space), space)) << i;
+        classes->structural |= (uint64_t)(unsigned int)_mm_movemask_epi8(structural) << i;
+        classes->bracket |= (uint64_t)(unsigned int)_mm_movemask_epi8(brackets) << i;
+        classes->quote |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)) << i;
+        classes->backslash |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)) << i;
     }
+}
+
+static size_t find_escape_sse2(const unsigned char* input, size_t length)
+{
+    const __m128i last_control = _mm_set1_epi8(31);
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    size_t offset = 0;
 
+    while ((offset + 16) <= length)
     {
-        /* calculate approximate size of the output (overestimate) */
-        size_t allocation_length = 0;
-        size_t skipped_bytes = 0;
-        while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
-        {
-            /* is escape sequence */
-            if (input_end[0] == '\\')
-            {
-                if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
-                {
-                    /* prevent buffer overflow when last input character is a backslash */
-                    goto fail;
-                }
-                skipped_bytes++;
-                input_end++;
-            }
-            input_end++;
-        }
-        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(input + offset));
+        __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, last_control), last_control);
+        unsigned int special = (unsigned int)_mm_movemask_epi8(_mm_or_si128(control, _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash))));
+        if (special != 0)
         {
-            goto fail; /* string ended unexpectedly */
+            return offset + count_trailing_zeros(special);
         }
+        offset += 16;
+    }
 
-        /* This is at most how much we need for the output */
-        allocation_length = (size_t)(input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char*)input_buffer->hooks.allocate(allocation_length + sizeof(""));
-        if (output == NULL)
+    return offset + find_escape_scalar(input + offset, length - offset);
+}
+
+static size_t compact_whitespace_sse2(const unsigned char* input, size_t length, unsigned char* output, size_t* written)
+{
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    const __m128i line_feed = _mm_set1_epi8('\n');
+    size_t offset = 0;
+    size_t count = 0;
+    size_t tail = 0;
+
+    while ((offset + 16) <= length)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(input + offset));
+        unsigned int stop = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, slash)));
+        unsigned int whitespace = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage_return), _mm_cmpeq_epi8(chunk, line_feed))));
+        unsigned int end = (stop != 0) ? count_trailing_zeros(stop) : 16;
+        unsigned int before_stop = (1U << end) - 1;
+        unsigned int keep = ~whitespace & before_stop;
+
+        if ((keep == before_stop) && ((output + count) == (input + offset)))
         {
-            goto fail; /* allocation failure */
+            /* nothing was left out so far, storing the bytes again would only stall the next load */
+            count += end;
         }
-    }
-
-    output_pointer = output;
-    /* loop through the string literal */
-    while (input_pointer < input_end)
-    {
-        if (*input_pointer != '\\')
+        else if (keep == 0xFFFF)
         {
-            *output_pointer++ = *input_pointer++;
+            _mm_storeu_si128((__m128i*)(void*)(output + count), chunk);
+            count += 16;
         }
-        /* escape sequence */
         else
         {
-            unsigned char sequence_length = 2;
-            if ((input_end - input_pointer) < 1)
+            /* SSE2 has no byte shuffle, pick the kept bytes one by one */
+            while (keep != 0)
             {
-                goto fail;
+                output[count++] = input[offset + count_trailing_zeros(keep)];
+                keep &= keep - 1;
             }
+        }
 
-            switch (input_pointer[1])
-            {
-            case 'b':
-                *output_pointer++ = '\b';
-                break;
-            case 'f':
-                *output_pointer++ = '\f';
-                break;
-            case 'n':
-                *output_pointer++ = '\n';
-                break;
-            case 'r':
-                *output_pointer++ = '\r';
-                break;
-            case 't':
-                *output_pointer++ = '\t';
-                break;
-            case '\"':
-            case '\\':
-            case '/':
-                *output_pointer++ = input_pointer[1];
-                break;
-
-                /* UTF-16 literal */
-            case 'u':
-                sequence_length = utf16_literal_to_utf8(input_pointer, input_end, &output_pointer);
-                if (sequence_length == 0)
-                {
-                    /* failed to convert UTF16-literal to UTF-8 */
-                    goto fail;
-                }
-                break;
-
-            default:
-                goto fail;
-            }
-            input_pointer += sequence_length;
+        if (stop != 0)
+        {
+            *written = count;
+            return offset + end;
         }
+        offset += 16;
     }
 
-    /* zero terminate the output */
-    *output_pointer = '\0';
-
-    item->type = cJSON_String;
-    item->valuestring = (char*)output;
-
-    input_buffer->offset = (size_t)(input_end - input_buffer->content);
-    input_buffer->offset++;
+    offset += compact_whitespace_scalar(input + offset, length - offset, output + count, &tail);
+    *written = count + tail;
+    return offset;
+}
 
-    return true;
+static const scan_kernels sse2_kernels = { skip_whitespace_sse2, find_quote_or_backslash_sse2, classify_block_sse2, find_escape_sse2, compact_whitespace_sse2 };
+#endif /* CJSON_SIMD_SSE2 */
 
-fail:
-    if (output != NULL)
-    {
-        input_buffer->hooks.deallocate(output);
-        output = NULL;
-    }
+#ifdef CJSON_SIMD_AVX2
+CJSON_TARGET_AVX2 static size_t skip_whitespace_avx2(const unsigned char* input, size_t length)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    size_t offset = 0;
 
-    if (input_pointer != NULL)
+    while ((offset + 32) <= length)
     {
-        input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)(input + offset));
+        uint32_t whitespace = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(chunk, space), space));
+        if (whitespace != 0xFFFFFFFF)
+        {
+            return offset + count_trailing_zeros(~whitespace);
+        }
+        offset += 32;
     }
+    /* leaving the upper halves dirty would make the SSE2 code stall on every instruction */
+    _mm256_zeroupper();
 
-    return false;
+    return offset + skip_whitespace_sse2(input + offset, length - offset);
 }
 
-/* Render the cstring provided to an escaped version that can be printed. */
-static cJSON_bool print_string_ptr(const unsigned char* const input, printbuffer* const output_buffer)
+CJSON_TARGET_AVX2 static size_t find_quote_or_backslash_avx2(const unsigned char* input, size_t length)
 {
-    const unsigned char* input_pointer = NULL;
-    unsigned char* output = NULL;
-    unsigned char* output_pointer = NULL;
-    size_t output_length = 0;
-    /* numbers of additional characters needed for escaping */
-    size_t escape_characters = 0;
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    size_t offset = 0;
 
-    if (output_buffer == NULL)
+    while ((offset + 32) <= length)
     {
-        return false;
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)(input + offset));
+        uint32_t special = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)));
+        if (special != 0)
+        {
+            return offset + count_trailing_zeros(special);
+        }
+        offset += 32;
+    }
+    /* leaving the upper halves dirty would make the SSE2 code stall on every instruction */
+    _mm256_zeroupper();
+
+    return offset + find_quote_or_backslash_sse2(input + offset, length - offset);
+}
+
+CJSON_TARGET_AVX2 static void classify_block_avx2(const unsigned char* input, block_classes* classes)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i bracket_bit = _mm256_set1_epi8(0x20);
+    const __m256i open_brace = _mm256_set1_epi8('{');
+    const __m256i close_brace = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    size_t i = 0;
+
+    memset(classes, 0, sizeof(block_classes));
+    for (i = 0; i < SCAN_BLOCK_SIZE; i += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)(input + i));
+        __m256i folded = _mm256_or_si256(chunk, bracket_bit);
+        __m256i brackets = _mm256_or_si256(_mm256_cmpeq_epi8(folded, open_brace), _mm256_cmpeq_epi8(folded, close_brace));
+        __m256i structural = _mm256_or_si256(brackets, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon), _mm256_cmpeq_epi8(chunk, comma)));
+
+        classes->whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(chunk, space), space)) << i;
+        classes->structural |= (uint64_t)(uint32_t)_mm256_movemask_epi8(structural) << i;
+        classes->bracket |= (uint64_t)(uint32_t)_mm256_movemask_epi8(brackets) << i;
+        classes->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)) << i;
+        classes->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash)) << i;
+    }
+}
+
+CJSON_TARGET_AVX2 static size_t find_escape_avx2(const unsigned char* input, size_t length)
+{
+    const __m256i last_control = _mm256_set1_epi8(31);
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    size_t offset = 0;
+
+    while ((offset + 32) <= length)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)(input + offset));
+        __m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, last_control), last_control);
+        uint32_t special = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(control, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash))));
+        if (special != 0)
+        {
+            return offset + count_trailing_zeros(special);
+        }
+        offset += 32;
+    }
+    /* leaving the upper halves dirty would make the SSE2 code stall on every instruction */
+    _mm256_zeroupper();
+
+    return offset + find_escape_sse2(input + offset, length - offset);
+}
+
+/* Runs between strings are mostly a few bytes long, so this works on 16 bytes at a time like the SSE2 kernel.
+ * What AVX2 adds is the byte shuffle that packs the kept bytes of a block together. */
+CJSON_TARGET_AVX2 static size_t compact_whitespace_avx2(const unsigned char* input, size_t length, unsigned char* output, size_t* written)
+{
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    const __m128i line_feed = _mm_set1_epi8('\n');
+    const __m128i high_offset = _mm_set1_epi8(8);
+    size_t offset = 0;
+    size_t count = 0;
+    size_t tail = 0;
+
+    while ((offset + 16) <= length)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(input + offset));
+        unsigned int stop = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, slash)));
+        unsigned int whitespace = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage_return), _mm_cmpeq_epi8(chunk, line_feed))));
+        unsigned int end = (stop != 0) ? count_trailing_zeros(stop) : 16;
+        unsigned int before_stop = (1U << end) - 1;
+        unsigned int keep = ~whitespace & before_stop;
+
+        if ((keep == before_stop) && ((output + count) == (input + offset)))
+        {
+            /* nothing was left out so far, storing the bytes again would only stall the next load */
+            count += end;
+        }
+        else if (keep == 0xFFFF)
+        {
+            _mm_storeu_si128((__m128i*)(void*)(output + count), chunk);
+            count += 16;
+        }
+        else if ((keep != 0) && ((stop == 0) || ((size_t)((input + offset) - (output + count)) >= 16)))
+        {
+            /* The stores end before the first byte not consumed yet, so this is safe in place.
+             * That holds for the whole block, or if output is far enough behind input. */
+            size_t low_count = count_bits_8(keep & 0xFF);
+            __m128i low = _mm_loadl_epi64((const __m128i*)(const void*)compact_shuffle[keep & 0xFF]);
+            __m128i high = _mm_add_epi8(_mm_loadl_epi64((const __m128i*)(const void*)compact_shuffle[keep >> 8]), high_offset);
+            __m128i packed = _mm_shuffle_epi8(chunk, _mm_unpacklo_epi64(low, high));
+
+            _mm_storel_epi64((__m128i*)(void*)(output + count), packed);
+            _mm_storel_epi64((__m128i*)(void*)(output + count + low_count), _mm_srli_si128(packed, 8));
+            count += low_count + count_bits_8(keep >> 8);
+        }
+        else
+        {
+            /* the bytes from the stop on are read again by the caller, so they must not be overwritten */
+            while (keep != 0)
+            {
+                output[count++] = input[offset + count_trailing_zeros(keep)];
+                keep &= keep - 1;
+            }
+        }
+
+        if (stop != 0)
+        {
+            *written = count;
+            return offset + end;
+        }
+        offset += 16;
+    }
+
+    offset += compact_whitespace_scalar(input + offset, length - offset, output + count, &tail);
+    *written = count + tail;
+    return offset;
+}
+
+static const scan_kernels avx2_kernels = { skip_whitespace_avx2, find_quote_or_backslash_avx2, classify_block_avx2, find_escape_avx2, compact_whitespace_avx2 };
+
+static cJSON_bool cpu_supports_avx2(void)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? true : false;
+#else
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    /* the OS has to save the ymm registers (OSXSAVE, AVX and XCR0 bits 1 and 2) */
+    __cpuid(info, 1);
+    if (((info[2] & (1 << 27)) == 0) || ((info[2] & (1 << 28)) == 0) || ((_xgetbv(0) & 6) != 6))
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) ? true : false;
+#endif
+}
+#endif /* CJSON_SIMD_AVX2 */
+
+#ifdef CJSON_SIMD_NEON
+/* NEON has no movemask, collapse each byte of the comparison result to a single bit */
+static uint64_t neon_movemask(uint8x16_t input)
+{
+    static const uint8_t bit_weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t weighted = vandq_u8(input, vld1q_u8(bit_weights));
+
+    return (uint64_t)vaddv_u8(vget_low_u8(weighted)) | ((uint64_t)vaddv_u8(vget_high_u8(weighted)) << 8);
+}
+
+static size_t skip_whitespace_neon(const unsigned char* input, size_t length)
+{
+    const uint8x16_t space = vdupq_n_u8(' ');
+    size_t offset = 0;
+
+    while ((offset + 16) <= length)
+    {
+        uint8x16_t significant = vcgtq_u8(vld1q_u8(input + offset), space);
+        /* narrowing shift leaves 4 bits per input byte */
+        uint64_t nibbles = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(significant), 4)), 0);
+        if (nibbles != 0)
+        {
+            return offset + (count_trailing_zeros(nibbles) >> 2);
+        }
+        offset += 16;
+    }
+
+    return offset + skip_whitespace_scalar(input + offset, length - offset);
+}
+
+static size_t find_quote_or_backslash_neon(const unsigned char* input, size_t length)
+{
+    const uint8x16_t quote = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    size_t offset = 0;
+
+    while ((offset + 16) <= length)
+    {
+        uint8x16_t chunk = vld1q_u8(input + offset);
+        uint8x16_t special = vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash));
+        uint64_t nibbles = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(special), 4)), 0);
+        if (nibbles != 0)
+        {
+            return offset + (count_trailing_zeros(nibbles) >> 2);
+        }
+        offset += 16;
+    }
+
+    return offset + find_quote_or_backslash_scalar(input + offset, length - offset);
+}
+
+static void classify_block_neon(const unsigned char* input, block_classes* classes)
+{
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t bracket_bit = vdupq_n_u8(0x20);
+    size_t i = 0;
+
+    memset(classes, 0, sizeof(block_classes));
+    for (i = 0; i < SCAN_BLOCK_SIZE; i += 16)
+    {
+        uint8x16_t chunk = vld1q_u8(input + i);
+        uint8x16_t folded = vorrq_u8(chunk, bracket_bit);
+        uint8x16_t brackets = vorrq_u8(vceqq_u8(folded, vdupq_n_u8('{')), vceqq_u8(folded, vdupq_n_u8('}')));
+        uint8x16_t structural = vorrq_u8(brackets, vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(':')), vceqq_u8(chunk, vdupq_n_u8(','))));
+
+        classes->whitespace |= neon_movemask(vcleq_u8(chunk, space)) << i;
+        classes->structural |= neon_movemask(structural) << i;
+        classes->bracket |= neon_movemask(brackets) << i;
+        classes->quote |= neon_movemask(vceqq_u8(chunk, vdupq_n_u8('\"'))) << i;
+        classes->backslash |= neon_movemask(vceqq_u8(chunk, vdupq_n_u8('\\'))) << i;
+    }
+}
+
+static size_t find_escape_neon(const unsigned char* input, size_t length)
+{
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t quote = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    size_t offset = 0;
+
+    while ((offset + 16) <= length)
+    {
+        uint8x16_t chunk = vld1q_u8(input + offset);
+        uint8x16_t special = vorrq_u8(vcltq_u8(chunk, space), vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)));
+        uint64_t nibbles = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(special), 4)), 0);
+        if (nibbles != 0)
+        {
+            return offset + (count_trailing_zeros(nibbles) >> 2);
+        }
+        offset += 16;
+    }
+
+    return offset + find_escape_scalar(input + offset, length - offset);
+}
+
+static size_t compact_whitespace_neon(const unsigned char* input, size_t length, unsigned char* output, size_t* written)
+{
+    const uint8x16_t quote = vdupq_n_u8('\"');
+    const uint8x16_t slash = vdupq_n_u8('/');
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t carriage_return = vdupq_n_u8('\r');
+    const uint8x16_t line_feed = vdupq_n_u8('\n');
+    size_t offset = 0;
+    size_t count = 0;
+    size_t tail = 0;
+
+    while ((offset + 16) <= length)
+    {
+        uint8x16_t chunk = vld1q_u8(input + offset);
+        unsigned int stop = (unsigned int)neon_movemask(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, slash)));
+        unsigned int whitespace = (unsigned int)neon_movemask(vorrq_u8(
+            vorrq_u8(vceqq_u8(chunk, space), vceqq_u8(chunk, tab)),
+            vorrq_u8(vceqq_u8(chunk, carriage_return), vceqq_u8(chunk, line_feed))));
+        unsigned int end = (stop != 0) ? count_trailing_zeros(stop) : 16;
+        unsigned int before_stop = (1U << end) - 1;
+        unsigned int keep = ~whitespace & before_stop;
+
+        if ((keep == before_stop) && ((output + count) == (input + offset)))
+        {
+            /* nothing was left out so far, storing the bytes again would only stall the next load */
+            count += end;
+        }
+        else if (keep == 0xFFFF)
+        {
+            vst1q_u8(output + count, chunk);
+            count += 16;
+        }
+        else if ((keep != 0) && ((stop == 0) || ((size_t)((input + offset) - (output + count)) >= 16)))
+        {
+            /* the stores end before the first byte not consumed yet, see compact_whitespace_avx2 */
+            size_t low_count = count_bits_8(keep & 0xFF);
+            uint8x16_t shuffle = vcombine_u8(vld1_u8(compact_shuffle[keep & 0xFF]), vadd_u8(vld1_u8(compact_shuffle[keep >> 8]), vdup_n_u8(8)));
+            uint8x16_t packed = vqtbl1q_u8(chunk, shuffle);
+
+            vst1_u8(output + count, vget_low_u8(packed));
+            vst1_u8(output + count + low_count, vget_high_u8(packed));
+            count += low_count + count_bits_8(keep >> 8);
+        }
+        else
+        {
+            /* the bytes from the stop on are read again by the caller, so they must not be overwritten */
+            while (keep != 0)
+            {
+                output[count++] = input[offset + count_trailing_zeros(keep)];
+                keep &= keep - 1;
+            }
+        }
+
+        if (stop != 0)
+        {
+            *written = count;
+            return offset + end;
+        }
+        offset += 16;
+    }
+
+    offset += compact_whitespace_scalar(input + offset, length - offset, output + count, &tail);
+    *written = count + tail;
+    return offset;
+}
+
+static const scan_kernels neon_kernels = { skip_whitespace_neon, find_quote_or_backslash_neon, classify_block_neon, find_escape_neon, compact_whitespace_neon };
+#endif /* CJSON_SIMD_NEON */
+
+static const scan_kernels* select_scan_kernels(void)
+{
+#if defined(CJSON_SIMD_AVX2)
+    if (cpu_supports_avx2())
+    {
+        return &avx2_kernels;
+    }
+#endif
+#if defined(CJSON_SIMD_SSE2)
+    return &sse2_kernels;
+#elif defined(CJSON_SIMD_NEON)
+    return &neon_kernels;
+#endif
+    return &scalar_kernels;
+}
+
+/* Selection is idempotent, so racing threads at most repeat the CPU check. */
+static const scan_kernels* active_scan_kernels = NULL;
+
+static const scan_kernels* get_scan_kernels(void)
+{
+    if (active_scan_kernels == NULL)
+    {
+        active_scan_kernels = select_scan_kernels();
+    }
+
+    return active_scan_kernels;
+}
+
+static void* scratch_allocate(parse_scratch* const scratch, size_t size)
+{
+    if (size > scratch->size)
+    {
+        size_t new_size = (scratch->size > 0) ? scratch->size : 256;
+        while (new_size < size)
+        {
+            if (new_size > (((size_t)-1) / 2))
+            {
+                new_size = size;
+                break;
+            }
+            new_size *= 2;
+        }
+
+        if (scratch->buffer != NULL)
+        {
+            scratch->hooks.deallocate(scratch->buffer);
+        }
+        scratch->buffer = (unsigned char*)scratch->hooks.allocate(new_size);
+        scratch->size = (scratch->buffer != NULL) ? new_size : 0;
+    }
+
+    return scratch->buffer;
+}
+
+/* returns the copy of key stored in table, adding one first if there is none */
+static const char* key_table_intern(cJSON_KeyTable* const table, const char* const key)
+{
+    size_t hash = (size_t)2166136261U;
+    size_t position = 0;
+    size_t length = 0;
+    char* copy = NULL;
+
+    /* FNV-1a, unlike hash_key without case folding */
+    for (length = 0; key[length] != '\0'; length++)
+    {
+        hash ^= (size_t)(unsigned char)key[length];
+        hash *= (size_t)16777619U;
+    }
+
+    if (table->slot_count > 0)
+    {
+        for (position = hash & (table->slot_count - 1); table->slots[position].key != NULL; position = (position + 1) & (table->slot_count - 1))
+        {
+            if ((table->slots[position].hash == hash) && (memcmp(key, table->slots[position].key, length + sizeof("")) == 0))
+            {
+                return table->slots[position].key;
+            }
+        }
+    }
+
+    /* keep the table at most half full */
+    if (((table->count + 1) * 2) > table->slot_count)
+    {
+        size_t new_count = (table->slot_count > 0) ? (table->slot_count * 2) : 64;
+        key_slot* new_slots = NULL;
+        size_t index = 0;
+
+        if (new_count > (((size_t)-1) / sizeof(key_slot)))
+        {
+            return NULL;
+        }
+        new_slots = (key_slot*)table->storage.hooks.allocate(new_count * sizeof(key_slot));
+        if (new_slots == NULL)
+        {
+            return NULL;
+        }
+        memset(new_slots, '\0', new_count * sizeof(key_slot));
+        for (index = 0; index < table->slot_count; index++)
+        {
+            if (table->slots[index].key != NULL)
+            {
+                for (position = table->slots[index].hash & (new_count - 1); new_slots[position].key != NULL; position = (position + 1) & (new_count - 1))
+                {
+                }
+                new_slots[position] = table->slots[index];
+            }
+        }
+        if (table->slots != NULL)
+        {
+            table->storage.hooks.deallocate(table->slots);
+        }
+        table->slots = new_slots;
+        table->slot_count = new_count;
+
+        for (position = hash & (new_count - 1); table->slots[position].key != NULL; position = (position + 1) & (new_count - 1))
+        {
+        }
+    }
+
+    copy = (char*)arena_allocate(&table->storage, length + sizeof(""));
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(copy, key, length + sizeof(""));
+
+    table->slots[position].key = copy;
+    table->slots[position].hash = hash;
+    table->count++;
+
+    return copy;
+}
+
+/* allocation helpers for the parser, these respect the arena and the scratch buffer of the buffer */
+static void* parse_allocate(parse_buffer* const buffer, size_t size)
+{
+    if (buffer->arena != NULL)
+    {
+        return arena_allocate(buffer->arena, size);
+    }
+    if (buffer->scratch != NULL)
+    {
+        return scratch_allocate(buffer->scratch, size);
+    }
+
+    return hooks_allocate(&buffer->hooks, size);
+}
+
+/* container tells whether the item is going to be an array or object */
+static cJSON* parse_new_item(parse_buffer* const buffer, const cJSON_bool container)
+{
+    cJSON* node = NULL;
+
+    if (buffer->arena == NULL)
+    {
+        return container ? new_container_item(&(buffer->hooks)) : cJSON_New_Item(&(buffer->hooks));
+    }
+
+    node = (cJSON*)arena_allocate(buffer->arena, sizeof(cJSON));
+    if (node)
+    {
+        memset(node, '\0', sizeof(cJSON));
+    }
+
+    return node;
+}
+
+/* whether the value at offset, after whitespace, is an array or object */
+static cJSON_bool container_follows(const parse_buffer* const buffer, size_t offset)
+{
+    while ((offset < buffer->length) && (buffer->content[offset] <= 32))
+    {
+        offset++;
+    }
+
+    return (offset < buffer->length) && ((buffer->content[offset] == '[') || (buffer->content[offset] == '{'));
+}
+
+/* mark a completely parsed item with the ownership of its memory */
+static void finish_parsed_item(cJSON* const item, const parse_buffer* const buffer)
+{
+    if (buffer->arena != NULL)
+    {
+        item->type |= cJSON_InArena;
+    }
+    if (buffer->in_situ)
+    {
+        if (item->string != NULL)
+        {
+            item->type |= cJSON_StringIsConst;
+        }
+        if ((item->type & 0xFF) == cJSON_String)
+        {
+            item->type |= cJSON_IsReference;
+        }
+        item->type |= cJSON_InSitu;
+    }
+    if ((buffer->keys != NULL) && (item->string != NULL))
+    {
+        item->type |= cJSON_StringIsConst | cJSON_InternedKey;
+    }
+}
+
+/* Clinger's fast path needs double arithmetic to round exactly once, which excess precision (x87) would break.
+ * Doubles are evaluated as double for FLT_EVAL_METHOD 0 and also for 16, where only _Float16 is widened (GCC on AArch64). */
+#if defined(FLT_EVAL_METHOD)
+#define CJSON_FLT_EVAL_METHOD FLT_EVAL_METHOD
+#elif defined(__FLT_EVAL_METHOD__)
+#define CJSON_FLT_EVAL_METHOD __FLT_EVAL_METHOD__
+#endif
+#if (defined(CJSON_FLT_EVAL_METHOD) && ((CJSON_FLT_EVAL_METHOD == 0) || (CJSON_FLT_EVAL_METHOD == 16))) || defined(_M_X64) || defined(_M_ARM64)
+#define CJSON_EXACT_DOUBLE_ARITHMETIC
+#endif
+
+#define MAX_EXACT_INTEGER ((uint64_t)1 << 53)
+
+/* every power of ten up to 1e22 is exactly representable as a double */
+static const double exact_powers_of_ten[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* Convert a numeral without calling into libc. This only handles numbers whose value it can get exactly right:
+ * the significant digits have to fit into 53 bits and the power of ten has to be exact as well, so one correctly
+ * rounded multiplication or division gives the correctly rounded result (Clinger's fast path).
+ * That covers integers and the usual short decimals, everything else is left to strtod. */
+static cJSON_bool parse_number_fast(const unsigned char* const numeral, const size_t length, double* const result)
+{
+    uint64_t mantissa = 0;
+    size_t significant_digits = 0;
+    size_t integer_digits = 0;
+    long exponent = 0;
+    long explicit_exponent = 0;
+    cJSON_bool negative = false;
+    cJSON_bool negative_exponent = false;
+    double value = 0;
+    size_t position = 0;
+
+    if ((position < length) && (numeral[position] == '-'))
+    {
+        negative = true;
+        position++;
+    }
+
+    for (; (position < length) && (numeral[position] >= '0') && (numeral[position] <= '9'); position++)
+    {
+        if ((mantissa != 0) || (numeral[position] != '0'))
+        {
+            significant_digits++;
+            mantissa = (mantissa * 10) + (uint64_t)(numeral[position] - '0');
+        }
+        integer_digits++;
+    }
+    if ((integer_digits == 0) || (significant_digits > 19))
+    {
+        return false;
+    }
+
+    if ((position < length) && (numeral[position] == '.'))
+    {
+        size_t fraction_digits = 0;
+        for (position++; (position < length) && (numeral[position] >= '0') && (numeral[position] <= '9'); position++)
+        {
+            if ((mantissa != 0) || (numeral[position] != '0'))
+            {
+                significant_digits++;
+                mantissa = (mantissa * 10) + (uint64_t)(numeral[position] - '0');
+            }
+            exponent--;
+            fraction_digits++;
+        }
+        if ((fraction_digits == 0) || (significant_digits > 19))
+        {
+            return false;
+        }
+    }
+
+    if ((position < length) && ((numeral[position] == 'e') || (numeral[position] == 'E')))
+    {
+        size_t exponent_digits = 0;
+        position++;
+        if ((position < length) && ((numeral[position] == '+') || (numeral[position] == '-')))
+        {
+            negative_exponent = (numeral[position] == '-');
+            position++;
+        }
+        for (; (position < length) && (numeral[position] >= '0') && (numeral[position] <= '9'); position++)
+        {
+            /* anything this large is out of the fast path's range anyway */
+            if (explicit_exponent < 10000)
+            {
+                explicit_exponent = (explicit_exponent * 10) + (numeral[position] - '0');
+            }
+            exponent_digits++;
+        }
+        if (exponent_digits == 0)
+        {
+            return false;
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    /* leftovers like in "1.2.3" are up to strtod to reject */
+    if ((position != length) || (mantissa > MAX_EXACT_INTEGER))
+    {
+        return false;
+    }
+
+    if ((mantissa == 0) || (exponent == 0))
+    {
+        value = (double)mantissa;
+    }
+#ifdef CJSON_EXACT_DOUBLE_ARITHMETIC
+    else if ((exponent < 0) && (exponent >= -22))
+    {
+        value = (double)mantissa / exact_powers_of_ten[-exponent];
+    }
+    else if ((exponent > 0) && (exponent <= 22))
+    {
+        value = (double)mantissa * exact_powers_of_ten[exponent];
+    }
+    else if ((exponent > 22) && (exponent <= (22 + 15)))
+    {
+        /* short mantissas with a large exponent, e.g. 1e30, can move some zeros into the mantissa */
+        for (; exponent > 22; exponent--)
+        {
+            mantissa *= 10;
+            if (mantissa > MAX_EXACT_INTEGER)
+            {
+                return false;
+            }
+        }
+        value = (double)mantissa * exact_powers_of_ten[22];
+    }
+#endif
+    else
+    {
+        return false;
+    }
+
+    *result = negative ? -value : value;
+    return true;
+}
+
+/* Parse the input text to generate a number, and populate the result into item. */
+static cJSON_bool parse_number(cJSON* const item, parse_buffer* const input_buffer)
+{
+    double number = 0;
+    unsigned char* after_end = NULL;
+    unsigned char number_c_string[64];
+    unsigned char* number_string = number_c_string;
+    const unsigned char* numeral = NULL;
+    unsigned char decimal_point = '.';
+    size_t length = 0;
+    size_t i = 0;
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false;
+    }
+
+    /* find the end of the numeral, this also takes care of '\0' not necessarily being available for marking the end of the input */
+    numeral = buffer_at_offset(input_buffer);
+    for (length = 0; can_access_at_index(input_buffer, length); length++)
+    {
+        switch (numeral[length])
+        {
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+        case '+':
+        case '-':
+        case 'e':
+        case 'E':
+        case '.':
+            continue;
+
+        default:
+            break;
+        }
+        break;
+    }
+
+    if (parse_number_fast(numeral, length, &number))
+    {
+        input_buffer->offset += length;
+    }
+    else
+    {
+        /* copy the number into a temporary buffer and replace '.' with the decimal point
+         * of the current locale (for strtod) */
+        if (length >= sizeof(number_c_string))
+        {
+            number_string = (unsigned char*)hooks_allocate(&input_buffer->hooks, length + 1);
+            if (number_string == NULL)
+            {
+                set_error_reason(input_buffer, "out of memory");
+                return false;
+            }
+        }
+        decimal_point = get_decimal_point();
+        for (i = 0; i < length; i++)
+        {
+            number_string[i] = (numeral[i] == '.') ? decimal_point : numeral[i];
+        }
+        number_string[length] = '\0';
+
+        number = strtod((const char*)number_string, (char**)&after_end);
+        length = (size_t)(after_end - number_string);
+        if (number_string != number_c_string)
+        {
+            hooks_deallocate(&input_buffer->hooks, number_string);
+        }
+        if (length == 0)
+        {
+            set_error_reason(input_buffer, "invalid number");
+            return false; /* parse_error */
+        }
+        input_buffer->offset += length;
+    }
+
+    item->valuedouble = number;
+
+    /* use saturation in case of overflow */
+    if (number >= INT_MAX)
+    {
+        item->valueint = INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        item->valueint = INT_MIN;
+    }
+    else
+    {
+        item->valueint = (int)number;
+    }
+
+    set_item_type(item, cJSON_Number);
+
+    return true;
+}
+
+/* don't ask me, but the original cJSON_SetNumberValue returns an integer or double */
+CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON* object, double number)
+{
+    if (number >= INT_MAX)
+    {
+        object->valueint = INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        object->valueint = INT_MIN;
+    }
+    else
+    {
+        object->valueint = (int)number;
+    }
+
+    return object->valuedouble = number;
+}
+
+/* Note: when passing a NULL valuestring, cJSON_SetValuestring treats this as an error and return NULL */
+CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON* object, const char* valuestring)
+{
+    char* copy = NULL;
+    size_t v1_len;
+    size_t v2_len;
+    internal_hooks hooks;
+    /* if object's type is not cJSON_String or is cJSON_IsReference, it should not set valuestring.
+     * Shared copies and strings parsed in situ are the exception, they get a string of their own. */
+    if ((object == NULL) || !(object->type & cJSON_String) || ((object->type & (cJSON_IsReference | cJSON_Shared | cJSON_InSitu)) == cJSON_IsReference))
+    {
+        return NULL;
+    }
+    /* return NULL if the object is corrupted or valuestring is NULL */
+    if (object->valuestring == NULL || valuestring == NULL)
+    {
+        return NULL;
+    }
+
+    v1_len = strlen(valuestring);
+    v2_len = strlen(object->valuestring);
+
+    if ((v1_len <= v2_len) && !(object->type & cJSON_Shared))
+    {
+        /* strcpy does not handle overlapping string: [X1, X2] [Y1, Y2] => X2 < Y1 or Y2 < X1 */
+        if (!(valuestring + v1_len < object->valuestring || object->valuestring + v2_len < valuestring))
+        {
+            return NULL;
+        }
+        strcpy(object->valuestring, valuestring);
+        return object->valuestring;
+    }
+    if (object->type & cJSON_InArena)
+    {
+        /* the arena can't grow a string in place */
+        return NULL;
+    }
+    hooks = item_hooks(object);
+    copy = (char*)cJSON_strdup((const unsigned char*)valuestring, &hooks);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    /* a shared string belongs to the original, one parsed in situ to the caller's buffer */
+    if ((object->valuestring != NULL) && !(object->type & (cJSON_IsReference | cJSON_Shared)))
+    {
+        hooks_deallocate(&hooks, object->valuestring);
+    }
+    object->valuestring = copy;
+    object->type &= ~(cJSON_IsReference | cJSON_Shared);
+
+    return copy;
+}
+
+typedef struct
+{
+    unsigned char* buffer;
+    size_t length;
+    size_t offset;
+    size_t depth; /* current nesting depth (for formatted printing) */
+    cJSON_bool noalloc;
+    cJSON_bool format; /* is this print a formatted print */
+    internal_hooks hooks;
+    cJSON_WriteFunction write; /* if set, the output is handed to it whenever the buffer is full instead of growing it */
+    void* write_context;
+    unsigned char* fixed_buffer; /* initial buffer of a writer, not allocated with hooks */
+} printbuffer;
+
+/* size of the buffer cJSON_PrintToWriter hands to the writer in one piece */
+#define PRINT_WRITER_CHUNK_SIZE 4096
+
+/* realloc printbuffer if necessary to have at least "needed" bytes more */
+static unsigned char* ensure(printbuffer* const p, size_t needed)
+{
+    unsigned char* newbuffer = NULL;
+    size_t newsize = 0;
+
+    if ((p == NULL) || (p->buffer == NULL))
+    {
+        return NULL;
+    }
+
+    if ((p->length > 0) && (p->offset >= p->length))
+    {
+        /* make sure that offset is valid */
+        return NULL;
+    }
+
+    if (needed > INT_MAX)
+    {
+        /* sizes bigger than INT_MAX are currently not supported */
+        return NULL;
+    }
+
+    needed += p->offset + 1;
+    if (needed <= p->length)
+    {
+        return p->buffer + p->offset;
+    }
+
+    if (p->write != NULL)
+    {
+        /* pass on what is printed so far and continue at the start of the buffer */
+        if ((p->offset > 0) && !p->write(p->write_context, (const char*)p->buffer, p->offset))
+        {
+            return NULL;
+        }
+        needed -= p->offset;
+        p->offset = 0;
+        if ((p->buffer != p->fixed_buffer) && (needed <= PRINT_WRITER_CHUNK_SIZE))
+        {
+            /* back to fixed size pieces after an oversized string */
+            hooks_deallocate(&p->hooks, p->buffer);
+            p->buffer = p->fixed_buffer;
+            p->length = PRINT_WRITER_CHUNK_SIZE;
+        }
+        if (needed <= p->length)
+        {
+            return p->buffer;
+        }
+
+        /* a single string or raw value that doesn't fit into the buffer, it gets a buffer of its own */
+        newbuffer = (unsigned char*)hooks_allocate(&p->hooks, needed);
+        if (newbuffer == NULL)
+        {
+            return NULL;
+        }
+        if (p->buffer != p->fixed_buffer)
+        {
+            hooks_deallocate(&p->hooks, p->buffer);
+        }
+        p->length = needed;
+        p->buffer = newbuffer;
+
+        return newbuffer;
+    }
+
+    if (p->noalloc) {
+        return NULL;
+    }
+
+    /* calculate new buffer size */
+    if (needed > (INT_MAX / 2))
+    {
+        /* overflow of int, use INT_MAX if possible */
+        if (needed <= INT_MAX)
+        {
+            newsize = INT_MAX;
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        newsize = needed * 2;
+    }
+
+    if (hooks_can_reallocate(&p->hooks))
+    {
+        /* reallocate with realloc if available */
+        newbuffer = (unsigned char*)hooks_reallocate(&p->hooks, p->buffer, newsize);
+        if (newbuffer == NULL)
+        {
+            hooks_deallocate(&p->hooks, p->buffer);
+            p->length = 0;
+            p->buffer = NULL;
+
+            return NULL;
+        }
+    }
+    else
+    {
+        /* otherwise reallocate manually */
+        newbuffer = (unsigned char*)hooks_allocate(&p->hooks, newsize);
+        if (!newbuffer)
+        {
+            hooks_deallocate(&p->hooks, p->buffer);
+            p->length = 0;
+            p->buffer = NULL;
+
+            return NULL;
+        }
+
+        memcpy(newbuffer, p->buffer, p->offset + 1);
+        hooks_deallocate(&p->hooks, p->buffer);
+    }
+    p->length = newsize;
+    p->buffer = newbuffer;
+
+    return newbuffer + p->offset;
+}
+
+/* securely comparison of floating-point variables */
+static cJSON_bool compare_double(double a, double b)
+{
+    double maxVal = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+    return (fabs(a - b) <= maxVal * DBL_EPSILON);
+}
+
+/* enough for any number cJSON prints, including a terminator */
+#define NUMBER_TEXT_SIZE 26
+
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* print an int without going through sprintf, returns the number of characters written */
+static size_t print_integer(const int integer, unsigned char* const output)
+{
+    /* negate in unsigned arithmetic, so INT_MIN works as well */
+    unsigned int magnitude = (integer < 0) ? (0U - (unsigned int)integer) : (unsigned int)integer;
+    size_t digits = 1;
+    size_t length = 0;
+    unsigned char* digit = NULL;
+    unsigned int counter = 0;
+
+    for (counter = magnitude; counter >= 10; counter /= 10)
+    {
+        digits++;
+    }
+    length = digits + ((integer < 0) ? 1 : 0);
+    output[0] = '-';
+
+    /* write two digits at a time, from the back */
+    digit = output + length;
+    while (magnitude >= 100)
+    {
+        const char* pair = digit_pairs + ((magnitude % 100) * 2);
+        magnitude /= 100;
+        *--digit = (unsigned char)pair[1];
+        *--digit = (unsigned char)pair[0];
+    }
+    if (magnitude >= 10)
+    {
+        const char* pair = digit_pairs + (magnitude * 2);
+        *--digit = (unsigned char)pair[1];
+        *--digit = (unsigned char)pair[0];
+    }
+    else
+    {
+        *--digit = (unsigned char)('0' + magnitude);
+    }
+
+    return length;
+}
+
+/* Shortest round trip formatting of doubles with Grisu3 (Loitsch, "Printing Floating-Point Numbers Quickly and
+ * Accurately with Integers"). For all but about half a percent of the doubles it finds the shortest digit string that
+ * reads back as the same double, and of those the closest to the exact value. For the rest it can't be sure and gives up. */
+typedef struct
+{
+    uint64_t f;
+    int e;
+} diy_fp;
+
+typedef struct
+{
+    uint64_t f;
+    short e;
+    short k;
+} cached_power;
+
+/* normalized approximations of 10^k = f * 2^e for k = -348, -340, ..., 340 */
+static const cached_power cached_powers[] =
+{
+    { UINT64_C(0xfa8fd5a0081c0288), -1220, -348 }, { UINT64_C(0xbaaee17fa23ebf76), -1193, -340 },
+    { UINT64_C(0x8b16fb203055ac76), -1166, -332 }, { UINT64_C(0xcf42894a5dce35ea), -1140, -324 },
+    { UINT64_C(0x9a6bb0aa55653b2d), -1113, -316 }, { UINT64_C(0xe61acf033d1a45df), -1087, -308 },
+    { UINT64_C(0xab70fe17c79ac6ca), -1060, -300 }, { UINT64_C(0xff77b1fcbebcdc4f), -1034, -292 },
+    { UINT64_C(0xbe5691ef416bd60c), -1007, -284 }, { UINT64_C(0x8dd01fad907ffc3c), -980, -276 },
+    { UINT64_C(0xd3515c2831559a83), -954, -268 }, { UINT64_C(0x9d71ac8fada6c9b5), -927, -260 },
+    { UINT64_C(0xea9c227723ee8bcb), -901, -252 }, { UINT64_C(0xaecc49914078536d), -874, -244 },
+    { UINT64_C(0x823c12795db6ce57), -847, -236 }, { UINT64_C(0xc21094364dfb5637), -821, -228 },
+    { UINT64_C(0x9096ea6f3848984f), -794, -220 }, { UINT64_C(0xd77485cb25823ac7), -768, -212 },
+    { UINT64_C(0xa086cfcd97bf97f4), -741, -204 }, { UINT64_C(0xef340a98172aace5), -715, -196 },
+    { UINT64_C(0xb23867fb2a35b28e), -688, -188 }, { UINT64_C(0x84c8d4dfd2c63f3b), -661, -180 },
+    { UINT64_C(0xc5dd44271ad3cdba), -635, -172 }, { UINT64_C(0x936b9fcebb25c996), -608, -164 },
+    { UINT64_C(0xdbac6c247d62a584), -582, -156 }, { UINT64_C(0xa3ab66580d5fdaf6), -555, -148 },
+    { UINT64_C(0xf3e2f893dec3f126), -529, -140 }, { UINT64_C(0xb5b5ada8aaff80b8), -502, -132 },
+    { UINT64_C(0x87625f056c7c4a8b), -475, -124 }, { UINT64_C(0xc9bcff6034c13053), -449, -116 },
+    { UINT64_C(0x964e858c91ba2655), -422, -108 }, { UINT64_C(0xdff9772470297ebd), -396, -100 },
+    { UINT64_C(0xa6dfbd9fb8e5b88f), -369, -92 }, { UINT64_C(0xf8a95fcf88747d94), -343, -84 },
+    { UINT64_C(0xb94470938fa89bcf), -316, -76 }, { UINT64_C(0x8a08f0f8bf0f156b), -289, -68 },
+    { UINT64_C(0xcdb02555653131b6), -263, -60 }, { UINT64_C(0x993fe2c6d07b7fac), -236, -52 },
+    { UINT64_C(0xe45c10c42a2b3b06), -210, -44 }, { UINT64_C(0xaa242499697392d3), -183, -36 },
+    { UINT64_C(0xfd87b5f28300ca0e), -157, -28 }, { UINT64_C(0xbce5086492111aeb), -130, -20 },
+    { UINT64_C(0x8cbccc096f5088cc), -103, -12 }, { UINT64_C(0xd1b71758e219652c), -77, -4 },
+    { UINT64_C(0x9c40000000000000), -50, 4 }, { UINT64_C(0xe8d4a51000000000), -24, 12 },
+    { UINT64_C(0xad78ebc5ac620000), 3, 20 }, { UINT64_C(0x813f3978f8940984), 30, 28 },
+    { UINT64_C(0xc097ce7bc90715b3), 56, 36 }, { UINT64_C(0x8f7e32ce7bea5c70), 83, 44 },
+    { UINT64_C(0xd5d238a4abe98068), 109, 52 }, { UINT64_C(0x9f4f2726179a2245), 136, 60 },
+    { UINT64_C(0xed63a231d4c4fb27), 162, 68 }, { UINT64_C(0xb0de65388cc8ada8), 189, 76 },
+    { UINT64_C(0x83c7088e1aab65db), 216, 84 }, { UINT64_C(0xc45d1df942711d9a), 242, 92 },
+    { UINT64_C(0x924d692ca61be758), 269, 100 }, { UINT64_C(0xda01ee641a708dea), 295, 108 },
+    { UINT64_C(0xa26da3999aef774a), 322, 116 }, { UINT64_C(0xf209787bb47d6b85), 348, 124 },
+    { UINT64_C(0xb454e4a179dd1877), 375, 132 }, { UINT64_C(0x865b86925b9bc5c2), 402, 140 },
+    { UINT64_C(0xc83553c5c8965d3d), 428, 148 }, { UINT64_C(0x952ab45cfa97a0b3), 455, 156 },
+    { UINT64_C(0xde469fbd99a05fe3), 481, 164 }, { UINT64_C(0xa59bc234db398c25), 508, 172 },
+    { UINT64_C(0xf6c69a72a3989f5c), 534, 180 }, { UINT64_C(0xb7dcbf5354e9bece), 561, 188 },
+    { UINT64_C(0x88fcf317f22241e2), 588, 196 }, { UINT64_C(0xcc20ce9bd35c78a5), 614, 204 },
+    { UINT64_C(0x98165af37b2153df), 641, 212 }, { UINT64_C(0xe2a0b5dc971f303a), 667, 220 },
+    { UINT64_C(0xa8d9d1535ce3b396), 694, 228 }, { UINT64_C(0xfb9b7cd9a4a7443c), 720, 236 },
+    { UINT64_C(0xbb764c4ca7a44410), 747, 244 }, { UINT64_C(0x8bab8eefb6409c1a), 774, 252 },
+    { UINT64_C(0xd01fef10a657842c), 800, 260 }, { UINT64_C(0x9b10a4e5e9913129), 827, 268 },
+    { UINT64_C(0xe7109bfba19c0c9d), 853, 276 }, { UINT64_C(0xac2820d9623bf429), 880, 284 },
+    { UINT64_C(0x80444b5e7aa7cf85), 907, 292 }, { UINT64_C(0xbf21e44003acdd2d), 933, 300 },
+    { UINT64_C(0x8e679c2f5e44ff8f), 960, 308 }, { UINT64_C(0xd433179d9c8cb841), 986, 316 },
+    { UINT64_C(0x9e19db92b4e31ba9), 1013, 324 }, { UINT64_C(0xeb96bf6ebadf77d9), 1039, 332 },
+    { UINT64_C(0xaf87023b9bf0ee6b), 1066, 340 }
+};
+
+#define CACHED_POWERS_MIN_K (-348)
+#define CACHED_POWERS_STEP 8
+/* the scaled values have their binary exponent in this range, so their integral part fits into 32 bits */
+#define GRISU_MIN_EXPONENT (-60)
+#define GRISU_MAX_EXPONENT (-32)
+
+/* the upper 64 bits of the product, rounded */
+static diy_fp diy_fp_multiply(const diy_fp x, const diy_fp y)
+{
+    const uint64_t mask = UINT64_C(0xFFFFFFFF);
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & mask;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & mask;
+    uint64_t ad = a * d;
+    uint64_t bc = b * c;
+    uint64_t middle = ((b * d) >> 32) + (ad & mask) + (bc & mask) + (UINT64_C(1) << 31);
+    diy_fp product;
+
+    product.f = (a * c) + (ad >> 32) + (bc >> 32) + (middle >> 32);
+    product.e = x.e + y.e + 64;
+
+    return product;
+}
+
+static diy_fp diy_fp_normalize(diy_fp x)
+{
+    while ((x.f & (UINT64_C(0xFFC) << 52)) == 0)
+    {
+        x.f <<= 10;
+        x.e -= 10;
+    }
+    while ((x.f & (UINT64_C(1) << 63)) == 0)
+    {
+        x.f <<= 1;
+        x.e--;
+    }
+
+    return x;
+}
+
+/* Remove digits from the end of the buffer as long as that gets closer to w while staying in the safe interval,
+ * then check that the result is guaranteed to be the closest. rest is the distance from the digits to too_high. */
+static cJSON_bool grisu_round_weed(unsigned char* const buffer, const size_t length, const uint64_t distance_too_high_w, const uint64_t unsafe_interval, uint64_t rest, const uint64_t ten_kappa, const uint64_t unit)
+{
+    uint64_t small_distance = distance_too_high_w - unit;
+    uint64_t big_distance = distance_too_high_w + unit;
+
+    while ((rest < small_distance) && ((unsafe_interval - rest) >= ten_kappa)
+           && (((rest + ten_kappa) < small_distance) || ((small_distance - rest) >= (rest + ten_kappa - small_distance))))
+    {
+        buffer[length - 1]--;
+        rest += ten_kappa;
+    }
+
+    /* if the next smaller number might be closer to the real w, we can't decide */
+    if ((rest < big_distance) && ((unsafe_interval - rest) >= ten_kappa)
+        && (((rest + ten_kappa) < big_distance) || ((big_distance - rest) > (rest + ten_kappa - big_distance))))
+    {
+        return false;
+    }
+
+    return ((2 * unit) <= rest) && (rest <= (unsafe_interval - (4 * unit)));
+}
+
+/* generate the shortest digits of w that lie between low and high, w = digits * 10^kappa */
+static cJSON_bool grisu_digits(const diy_fp low, const diy_fp w, const diy_fp high, unsigned char* const buffer, size_t* const length, int* const kappa)
+{
+    uint64_t unit = 1;
+    uint64_t too_high = high.f + unit;
+    uint64_t unsafe_interval = too_high - (low.f - unit);
+    int shift = -w.e;
+    uint64_t one = UINT64_C(1) << shift;
+    uint32_t integrals = (uint32_t)(too_high >> shift);
+    uint64_t fractionals = too_high & (one - 1);
+    uint32_t divisor = 1000000000;
+    uint64_t rest = 0;
+
+    *kappa = 10;
+    while ((divisor > integrals) && (*kappa > 0))
+    {
+        divisor /= 10;
+        (*kappa)--;
+    }
+
+    *length = 0;
+    while (*kappa > 0)
+    {
+        buffer[(*length)++] = (unsigned char)('0' + (integrals / divisor));
+        integrals %= divisor;
+        (*kappa)--;
+        rest = ((uint64_t)integrals << shift) + fractionals;
+        if (rest < unsafe_interval)
+        {
+            return grisu_round_weed(buffer, *length, too_high - w.f, unsafe_interval, rest, (uint64_t)divisor << shift, unit);
+        }
+        divisor /= 10;
+    }
+
+    for (;;)
+    {
+        fractionals *= 10;
+        unit *= 10;
+        unsafe_interval *= 10;
+        buffer[(*length)++] = (unsigned char)('0' + (fractionals >> shift));
+        fractionals &= one - 1;
+        (*kappa)--;
+        if (fractionals < unsafe_interval)
+        {
+            return grisu_round_weed(buffer, *length, (too_high - w.f) * unit, unsafe_interval, fractionals, one, unit);
+        }
+    }
+}
+
+/* Print a finite, non-zero double in the notation printf's %g uses with 15 digits of precision, or with as many as
+ * it takes if that's more. Returns the number of characters written or 0 if Grisu3 gave up. */
+static size_t print_shortest_double(const double number, unsigned char* const output)
+{
+    uint64_t bits = 0;
+    uint64_t significand = 0;
+    int biased_exponent = 0;
+    diy_fp w;
+    diy_fp plus;
+    diy_fp minus;
+    const cached_power* power = NULL;
+    int index = 0;
+    unsigned char digits[20];
+    size_t digit_count = 0;
+    int kappa = 0;
+    int exponent = 0;
+    int precision = 0;
+    unsigned char* output_pointer = output;
+    size_t i = 0;
+
+    memcpy(&bits, &number, sizeof(bits));
+    significand = bits & ((UINT64_C(1) << 52) - 1);
+    biased_exponent = (int)((bits >> 52) & 0x7FF);
+    if (biased_exponent != 0)
+    {
+        w.f = significand | (UINT64_C(1) << 52);
+        w.e = biased_exponent - 1075;
+    }
+    else
+    {
+        w.f = significand;
+        w.e = -1074;
+    }
+
+    /* the boundaries are halfway to the neighbouring doubles, the lower one is closer at powers of two */
+    plus.f = (w.f << 1) + 1;
+    plus.e = w.e - 1;
+    plus = diy_fp_normalize(plus);
+    if ((significand == 0) && (biased_exponent > 1))
+    {
+        minus.f = (w.f << 2) - 1;
+        minus.e = w.e - 2;
+    }
+    else
+    {
+        minus.f = (w.f << 1) - 1;
+        minus.e = w.e - 1;
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+    w = diy_fp_normalize(w);
+
+    /* estimate the cached power via log10(2), then correct the estimate */
+    index = ((int)ceil((GRISU_MIN_EXPONENT - (w.e + 64) + 63) * 0.30102999566398114) - CACHED_POWERS_MIN_K - 1) / CACHED_POWERS_STEP + 1;
+    if (index < 0)
+    {
+        index = 0;
+    }
+    while ((index > 0) && ((w.e + cached_powers[index].e + 64) > GRISU_MAX_EXPONENT))
+    {
+        index--;
+    }
+    while (((size_t)index < (sizeof(cached_powers) / sizeof(cached_powers[0]) - 1)) && ((w.e + cached_powers[index].e + 64) < GRISU_MIN_EXPONENT))
+    {
+        index++;
+    }
+    power = &cached_powers[index];
+    {
+        diy_fp scale;
+        scale.f = power->f;
+        scale.e = power->e;
+        if (!grisu_digits(diy_fp_multiply(minus, scale), diy_fp_multiply(w, scale), diy_fp_multiply(plus, scale), digits, &digit_count, &kappa))
+        {
+            return 0;
+        }
+    }
+
+    /* number = digits * 10^(kappa - k), %g strips trailing zeros */
+    exponent = kappa - power->k;
+    while ((digit_count > 1) && (digits[digit_count - 1] == '0'))
+    {
+        digit_count--;
+        exponent++;
+    }
+    /* from here on exponent is the one of the first digit */
+    exponent += (int)digit_count - 1;
+    precision = (digit_count <= 15) ? 15 : (int)digit_count;
+
+    if (number < 0)
+    {
+        *output_pointer++ = '-';
+    }
+
+    if ((exponent < -4) || (exponent >= precision))
+    {
+        *output_pointer++ = digits[0];
+        if (digit_count > 1)
+        {
+            *output_pointer++ = '.';
+            memcpy(output_pointer, digits + 1, digit_count - 1);
+            output_pointer += digit_count - 1;
+        }
+        *output_pointer++ = 'e';
+        *output_pointer++ = (exponent < 0) ? '-' : '+';
+        if (exponent < 0)
+        {
+            exponent = -exponent;
+        }
+        if (exponent >= 100)
+        {
+            *output_pointer++ = (unsigned char)('0' + (exponent / 100));
+            exponent %= 100;
+        }
+        *output_pointer++ = (unsigned char)digit_pairs[exponent * 2];
+        *output_pointer++ = (unsigned char)digit_pairs[(exponent * 2) + 1];
+    }
+    else if (exponent < 0)
+    {
+        *output_pointer++ = '0';
+        *output_pointer++ = '.';
+        for (i = 1; i < (size_t)-exponent; i++)
+        {
+            *output_pointer++ = '0';
+        }
+        memcpy(output_pointer, digits, digit_count);
+        output_pointer += digit_count;
+    }
+    else
+    {
+        for (i = 0; (i < digit_count) || (i <= (size_t)exponent); i++)
+        {
+            if (i == ((size_t)exponent + 1))
+            {
+                *output_pointer++ = '.';
+            }
+            *output_pointer++ = (i < digit_count) ? digits[i] : '0';
+        }
+    }
+
+    return (size_t)(output_pointer - output);
+}
+
+/* Render the number nicely from the given item into a string. */
+/* Render the number of item into output, which needs room for NUMBER_TEXT_SIZE characters.
+ * Returns the length, the text isn't null terminated. 0 means failure. */
+static size_t print_number_text(const cJSON* const item, unsigned char* const output)
+{
+    double d = item->valuedouble;
+    int length = 0;
+    size_t i = 0;
+    unsigned char number_buffer[NUMBER_TEXT_SIZE] = { 0 }; /* temporary buffer to print the number into */
+    unsigned char decimal_point = '.';
+    double test = 0.0;
+
+    /* This checks for NaN and Infinity */
+    if (isnan(d) || isinf(d))
+    {
+        memcpy(output, "null", static_strlen("null"));
+        return static_strlen("null");
+    }
+    else if (d == (double)item->valueint)
+    {
+        return print_integer(item->valueint, output);
+    }
+
+    length = (int)print_shortest_double(d, output);
+    if (length == 0)
+    {
+        /* Grisu3 couldn't decide, find the shortest precision that round trips with sprintf */
+        decimal_point = get_decimal_point();
+        length = sprintf((char*)number_buffer, "%1.15g", d);
+        if ((sscanf((char*)number_buffer, "%lg", &test) != 1) || (test != d))
+        {
+            length = sprintf((char*)number_buffer, "%1.16g", d);
+            if ((sscanf((char*)number_buffer, "%lg", &test) != 1) || (test != d))
+            {
+                length = sprintf((char*)number_buffer, "%1.17g", d);
+            }
+        }
+
+        /* sprintf failed or buffer overrun occurred */
+        if ((length <= 0) || (length > (int)(sizeof(number_buffer) - 1)))
+        {
+            return 0;
+        }
+
+        /* copy the printed number to the output and replace locale
+         * dependent decimal point with '.' */
+        for (i = 0; i < ((size_t)length); i++)
+        {
+            if (number_buffer[i] == decimal_point)
+            {
+                output[i] = '.';
+                continue;
+            }
+
+            output[i] = number_buffer[i];
+        }
+    }
+
+    return (size_t)length;
+}
+
+static cJSON_bool print_number(const cJSON* const item, printbuffer* const output_buffer)
+{
+    unsigned char number[NUMBER_TEXT_SIZE];
+    unsigned char* output_pointer = NULL;
+    size_t length = 0;
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    if ((output_buffer->offset + NUMBER_TEXT_SIZE) < output_buffer->length)
+    {
+        /* there is room, print in place */
+        output_pointer = output_buffer->buffer + output_buffer->offset;
+        length = print_number_text(item, output_pointer);
+        if (length == 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        /* print aside, so a buffer that can't grow only needs room for the actual length */
+        length = print_number_text(item, number);
+        if (length == 0)
+        {
+            return false;
+        }
+        output_pointer = ensure(output_buffer, length + 1);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        memcpy(output_pointer, number, length);
+    }
+    output_pointer[length] = '\0';
+
+    output_buffer->offset += length;
+
+    return true;
+}
+
+/* parse 4 digit hexadecimal number */
+static unsigned parse_hex4(const unsigned char* const input)
+{
+    unsigned int h = 0;
+    size_t i = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        /* parse digit */
+        if ((input[i] >= '0') && (input[i] <= '9'))
+        {
+            h += (unsigned int)input[i] - '0';
+        }
+        else if ((input[i] >= 'A') && (input[i] <= 'F'))
+        {
+            h += (unsigned int)10 + input[i] - 'A';
+        }
+        else if ((input[i] >= 'a') && (input[i] <= 'f'))
+        {
+            h += (unsigned int)10 + input[i] - 'a';
+        }
+        else /* invalid */
+        {
+            return 0;
+        }
+
+        if (i < 3)
+        {
+            /* shift left to make place for the next nibble */
+            h = h << 4;
+        }
+    }
+
+    return h;
+}
+
+/* converts a UTF-16 literal to UTF-8
+ * A literal can be one or two sequences of the form \uXXXX */
+static unsigned char utf16_literal_to_utf8(const unsigned char* const input_pointer, const unsigned char* const input_end, unsigned char** output_pointer)
+{
+    long unsigned int codepoint = 0;
+    unsigned int first_code = 0;
+    const unsigned char* first_sequence = input_pointer;
+    unsigned char utf8_length = 0;
+    unsigned char utf8_position = 0;
+    unsigned char sequence_length = 0;
+    unsigned char first_byte_mark = 0;
+
+    if ((input_end - first_sequence) < 6)
+    {
+        /* input ends unexpectedly */
+        goto fail;
+    }
+
+    /* get the first utf16 sequence */
+    first_code = parse_hex4(first_sequence + 2);
+
+    /* check that the code is valid */
+    if (((first_code >= 0xDC00) && (first_code <= 0xDFFF)))
+    {
+        goto fail;
+    }
+
+    /* UTF16 surrogate pair */
+    if ((first_code >= 0xD800) && (first_code <= 0xDBFF))
+    {
+        const unsigned char* second_sequence = first_sequence + 6;
+        unsigned int second_code = 0;
+        sequence_length = 12; /* \uXXXX\uXXXX */
+
+        if ((input_end - second_sequence) < 6)
+        {
+            /* input ends unexpectedly */
+            goto fail;
+        }
+
+        if ((second_sequence[0] != '\\') || (second_sequence[1] != 'u'))
+        {
+            /* missing second half of the surrogate pair */
+            goto fail;
+        }
+
+        /* get the second utf16 sequence */
+        second_code = parse_hex4(second_sequence + 2);
+        /* check that the code is valid */
+        if ((second_code < 0xDC00) || (second_code > 0xDFFF))
+        {
+            /* invalid second half of the surrogate pair */
+            goto fail;
+        }
+
+
+        /* calculate the unicode codepoint from the surrogate pair */
+        codepoint = 0x10000 + (((first_code & 0x3FF) << 10) | (second_code & 0x3FF));
+    }
+    else
+    {
+        sequence_length = 6; /* \uXXXX */
+        codepoint = first_code;
+    }
+
+    /* encode as UTF-8
+     * takes at maximum 4 bytes to encode:
+     * 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx */
+    if (codepoint < 0x80)
+    {
+        /* normal ascii, encoding 0xxxxxxx */
+        utf8_length = 1;
+    }
+    else if (codepoint < 0x800)
+    {
+        /* two bytes, encoding 110xxxxx 10xxxxxx */
+        utf8_length = 2;
+        first_byte_mark = 0xC0; /* 11000000 */
+    }
+    else if (codepoint < 0x10000)
+    {
+        /* three bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx */
+        utf8_length = 3;
+        first_byte_mark = 0xE0; /* 11100000 */
+    }
+    else if (codepoint <= 0x10FFFF)
+    {
+        /* four bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx 10xxxxxx */
+        utf8_length = 4;
+        first_byte_mark = 0xF0; /* 11110000 */
+    }
+    else
+    {
+        /* invalid unicode codepoint */
+        goto fail;
+    }
+
+    /* encode as utf8 */
+    for (utf8_position = (unsigned char)(utf8_length - 1); utf8_position > 0; utf8_position--)
+    {
+        /* 10xxxxxx */
+        (*output_pointer)[utf8_position] = (unsigned char)((codepoint | 0x80) & 0xBF);
+        codepoint >>= 6;
+    }
+    /* encode first byte */
+    if (utf8_length > 1)
+    {
+        (*output_pointer)[0] = (unsigned char)((codepoint | first_byte_mark) & 0xFF);
+    }
+    else
+    {
+        (*output_pointer)[0] = (unsigned char)(codepoint & 0x7F);
+    }
+
+    *output_pointer += utf8_length;
+
+    return sequence_length;
+
+fail:
+    return 0;
+}
+
+/* Parse the input text into an unescaped cinput, and populate item. */
+static cJSON_bool parse_string(cJSON* const item, parse_buffer* const input_buffer)
+{
+    const unsigned char* input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char* input_end = buffer_at_offset(input_buffer) + 1;
+    const unsigned char* const content_end = input_buffer->content + input_buffer->length;
+    const scan_kernels* const kernels = get_scan_kernels();
+    unsigned char* output_pointer = NULL;
+    unsigned char* output = NULL;
+
+    /* not a string */
+    if (buffer_at_offset(input_buffer)[0] != '\"')
+    {
+        set_error_reason(input_buffer, "expected a string");
+        goto fail;
+    }
+
+    {
+        /* calculate approximate size of the output (overestimate) */
+        size_t allocation_length = 0;
+        size_t skipped_bytes = 0;
+        for (;;)
+        {
+            /* jump to the next quote or escape sequence */
+            input_end += kernels->find_quote_or_backslash(input_end, (size_t)(content_end - input_end));
+            if ((input_end >= content_end) || (*input_end == '\"'))
+            {
+                break;
+            }
+
+            if ((input_end + 1) >= content_end)
+            {
+                /* prevent buffer overflow when last input character is a backslash */
+                set_error_reason(input_buffer, "unterminated string");
+                goto fail;
+            }
+            skipped_bytes++;
+            input_end += 2;
+        }
+        if ((input_end >= content_end) || (*input_end != '\"'))
+        {
+            set_error_reason(input_buffer, "unterminated string");
+            goto fail; /* string ended unexpectedly */
+        }
+
+        if (input_buffer->in_situ)
+        {
+            /* decode in place, the output is never longer than the literal and
+             * there is at least the closing quote to put the terminator in */
+            output = (unsigned char*)cast_away_const(input_pointer);
+        }
+        else
+        {
+            /* This is at most how much we need for the output */
+            allocation_length = (size_t)(input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
+            output = (unsigned char*)parse_allocate(input_buffer, allocation_length + sizeof(""));
+            if (output == NULL)
+            {
+                set_error_reason(input_buffer, "out of memory");
+                goto fail; /* allocation failure */
+            }
+        }
+    }
+
+    output_pointer = output;
+    /* loop through the string literal */
+    while (input_pointer < input_end)
+    {
+        /* copy everything up to the next escape sequence in one go,
+         * the only unescaped quote is the one at input_end */
+        size_t run_length = kernels->find_quote_or_backslash(input_pointer, (size_t)(input_end - input_pointer));
+        if (output_pointer != input_pointer)
+        {
+            /* in situ the output trails the input within the same buffer */
+            memmove(output_pointer, input_pointer, run_length);
+        }
+        output_pointer += run_length;
+        input_pointer += run_length;
+
+        /* escape sequence */
+        if (input_pointer < input_end)
+        {
+            unsigned char sequence_length = 2;
+            if ((input_end - input_pointer) < 1)
+            {
+                goto fail;
+            }
+
+            switch (input_pointer[1])
+            {
+            case 'b':
+                *output_pointer++ = '\b';
+                break;
+            case 'f':
+                *output_pointer++ = '\f';
+                break;
+            case 'n':
+                *output_pointer++ = '\n';
+                break;
+            case 'r':
+                *output_pointer++ = '\r';
+                break;
+            case 't':
+                *output_pointer++ = '\t';
+                break;
+            case '\"':
+            case '\\':
+            case '/':
+                *output_pointer++ = input_pointer[1];
+                break;
+
+                /* UTF-16 literal */
+            case 'u':
+                sequence_length = utf16_literal_to_utf8(input_pointer, input_end, &output_pointer);
+                if (sequence_length == 0)
+                {
+                    /* failed to convert UTF16-literal to UTF-8 */
+                    set_error_reason(input_buffer, "invalid \\u escape sequence");
+                    goto fail;
+                }
+                break;
+
+            default:
+                set_error_reason(input_buffer, "invalid escape sequence");
+                goto fail;
+            }
+            input_pointer += sequence_length;
+        }
+    }
+
+    /* zero terminate the output */
+    *output_pointer = '\0';
+
+    set_item_type(item, cJSON_String);
+    item->valuestring = (char*)output;
+
+    input_buffer->offset = (size_t)(input_end - input_buffer->content);
+    input_buffer->offset++;
+
+    return true;
+
+fail:
+    if ((output != NULL) && (input_buffer->arena == NULL) && (input_buffer->scratch == NULL) && !input_buffer->in_situ)
+    {
+        hooks_deallocate(&input_buffer->hooks, output);
+        output = NULL;
+    }
+
+    if (input_pointer != NULL)
+    {
+        input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+    }
+
+    return false;
+}
+
+/* Render the cstring provided to an escaped version that can be printed. */
+/* Count how many characters escaping adds to a string. */
+static size_t count_escapes(const unsigned char* const input, size_t length)
+{
+    const scan_kernels* const kernels = get_scan_kernels();
+    size_t escape_characters = 0;
+    size_t offset = kernels->find_escape(input, length);
+
+    while (offset < length)
+    {
+        switch (input[offset])
+        {
+        case '\"':
+        case '\\':
+        case '\b':
+        case '\f':
+        case '\n':
+        case '\r':
+        case '\t':
+            /* one character escape sequence */
+            escape_characters++;
+            break;
+        default:
+            /* UTF-16 escape sequence uXXXX */
+            escape_characters += 5;
+            break;
+        }
+        offset++;
+        offset += kernels->find_escape(input + offset, length - offset);
+    }
+
+    return escape_characters;
+}
+
+static cJSON_bool print_string_ptr(const unsigned char* const input, printbuffer* const output_buffer)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    const scan_kernels* kernels = NULL;
+    unsigned char* output = NULL;
+    unsigned char* output_pointer = NULL;
+    size_t input_length = 0;
+    size_t output_length = 0;
+    size_t offset = 0;
+    size_t run = 0;
+    /* numbers of additional characters needed for escaping */
+    size_t escape_characters = 0;
+
+    if (output_buffer == NULL)
+    {
+        return false;
     }
 
     /* empty string */
     if (input == NULL)
     {
-        output = ensure(output_buffer, sizeof("\"\""));
+        output = ensure(output_buffer, sizeof("\"\""));
+        if (output == NULL)
+        {
+            return false;
+        }
+        strcpy((char*)output, "\"\"");
+        output_buffer->offset += 2;
+
+        return true;
+    }
+
+    input_length = strlen((const char*)input);
+    escape_characters = count_escapes(input, input_length);
+    output_length = input_length + escape_characters;
+
+    output = ensure(output_buffer, output_length + sizeof("\"\""));
+    if (output == NULL)
+    {
+        return false;
+    }
+
+    /* no characters have to be escaped */
+    if (escape_characters == 0)
+    {
+        output[0] = '\"';
+        memcpy(output + 1, input, output_length);
+        output[output_length + 1] = '\"';
+        output[output_length + 2] = '\0';
+        output_buffer->offset += output_length + 2;
+
+        return true;
+    }
+
+    output[0] = '\"';
+    output_pointer = output + 1;
+    /* copy the runs between characters that need escaping in one go */
+    kernels = get_scan_kernels();
+    for (;;)
+    {
+        run = kernels->find_escape(input + offset, input_length - offset);
+        memcpy(output_pointer, input + offset, run);
+        output_pointer += run;
+        offset += run;
+        if (offset == input_length)
+        {
+            break;
+        }
+
+        /* character needs to be escaped */
+        *output_pointer++ = '\\';
+        switch (input[offset])
+        {
+        case '\\':
+            *output_pointer++ = '\\';
+            break;
+        case '\"':
+            *output_pointer++ = '\"';
+            break;
+        case '\b':
+            *output_pointer++ = 'b';
+            break;
+        case '\f':
+            *output_pointer++ = 'f';
+            break;
+        case '\n':
+            *output_pointer++ = 'n';
+            break;
+        case '\r':
+            *output_pointer++ = 'r';
+            break;
+        case '\t':
+            *output_pointer++ = 't';
+            break;
+        default:
+            /* escape and print as unicode codepoint */
+            *output_pointer++ = 'u';
+            *output_pointer++ = '0';
+            *output_pointer++ = '0';
+            *output_pointer++ = (unsigned char)hex_digits[input[offset] >> 4];
+            *output_pointer++ = (unsigned char)hex_digits[input[offset] & 0x0F];
+            break;
+        }
+        offset++;
+    }
+    output[output_length + 1] = '\"';
+    output[output_length + 2] = '\0';
+    output_buffer->offset += output_length + 2;
+
+    return true;
+}
+
+/* Invoke print_string_ptr (which is useful) on an item. */
+static cJSON_bool print_string(const cJSON* const item, printbuffer* const p)
+{
+    return print_string_ptr((unsigned char*)item->valuestring, p);
+}
+
+/* Predeclare these prototypes. */
+static cJSON_bool parse_value(cJSON* const item, parse_buffer* const input_buffer);
+static cJSON_bool print_value(const cJSON* const item, printbuffer* const output_buffer);
+static cJSON_bool parse_array(cJSON* const item, parse_buffer* const input_buffer);
+static cJSON_bool print_array(const cJSON* const item, printbuffer* const output_buffer);
+static cJSON_bool parse_object(cJSON* const item, parse_buffer* const input_buffer);
+static cJSON_bool print_object(const cJSON* const item, printbuffer* const output_buffer);
+static cJSON_bool expand_lazy(const cJSON* const item);
+
+/* Utility to jump whitespace and cr/lf */
+static parse_buffer* buffer_skip_whitespace(parse_buffer* const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL))
+    {
+        return NULL;
+    }
+
+    if (cannot_access_at_index(buffer, 0))
+    {
+        return buffer;
+    }
+
+    /* most tokens aren't preceded by whitespace, don't pay for the kernel call then */
+    if (buffer_at_offset(buffer)[0] <= 32)
+    {
+        buffer->offset += get_scan_kernels()->skip_whitespace(buffer_at_offset(buffer), buffer->length - buffer->offset);
+    }
+
+    if (buffer->offset == buffer->length)
+    {
+        buffer->offset--;
+    }
+
+    return buffer;
+}
+
+/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
+static parse_buffer* skip_utf8_bom(parse_buffer* const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    {
+        return NULL;
+    }
+
+    if (can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    {
+        buffer->offset += 3;
+    }
+
+    return buffer;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_ParseWithOpts(const char* value, const char** return_parse_end, cJSON_bool require_null_terminated)
+{
+    size_t buffer_length;
+
+    if (NULL == value)
+    {
+        return NULL;
+    }
+
+    /* Adding null character size due to require_null_terminated. */
+    buffer_length = strlen(value) + sizeof("");
+
+    return cJSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+}
+
+/* Parse a complete document into item, the buffer has to be set up by the caller. */
+static cJSON_bool parse_document(cJSON* const item, parse_buffer* const buffer, const char** return_parse_end, cJSON_bool require_null_terminated)
+{
+    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(buffer))))
+    {
+        /* parse failure. ep is set. */
+        return false;
+    }
+
+    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
+    if (require_null_terminated)
+    {
+        buffer_skip_whitespace(buffer);
+        if ((buffer->offset >= buffer->length) || buffer_at_offset(buffer)[0] != '\0')
+        {
+            set_error_reason(buffer, "unexpected data after the document");
+            return false;
+        }
+    }
+    if (return_parse_end)
+    {
+        *return_parse_end = (const char*)buffer_at_offset(buffer);
+    }
+
+    return true;
+}
+
+/* where parsing failed, clamped to the input */
+static size_t get_error_position(const parse_buffer* const buffer)
+{
+    if (buffer->offset < buffer->length)
+    {
+        return buffer->offset;
+    }
+    if (buffer->length > 0)
+    {
+        return buffer->length - 1;
+    }
+
+    return 0;
+}
+
+/* remember where parsing value failed, for cJSON_GetErrorPtr and return_parse_end */
+static void set_parse_error(const char* value, const parse_buffer* const buffer, const char** return_parse_end)
+{
+    error local_error;
+    local_error.json = (const unsigned char*)value;
+    local_error.position = get_error_position(buffer);
+
+    if (return_parse_end != NULL)
+    {
+        *return_parse_end = (const char*)local_error.json + local_error.position;
+    }
+
+    global_error = local_error;
+}
+
+/* allocate the root item for the document in buffer, before anything of it is parsed */
+static cJSON* parse_new_root(const parse_buffer* const buffer)
+{
+    size_t start = buffer->offset;
+
+    /* as skip_utf8_bom does */
+    if ((start == 0) && can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    {
+        start = 3;
+    }
+
+    return container_follows(buffer, start) ? new_container_item(&buffer->hooks) : cJSON_New_Item(&buffer->hooks);
+}
+
+/* fill in a structured error, line and column are counted up to the error position */
+static void describe_parse_error(const char* value, const size_t position, const char* const reason, cJSON_ParseError* const parse_error)
+{
+    const char* line_start = value;
+    const char* newline = NULL;
+
+    parse_error->offset = position;
+    parse_error->line = 1;
+    parse_error->reason = (reason != NULL) ? reason : "invalid JSON";
+
+    while ((value != NULL) && ((newline = (const char*)memchr(line_start, '\n', position - (size_t)(line_start - value))) != NULL))
+    {
+        parse_error->line++;
+        line_start = newline + 1;
+    }
+    parse_error->column = position - (size_t)(line_start - value) + 1;
+}
+
+/* Parse a document into a new root item allocated with the hooks of buffer, the reason of a failure is left in buffer. */
+static cJSON* parse_root(parse_buffer* const buffer, const char* value, size_t buffer_length, const char** return_parse_end, cJSON_bool require_null_terminated)
+{
+    cJSON* item = NULL;
+
+    if (value == NULL || 0 == buffer_length)
+    {
+        set_error_reason(buffer, "no input");
+        return NULL;
+    }
+
+    buffer->content = (const unsigned char*)value;
+    buffer->length = buffer_length;
+    buffer->offset = 0;
+
+    item = parse_new_root(buffer);
+    if (item == NULL) /* memory fail */
+    {
+        set_error_reason(buffer, "out of memory");
+        return NULL;
+    }
+
+    if (!parse_document(item, buffer, return_parse_end, require_null_terminated))
+    {
+        cJSON_Delete(item);
+        return NULL;
+    }
+
+    return item;
+}
+
+/* Parse an object - create a new root, and populate. */
+CJSON_PUBLIC(cJSON*) cJSON_ParseWithLengthOpts(const char* value, size_t buffer_length, const char** return_parse_end, cJSON_bool require_null_terminated)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    cJSON* item = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    buffer.hooks = global_hooks;
+    item = parse_root(&buffer, value, buffer_length, return_parse_end, require_null_terminated);
+    if ((item == NULL) && (value != NULL))
+    {
+        set_parse_error(value, &buffer, return_parse_end);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_ParseWithAllocator(const char* value, size_t buffer_length, const cJSON_Allocator* allocator)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    cJSON* item = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    buffer.hooks = allocator_hooks(allocator);
+    item = parse_root(&buffer, value, buffer_length, NULL, false);
+    if ((item == NULL) && (value != NULL))
+    {
+        set_parse_error(value, &buffer, NULL);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_ParseEx(const char* value, size_t buffer_length, const char** return_parse_end, cJSON_bool require_null_terminated, cJSON_ParseError* parse_error)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    cJSON* item = NULL;
+
+    buffer.hooks = global_hooks;
+    item = parse_root(&buffer, value, buffer_length, return_parse_end, require_null_terminated);
+
+    if (parse_error != NULL)
+    {
+        if (item != NULL)
+        {
+            memset(parse_error, '\0', sizeof(cJSON_ParseError));
+        }
+        else
+        {
+            describe_parse_error(value, get_error_position(&buffer), buffer.error_reason, parse_error);
+        }
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_ParseWithArena(const char* value, size_t buffer_length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    arena_document* document = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (value == NULL || 0 == buffer_length)
+    {
+        goto fail;
+    }
+
+    document = (arena_document*)global_hooks.allocate(sizeof(arena_document));
+    if (document == NULL)
+    {
+        goto fail;
+    }
+    memset(document, '\0', sizeof(arena_document));
+    document->arena.hooks = global_hooks;
+    /* items and strings of a document usually take more memory than its text */
+    document->arena.next_chunk_size = buffer_length;
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+    buffer.arena = &document->arena;
+
+    if (!parse_document(&document->root, &buffer, NULL, false))
+    {
+        goto fail;
+    }
+    document->root.type |= cJSON_InArena | cJSON_ArenaRoot;
+
+    return &document->root;
+
+fail:
+    if (document != NULL)
+    {
+        free_arena_document(&document->root);
+    }
+
+    if (value != NULL)
+    {
+        set_parse_error(value, &buffer, NULL);
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_ParseInSitu(char* value, size_t buffer_length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    cJSON* item = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (value == NULL || 0 == buffer_length)
+    {
+        goto fail;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+    buffer.in_situ = true;
+
+    item = parse_new_root(&buffer);
+    if (item == NULL) /* memory fail */
+    {
+        goto fail;
+    }
+
+    if (!parse_document(item, &buffer, NULL, false))
+    {
+        goto fail;
+    }
+    finish_parsed_item(item, &buffer);
+
+    return item;
+
+fail:
+    if (item != NULL)
+    {
+        cJSON_Delete(item);
+    }
+
+    if (value != NULL)
+    {
+        set_parse_error(value, &buffer, NULL);
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(void) cJSON_ArenaFree(cJSON* item)
+{
+    if ((item != NULL) && ((item->type & (cJSON_InArena | cJSON_ArenaRoot)) == (cJSON_InArena | cJSON_ArenaRoot)))
+    {
+        free_arena_document(item);
+    }
+}
+
+CJSON_PUBLIC(cJSON_KeyTable*) cJSON_KeyTableNew(void)
+{
+    cJSON_KeyTable* table = (cJSON_KeyTable*)global_hooks.allocate(sizeof(cJSON_KeyTable));
+
+    if (table != NULL)
+    {
+        memset(table, '\0', sizeof(cJSON_KeyTable));
+        table->storage.hooks = global_hooks;
+        table->scratch.hooks = global_hooks;
+    }
+
+    return table;
+}
+
+CJSON_PUBLIC(void) cJSON_KeyTableDelete(cJSON_KeyTable* table)
+{
+    arena_chunk* chunk = NULL;
+
+    if (table == NULL)
+    {
+        return;
+    }
+
+    chunk = table->storage.chunks;
+    while (chunk != NULL)
+    {
+        arena_chunk* next = chunk->next;
+        table->storage.hooks.deallocate(chunk);
+        chunk = next;
+    }
+    if (table->slots != NULL)
+    {
+        table->storage.hooks.deallocate(table->slots);
+    }
+    if (table->scratch.buffer != NULL)
+    {
+        table->scratch.hooks.deallocate(table->scratch.buffer);
+    }
+    table->storage.hooks.deallocate(table);
+}
+
+CJSON_PUBLIC(const char*) cJSON_KeyTableIntern(cJSON_KeyTable* table, const char* key)
+{
+    if ((table == NULL) || (key == NULL))
+    {
+        return NULL;
+    }
+
+    return key_table_intern(table, key);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_ParseWithKeyTable(const char* value, size_t buffer_length, cJSON_KeyTable* table)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    cJSON* item = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    buffer.hooks = global_hooks;
+    buffer.keys = table;
+    item = parse_root(&buffer, value, buffer_length, NULL, false);
+    if ((item == NULL) && (value != NULL))
+    {
+        set_parse_error(value, &buffer, NULL);
+    }
+
+    return item;
+}
+
+/* Lazy documents.
+ * cJSON_ParseLazy only finds the matching brackets of every array and object (using classify_block on 64 byte blocks)
+ * and keeps a pointer to the text. An array or object is parsed by parse_array/parse_object the first time its children
+ * are needed; the arrays and objects nested in it become lazy items themselves, while everything else (keys, strings,
+ * numbers) is parsed right away, so the fields of the items can be read directly as usual. */
+
+/* bits of the bytes that follow an odd number of backslashes in a block, next_escaped carries the escape of the first
+ * byte of the next block. Backslashes at odd positions are made to start their run by adding the run to them. */
+static uint64_t escaped_bytes(const uint64_t backslash, uint64_t* const next_escaped)
+{
+    const uint64_t odd_bits = UINT64_C(0xAAAAAAAAAAAAAAAA);
+    uint64_t potential_escape = backslash & ~*next_escaped;
+    uint64_t escape_and_terminal = (((potential_escape << 1) | odd_bits) - potential_escape) ^ odd_bits;
+    uint64_t escaped = escape_and_terminal ^ (backslash | *next_escaped);
+
+    *next_escaped = (escape_and_terminal & backslash) >> 63;
+
+    return escaped;
+}
+
+/* bit i is the parity of bits 0 ... i */
+static uint64_t prefix_xor(uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+
+    return bits;
+}
+
+/* find the spans of the array or object at the offset of buffer, offsets are relative to it.
+ * On success the offset of buffer is behind its closing bracket, on failure at the error. */
+static cJSON_bool lazy_find_spans(lazy_document* const document, parse_buffer* const buffer)
+{
+    const scan_kernels* kernels = get_scan_kernels();
+    const unsigned char* content = buffer->content;
+    const size_t start = buffer->offset;
+    size_t* stack = NULL;
+    size_t depth = 0;
+    size_t stack_size = 0;
+    size_t span_capacity = 0;
+    size_t position = 0;
+    uint64_t next_escaped = 0;
+    uint64_t in_string = 0; /* all ones if the block starts inside of a string */
+    unsigned char tail[SCAN_BLOCK_SIZE];
+
+    for (position = start; position < buffer->length; position += SCAN_BLOCK_SIZE)
+    {
+        const unsigned char* block = content + position;
+        block_classes classes;
+        uint64_t string_bits = 0;
+        uint64_t brackets = 0;
+
+        if ((buffer->length - position) < SCAN_BLOCK_SIZE)
+        {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, block, buffer->length - position);
+            block = tail;
+        }
+        kernels->classify_block(block, &classes);
+
+        /* the bytes from an opening quote up to the closing one */
+        string_bits = prefix_xor(classes.quote & ~escaped_bytes(classes.backslash, &next_escaped)) ^ in_string;
+        in_string = (uint64_t)0 - (string_bits >> 63);
+
+        for (brackets = classes.bracket & ~string_bits; brackets != 0; brackets &= brackets - 1)
+        {
+            unsigned char character = block[count_trailing_zeros(brackets)];
+            buffer->offset = position + count_trailing_zeros(brackets);
+
+            if ((character == '[') || (character == '{'))
+            {
+                if (depth >= CJSON_NESTING_LIMIT)
+                {
+                    set_error_reason(buffer, "nesting too deep");
+                    goto fail;
+                }
+                if (depth == stack_size)
+                {
+                    size_t new_size = (stack_size > 0) ? (stack_size * 2) : 64;
+                    size_t* new_stack = (size_t*)resize_array(&buffer->hooks, stack, sizeof(size_t), depth, new_size);
+                    if (new_stack == NULL)
+                    {
+                        set_error_reason(buffer, "out of memory");
+                        goto fail;
+                    }
+                    stack = new_stack;
+                    stack_size = new_size;
+                }
+                if (document->span_count == span_capacity)
+                {
+                    size_t new_capacity = (span_capacity > 0) ? (span_capacity * 2) : (((buffer->length - start) / 64) + 16);
+                    lazy_span* spans = (lazy_span*)resize_array(&buffer->hooks, document->spans, sizeof(lazy_span), document->span_count, new_capacity);
+                    if (spans == NULL)
+                    {
+                        set_error_reason(buffer, "out of memory");
+                        goto fail;
+                    }
+                    document->spans = spans;
+                    span_capacity = new_capacity;
+                }
+                document->spans[document->span_count].open = buffer->offset - start;
+                stack[depth++] = document->span_count++;
+            }
+            else
+            {
+                lazy_span* span = &document->spans[stack[depth - 1]];
+                if (content[start + span->open] != ((character == ']') ? '[' : '{'))
+                {
+                    set_error_reason(buffer, (content[start + span->open] == '[') ? "expected ',' or ']'" : "expected ',' or '}'");
+                    goto fail;
+                }
+                span->close = buffer->offset - start;
+                span->next = document->span_count;
+                depth--;
+                if (depth == 0)
+                {
+                    buffer->offset++;
+                    hooks_deallocate(&buffer->hooks, stack);
+                    return true;
+                }
+            }
+        }
+    }
+
+    buffer->offset = buffer->length - 1;
+    set_error_reason(buffer, (in_string != 0) ? "unterminated string" : "unexpected end of input");
+
+fail:
+    if (stack != NULL)
+    {
+        hooks_deallocate(&buffer->hooks, stack);
+    }
+
+    return false;
+}
+
+/* parse the children of a lazy array or object, fails if there isn't enough memory or its text is invalid */
+static cJSON_bool parse_lazy_container(cJSON* const container)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    const lazy_document* document = NULL;
+    size_t span = 0;
+    int flags = 0;
+    cJSON_bool success = false;
+
+    document = (const lazy_document*)container->valuestring;
+    span = (size_t)container->valuedouble;
+    /* the ones that parse_array/parse_object don't know about, except those that describe the lazy state */
+    flags = container->type & ~(0xFF | cJSON_IsReference | cJSON_Lazy | cJSON_Shared);
+
+    buffer.content = document->text;
+    buffer.length = document->length;
+    buffer.offset = document->spans[span].open;
+    buffer.hooks = document->hooks;
+    buffer.lazy = (lazy_document*)cast_away_const(document);
+    buffer.next_span = span + 1;
+
+    container->valuestring = NULL;
+    container->valuedouble = 0;
+    success = ((container->type & 0xFF) == cJSON_Array) ? parse_array(container, &buffer) : parse_object(container, &buffer);
+    if (!success)
+    {
+        /* stay lazy, the next access fails the same way */
+        container->valuestring = (char*)cast_away_const(document);
+        container->valuedouble = (double)span;
+        return false;
+    }
+    container->type |= flags;
+
+    return true;
+}
+
+/* every lookup passes through here, so items that aren't lazy must not pay for setting up a parse */
+static cJSON_bool expand_lazy(const cJSON* const item)
+{
+    if ((item == NULL) || !(item->type & cJSON_Lazy))
+    {
+        return true;
+    }
+
+    return parse_lazy_container((cJSON*)cast_away_const(item));
+}
+
+/* expand item and everything in it, so it doesn't depend on its document anymore */
+static cJSON_bool expand_lazy_tree(cJSON* const item)
+{
+    cJSON* child = NULL;
+
+    if (!expand_lazy(item))
+    {
+        return false;
+    }
+    for (child = item->child; child != NULL; child = child->next)
+    {
+        if ((child->type & (cJSON_Array | cJSON_Object)) && !expand_lazy_tree(child))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_ParseLazy(const char* value, size_t buffer_length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    lazy_document* document = NULL;
+    size_t start = 0;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (value == NULL || 0 == buffer_length)
+    {
+        goto fail;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    buffer_skip_whitespace(skip_utf8_bom(&buffer));
+    if (cannot_access_at_index(&buffer, 0) || ((buffer_at_offset(&buffer)[0] != '[') && (buffer_at_offset(&buffer)[0] != '{')))
+    {
+        /* only arrays and objects are worth deferring */
+        return cJSON_ParseWithLength(value, buffer_length);
+    }
+    start = buffer.offset;
+
+    document = (lazy_document*)global_hooks.allocate(sizeof(lazy_document));
+    if (document == NULL)
+    {
+        goto fail;
+    }
+    memset(document, '\0', sizeof(lazy_document));
+    document->hooks = global_hooks;
+
+    if (!lazy_find_spans(document, &buffer))
+    {
+        goto fail;
+    }
+
+    document->text = (const unsigned char*)value + start;
+    document->length = buffer.offset - start;
+
+    set_item_type(&document->root.item, ((value[start] == '[') ? cJSON_Array : cJSON_Object) | cJSON_IsReference | cJSON_Lazy | cJSON_LazyRoot);
+    if (CJSON_INDEX_THRESHOLD > 0)
+    {
+        document->root.item.type |= cJSON_Indexable;
+    }
+    document->root.item.valuestring = (char*)document;
+    document->root.item.valuedouble = 0;
+
+    return &document->root.item;
+
+fail:
+    if (document != NULL)
+    {
+        free_lazy_document(&document->root.item);
+    }
+
+    if (value != NULL)
+    {
+        set_parse_error(value, &buffer, NULL);
+    }
+
+    return NULL;
+}
+
+/* Parallel parsing.
+ * cJSON_ParseParallel matches the brackets of the whole document like cJSON_ParseLazy. The arrays and objects that are
+ * larger than a share of the work are then parsed on the calling thread, which leaves the arrays and objects nested in
+ * them lazy. Those lazy items are the units of work: each one is a separate subtree that is already linked into its
+ * parent, so the threads expand their units completely and nothing has to be stitched together afterwards. Units are
+ * handed out largest first to the thread with the least work so far, measuring work by the length of the text. */
+
+/* below this, starting threads costs more than it saves */
+#define PARALLEL_MIN_LENGTH ((size_t)1 << 20)
+/* units per thread to aim for, more of them balance the threads better */
+#define PARALLEL_UNITS_PER_THREAD 16
+#define PARALLEL_MAX_THREADS 64
+
+typedef struct
+{
+    cJSON* item; /* a lazy array or object */
+    size_t size; /* of its text */
+    size_t thread; /* that expands it */
+} parallel_unit;
+
+typedef struct
+{
+    parallel_unit* units;
+    size_t unit_count;
+    size_t thread;
+    cJSON_bool success;
+} parallel_worker;
+
+static cJSON_bool append_parallel_unit(const internal_hooks* const hooks, parallel_unit** const units, size_t* const count, size_t* const capacity, cJSON* const item)
+{
+    const lazy_document* document = (const lazy_document*)item->valuestring;
+    const lazy_span* span = &document->spans[(size_t)item->valuedouble];
+
+    if (*count == *capacity)
+    {
+        size_t new_capacity = (*capacity > 0) ? (*capacity * 2) : 64;
+        parallel_unit* new_units = (parallel_unit*)resize_array(hooks, *units, sizeof(parallel_unit), *count, new_capacity);
+        if (new_units == NULL)
+        {
+            return false;
+        }
+        *units = new_units;
+        *capacity = new_capacity;
+    }
+
+    (*units)[*count].item = item;
+    (*units)[*count].size = span->close - span->open + 1;
+    (*units)[*count].thread = 0;
+    (*count)++;
+
+    return true;
+}
+
+/* expand the arrays and objects of root that are larger than grain, and collect the lazy items left in them as units */
+static cJSON_bool split_parallel_work(cJSON* const root, const size_t grain, const internal_hooks* const hooks, parallel_unit** const units, size_t* const unit_count)
+{
+    parallel_unit* pending = NULL;
+    size_t pending_count = 0;
+    size_t pending_capacity = 0;
+    size_t unit_capacity = 0;
+    cJSON* child = NULL;
+
+    if (!append_parallel_unit(hooks, &pending, &pending_count, &pending_capacity, root))
+    {
+        goto fail;
+    }
+
+    while (pending_count > 0)
+    {
+        parallel_unit unit = pending[--pending_count];
+
+        if (unit.size <= grain)
+        {
+            if (!append_parallel_unit(hooks, units, unit_count, &unit_capacity, unit.item))
+            {
+                goto fail;
+            }
+            continue;
+        }
+
+        if (!expand_lazy(unit.item))
+        {
+            goto fail;
+        }
+        for (child = unit.item->child; child != NULL; child = child->next)
+        {
+            if ((child->type & cJSON_Lazy) && !append_parallel_unit(hooks, &pending, &pending_count, &pending_capacity, child))
+            {
+                goto fail;
+            }
+        }
+    }
+
+    if (pending != NULL)
+    {
+        hooks_deallocate(hooks, pending);
+    }
+
+    return true;
+
+fail:
+    if (pending != NULL)
+    {
+        hooks_deallocate(hooks, pending);
+    }
+
+    return false;
+}
+
+/* largest first */
+static int compare_parallel_units(const void* a, const void* b)
+{
+    size_t size_a = ((const parallel_unit*)a)->size;
+    size_t size_b = ((const parallel_unit*)b)->size;
+
+    return (size_a < size_b) ? 1 : ((size_a > size_b) ? -1 : 0);
+}
+
+static void run_parallel_worker(parallel_worker* const worker)
+{
+    size_t i = 0;
+
+    for (i = 0; i < worker->unit_count; i++)
+    {
+        if ((worker->units[i].thread == worker->thread) && !expand_lazy_tree(worker->units[i].item))
+        {
+            worker->success = false;
+            return;
+        }
+    }
+}
+
+#if defined(CJSON_THREADS_POSIX)
+static void* parallel_thread(void* worker)
+{
+    run_parallel_worker((parallel_worker*)worker);
+
+    return NULL;
+}
+#elif defined(CJSON_THREADS_WIN32)
+static DWORD WINAPI parallel_thread(LPVOID worker)
+{
+    run_parallel_worker((parallel_worker*)worker);
+
+    return 0;
+}
+#endif
+
+static size_t processor_count(void)
+{
+#if defined(CJSON_THREADS_POSIX) && defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (count > 0) ? (size_t)count : 1;
+#elif defined(CJSON_THREADS_WIN32)
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+    return 1;
+#endif
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_ParseParallel(const char* value, size_t buffer_length, int thread_count)
+{
+    parallel_worker workers[PARALLEL_MAX_THREADS];
+    size_t loads[PARALLEL_MAX_THREADS];
+#if defined(CJSON_THREADS_POSIX)
+    pthread_t threads[PARALLEL_MAX_THREADS];
+#elif defined(CJSON_THREADS_WIN32)
+    HANDLE threads[PARALLEL_MAX_THREADS];
+#endif
+    cJSON_bool started[PARALLEL_MAX_THREADS];
+    internal_hooks hooks;
+    parallel_unit* units = NULL;
+    size_t unit_count = 0;
+    size_t thread_total = 0;
+    size_t i = 0;
+    size_t t = 0;
+    cJSON* root = NULL;
+    cJSON* item = NULL;
+
+    thread_total = (thread_count > 0) ? (size_t)thread_count : processor_count();
+    if (thread_total > PARALLEL_MAX_THREADS)
+    {
+        thread_total = PARALLEL_MAX_THREADS;
+    }
+#if !defined(CJSON_THREADS_POSIX) && !defined(CJSON_THREADS_WIN32)
+    thread_total = 1;
+#endif
+    if ((thread_total < 2) || (value == NULL) || (buffer_length < PARALLEL_MIN_LENGTH))
+    {
+        return cJSON_ParseWithLength(value, buffer_length);
+    }
+
+    root = cJSON_ParseLazy(value, buffer_length);
+    if ((root == NULL) || !(root->type & cJSON_LazyRoot))
+    {
+        /* scalars are parsed already, errors are reported by the sequential parser so they are the same */
+        return (root != NULL) ? root : cJSON_ParseWithLength(value, buffer_length);
+    }
+    hooks = ((lazy_document*)root)->hooks;
+
+    if (!split_parallel_work(root, buffer_length / (thread_total * PARALLEL_UNITS_PER_THREAD), &hooks, &units, &unit_count))
+    {
+        goto fail;
+    }
+
+    if (unit_count > 1)
+    {
+        qsort(units, unit_count, sizeof(parallel_unit), compare_parallel_units);
+    }
+    for (t = 0; t < thread_total; t++)
+    {
+        loads[t] = 0;
+    }
+    for (i = 0; i < unit_count; i++)
+    {
+        size_t lightest = 0;
+        for (t = 1; t < thread_total; t++)
+        {
+            if (loads[t] < loads[lightest])
+            {
+                lightest = t;
+            }
+        }
+        units[i].thread = lightest;
+        loads[lightest] += units[i].size;
+    }
+
+    for (t = 0; t < thread_total; t++)
+    {
+        workers[t].units = units;
+        workers[t].unit_count = unit_count;
+        workers[t].thread = t;
+        workers[t].success = true;
+        started[t] = false;
+    }
+    /* the calling thread is worker 0, workers whose thread can't be started run on it too */
+    for (t = 1; t < thread_total; t++)
+    {
+#if defined(CJSON_THREADS_POSIX)
+        started[t] = (pthread_create(&threads[t], NULL, parallel_thread, &workers[t]) == 0);
+#elif defined(CJSON_THREADS_WIN32)
+        threads[t] = CreateThread(NULL, 0, parallel_thread, &workers[t], 0, NULL);
+        started[t] = (threads[t] != NULL);
+#endif
+    }
+    for (t = 0; t < thread_total; t++)
+    {
+        if (!started[t])
+        {
+            run_parallel_worker(&workers[t]);
+        }
+    }
+    for (t = 1; t < thread_total; t++)
+    {
+        if (started[t])
+        {
+#if defined(CJSON_THREADS_POSIX)
+            pthread_join(threads[t], NULL);
+#elif defined(CJSON_THREADS_WIN32)
+            WaitForSingleObject(threads[t], INFINITE);
+            CloseHandle(threads[t]);
+#endif
+        }
+    }
+    for (t = 0; t < thread_total; t++)
+    {
+        if (!workers[t].success)
+        {
+            goto fail;
+        }
+    }
+
+    /* move the parsed children to an ordinary root, the text and the spans aren't needed anymore */
+    item = new_container_item(&hooks);
+    if (item == NULL)
+    {
+        goto fail;
+    }
+    set_item_type(item, root->type & ~(cJSON_LazyRoot | cJSON_Indexable));
+    item->child = root->child;
+    root->child = NULL;
+    if (item->type & cJSON_Indexable)
+    {
+        /* the index of the root refers to the children, not to the root */
+        ((container_item*)item)->index = item_index(root);
+        ((container_item*)root)->index = NULL;
+    }
+    cJSON_Delete(root);
+    if (units != NULL)
+    {
+        hooks_deallocate(&hooks, units);
+    }
+
+    return item;
+
+fail:
+    cJSON_Delete(root);
+    if (units != NULL)
+    {
+        hooks_deallocate(&hooks, units);
+    }
+
+    return cJSON_ParseWithLength(value, buffer_length);
+}
+
+/* Event parser: the same grammar as parse_value, but instead of building items the values are reported to a handler.
+ * The tokens are read with parse_value, parse_string and parse_number into an item on the stack that never becomes
+ * part of a tree. */
+static cJSON_bool sax_parse_array(parse_buffer* const input_buffer, const cJSON_SAXHandler* const handler, void* const context);
+static cJSON_bool sax_parse_object(parse_buffer* const input_buffer, const cJSON_SAXHandler* const handler, void* const context);
+
+static cJSON_bool sax_parse_value(parse_buffer* const input_buffer, const cJSON_SAXHandler* const handler, void* const context)
+{
+    cJSON token;
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL) || cannot_access_at_index(input_buffer, 0))
+    {
+        return false; /* no input */
+    }
+
+    if (buffer_at_offset(input_buffer)[0] == '[')
+    {
+        return sax_parse_array(input_buffer, handler, context);
+    }
+    if (buffer_at_offset(input_buffer)[0] == '{')
+    {
+        return sax_parse_object(input_buffer, handler, context);
+    }
+
+    memset(&token, '\0', sizeof(token));
+    if (!parse_value(&token, input_buffer))
+    {
+        return false;
+    }
+
+    switch (token.type & 0xFF)
+    {
+    case cJSON_NULL:
+        return (handler->null == NULL) || handler->null(context);
+
+    case cJSON_False:
+    case cJSON_True:
+        return (handler->boolean == NULL) || handler->boolean(context, (token.type & 0xFF) == cJSON_True);
+
+    case cJSON_Number:
+        return (handler->number == NULL) || handler->number(context, token.valuedouble);
+
+    case cJSON_String:
+        return (handler->string == NULL) || handler->string(context, token.valuestring);
+
+    default:
+        return false;
+    }
+}
+
+static cJSON_bool sax_parse_array(parse_buffer* const input_buffer, const cJSON_SAXHandler* const handler, void* const context)
+{
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    if ((handler->start_array != NULL) && !handler->start_array(context))
+    {
+        return false;
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
+    {
+        /* empty array */
+        goto success;
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        return false;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    /* loop through the comma separated array elements */
+    do
+    {
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!sax_parse_value(input_buffer, handler, context))
+        {
+            return false; /* failed to parse value */
+        }
+        buffer_skip_whitespace(input_buffer);
+    } while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
+    {
+        return false; /* expected end of array */
+    }
+
+success:
+    input_buffer->depth--;
+    input_buffer->offset++;
+
+    return (handler->end_array == NULL) || handler->end_array(context);
+}
+
+static cJSON_bool sax_parse_object(parse_buffer* const input_buffer, const cJSON_SAXHandler* const handler, void* const context)
+{
+    cJSON key;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    if ((handler->start_object != NULL) && !handler->start_object(context))
+    {
+        return false;
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
+    {
+        goto success; /* empty object */
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        return false;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    /* loop through the comma separated array elements */
+    do
+    {
+        if (cannot_access_at_index(input_buffer, 1))
+        {
+            return false; /* nothing comes after the comma */
+        }
+
+        /* parse the name of the child */
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        memset(&key, '\0', sizeof(key));
+        if (!parse_string(&key, input_buffer))
+        {
+            return false; /* failed to parse name */
+        }
+        buffer_skip_whitespace(input_buffer);
+
+        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+        {
+            return false; /* invalid object */
+        }
+        if ((handler->key != NULL) && !handler->key(context, key.valuestring))
+        {
+            return false;
+        }
+
+        /* parse the value */
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!sax_parse_value(input_buffer, handler, context))
+        {
+            return false; /* failed to parse value */
+        }
+        buffer_skip_whitespace(input_buffer);
+    } while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
+    {
+        return false; /* expected end of object */
+    }
+
+success:
+    input_buffer->depth--;
+    input_buffer->offset++;
+
+    return (handler->end_object == NULL) || handler->end_object(context);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ParseSAX(const char* value, size_t buffer_length, const cJSON_SAXHandler* handler, void* context)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    parse_scratch scratch = { NULL, 0, { 0, 0, 0, NULL } };
+    cJSON_bool success = false;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((value != NULL) && (0 != buffer_length) && (handler != NULL))
+    {
+        buffer.content = (const unsigned char*)value;
+        buffer.length = buffer_length;
+        buffer.offset = 0;
+        buffer.hooks = global_hooks;
+        scratch.hooks = global_hooks;
+        buffer.scratch = &scratch;
+
+        success = sax_parse_value(buffer_skip_whitespace(skip_utf8_bom(&buffer)), handler, context);
+
+        if (scratch.buffer != NULL)
+        {
+            scratch.hooks.deallocate(scratch.buffer);
+        }
+    }
+
+    if (!success && (value != NULL))
+    {
+        set_parse_error(value, &buffer, NULL);
+    }
+
+    return success;
+}
+
+/* Tape documents: the nodes of a document in document order, stored as parallel arrays with 32 bit fields instead of
+ * linked cJSON items, which makes about 13 bytes per node. Node 0 is unused, so 0 can mean "no node"; the root is
+ * node 1 and the first child of an array or object always directly follows it. Strings (keys and values) are stored
+ * one after another in a single buffer that starts with an empty string, so a key offset of 0 means "no key".
+ * They are built from the events of the SAX parser. */
+typedef enum
+{
+    tape_null,
+    tape_false,
+    tape_true,
+    tape_integer, /* value holds the number as int32_t */
+    tape_double, /* value is an index into numbers */
+    tape_string, /* value is an offset into strings */
+    tape_array, /* value is the number of children */
+    tape_object
+} tape_type;
+
+#define TAPE_MAX_SIZE ((size_t)0xFFFFFFFFU)
+
+struct cJSON_Tape
+{
+    internal_hooks hooks;
+    unsigned char* types;
+    uint32_t* values;
+    uint32_t* next; /* the following sibling, 0 for the last child */
+    uint32_t* keys; /* offset of the key in strings for object members */
+    size_t count;
+    size_t capacity;
+    double* numbers; /* numbers that aren't 32 bit integers */
+    size_t number_count;
+    size_t number_capacity;
+    char* strings;
+    size_t string_length;
+    size_t string_capacity;
+};
+
+typedef struct
+{
+    cJSON_Tape* tape;
+    /* open arrays and objects and their last child so far, innermost last */
+    uint32_t* open;
+    uint32_t* last;
+    size_t depth;
+    size_t stack_size;
+    uint32_t key; /* key of the member whose value comes next */
+} tape_builder;
+
+/* the arrays are resized one by one, so on failure some of them may already be larger than capacity */
+static cJSON_bool tape_reserve_nodes(cJSON_Tape* const tape, const size_t capacity)
+{
+    unsigned char* types = NULL;
+    uint32_t* values = NULL;
+    uint32_t* next = NULL;
+    uint32_t* keys = NULL;
+
+    types = (unsigned char*)resize_array(&tape->hooks, tape->types, sizeof(unsigned char), tape->count, capacity);
+    if (types == NULL)
+    {
+        return false;
+    }
+    tape->types = types;
+    values = (uint32_t*)resize_array(&tape->hooks, tape->values, sizeof(uint32_t), tape->count, capacity);
+    if (values == NULL)
+    {
+        return false;
+    }
+    tape->values = values;
+    next = (uint32_t*)resize_array(&tape->hooks, tape->next, sizeof(uint32_t), tape->count, capacity);
+    if (next == NULL)
+    {
+        return false;
+    }
+    tape->next = next;
+    keys = (uint32_t*)resize_array(&tape->hooks, tape->keys, sizeof(uint32_t), tape->count, capacity);
+    if (keys == NULL)
+    {
+        return false;
+    }
+    tape->keys = keys;
+    tape->capacity = capacity;
+
+    return true;
+}
+
+/* returns the offset of the copy of string, 0 on failure */
+static uint32_t tape_add_string(cJSON_Tape* const tape, const char* const string)
+{
+    size_t length = strlen(string) + sizeof("");
+    size_t offset = tape->string_length;
+
+    if (length > (TAPE_MAX_SIZE - offset))
+    {
+        return 0;
+    }
+    if ((offset + length) > tape->string_capacity)
+    {
+        size_t new_capacity = tape->string_capacity * 2;
+        char* strings = NULL;
+
+        if (new_capacity < (offset + length))
+        {
+            new_capacity = offset + length;
+        }
+        strings = (char*)resize_array(&tape->hooks, tape->strings, sizeof(char), tape->string_length, new_capacity);
+        if (strings == NULL)
+        {
+            return 0;
+        }
+        tape->strings = strings;
+        tape->string_capacity = new_capacity;
+    }
+
+    memcpy(tape->strings + offset, string, length);
+    tape->string_length += length;
+
+    return (uint32_t)offset;
+}
+
+/* append a node and link it to its parent, returns 0 on failure */
+static uint32_t tape_add_node(tape_builder* const builder, const tape_type type, const uint32_t value)
+{
+    cJSON_Tape* tape = builder->tape;
+    uint32_t node = 0;
+
+    if (tape->count == tape->capacity)
+    {
+        if ((tape->capacity >= TAPE_MAX_SIZE) || !tape_reserve_nodes(tape, (tape->capacity > (TAPE_MAX_SIZE / 2)) ? TAPE_MAX_SIZE : (tape->capacity * 2)))
+        {
+            return 0;
+        }
+    }
+
+    node = (uint32_t)tape->count++;
+    tape->types[node] = (unsigned char)type;
+    tape->values[node] = value;
+    tape->next[node] = 0;
+    tape->keys[node] = builder->key;
+    builder->key = 0;
+
+    if (builder->depth > 0)
+    {
+        tape->values[builder->open[builder->depth - 1]]++;
+        if (builder->last[builder->depth - 1] != 0)
+        {
+            tape->next[builder->last[builder->depth - 1]] = node;
+        }
+        builder->last[builder->depth - 1] = node;
+    }
+
+    return node;
+}
+
+static cJSON_bool tape_open(tape_builder* const builder, const tape_type type)
+{
+    uint32_t node = 0;
+
+    if (builder->depth == builder->stack_size)
+    {
+        size_t new_size = (builder->stack_size > 0) ? (builder->stack_size * 2) : 16;
+        uint32_t* open = NULL;
+        uint32_t* last = NULL;
+
+        open = (uint32_t*)resize_array(&builder->tape->hooks, builder->open, sizeof(uint32_t), builder->depth, new_size);
+        if (open == NULL)
+        {
+            return false;
+        }
+        builder->open = open;
+        last = (uint32_t*)resize_array(&builder->tape->hooks, builder->last, sizeof(uint32_t), builder->depth, new_size);
+        if (last == NULL)
+        {
+            return false;
+        }
+        builder->last = last;
+        builder->stack_size = new_size;
+    }
+
+    node = tape_add_node(builder, type, 0);
+    if (node == 0)
+    {
+        return false;
+    }
+    builder->open[builder->depth] = node;
+    builder->last[builder->depth] = 0;
+    builder->depth++;
+
+    return true;
+}
+
+static cJSON_bool tape_on_start_object(void* context)
+{
+    return tape_open((tape_builder*)context, tape_object);
+}
+
+static cJSON_bool tape_on_start_array(void* context)
+{
+    return tape_open((tape_builder*)context, tape_array);
+}
+
+static cJSON_bool tape_on_end(void* context)
+{
+    ((tape_builder*)context)->depth--;
+    return true;
+}
+
+static cJSON_bool tape_on_key(void* context, const char* key)
+{
+    tape_builder* builder = (tape_builder*)context;
+
+    builder->key = tape_add_string(builder->tape, key);
+    return builder->key != 0;
+}
+
+static cJSON_bool tape_on_string(void* context, const char* string)
+{
+    tape_builder* builder = (tape_builder*)context;
+    uint32_t offset = tape_add_string(builder->tape, string);
+
+    return (offset != 0) && (tape_add_node(builder, tape_string, offset) != 0);
+}
+
+static cJSON_bool tape_on_number(void* context, double number)
+{
+    tape_builder* builder = (tape_builder*)context;
+    cJSON_Tape* tape = builder->tape;
+    static const double zero = 0.0;
+
+    /* small integers are stored in the node itself, but -0 has to stay a double */
+    if ((number >= -2147483648.0) && (number <= 2147483647.0) && (number == (double)(int32_t)number) && ((number != 0.0) || (memcmp(&number, &zero, sizeof(double)) == 0)))
+    {
+        return tape_add_node(builder, tape_integer, (uint32_t)(int32_t)number) != 0;
+    }
+
+    if (tape->number_count == tape->number_capacity)
+    {
+        size_t new_capacity = (tape->number_capacity > 0) ? (tape->number_capacity * 2) : 64;
+        double* numbers = NULL;
+
+        if (new_capacity > TAPE_MAX_SIZE)
+        {
+            new_capacity = TAPE_MAX_SIZE;
+        }
+        if (new_capacity == tape->number_capacity)
+        {
+            return false;
+        }
+        numbers = (double*)resize_array(&tape->hooks, tape->numbers, sizeof(double), tape->number_count, new_capacity);
+        if (numbers == NULL)
+        {
+            return false;
+        }
+        tape->numbers = numbers;
+        tape->number_capacity = new_capacity;
+    }
+    tape->numbers[tape->number_count] = number;
+
+    if (tape_add_node(builder, tape_double, (uint32_t)tape->number_count) == 0)
+    {
+        return false;
+    }
+    tape->number_count++;
+
+    return true;
+}
+
+static cJSON_bool tape_on_boolean(void* context, cJSON_bool boolean)
+{
+    return tape_add_node((tape_builder*)context, boolean ? tape_true : tape_false, 0) != 0;
+}
+
+static cJSON_bool tape_on_null(void* context)
+{
+    return tape_add_node((tape_builder*)context, tape_null, 0) != 0;
+}
+
+/* give the unused part of the arrays back, if the hooks can do that without copying */
+static void tape_shrink(cJSON_Tape* const tape)
+{
+    if (!hooks_can_reallocate(&tape->hooks))
+    {
+        return;
+    }
+
+    if (tape->count < tape->capacity)
+    {
+        tape_reserve_nodes(tape, tape->count);
+    }
+    if ((tape->number_count < tape->number_capacity) && (tape->number_count > 0))
+    {
+        double* numbers = (double*)hooks_reallocate(&tape->hooks, tape->numbers, tape->number_count * sizeof(double));
+        if (numbers != NULL)
+        {
+            tape->numbers = numbers;
+            tape->number_capacity = tape->number_count;
+        }
+    }
+    if (tape->string_length < tape->string_capacity)
+    {
+        char* strings = (char*)hooks_reallocate(&tape->hooks, tape->strings, tape->string_length);
+        if (strings != NULL)
+        {
+            tape->strings = strings;
+            tape->string_capacity = tape->string_length;
+        }
+    }
+}
+
+CJSON_PUBLIC(cJSON_Tape*) cJSON_ParseTape(const char* value, size_t buffer_length)
+{
+    static const cJSON_SAXHandler handler = {
+        tape_on_start_object,
+        tape_on_end,
+        tape_on_start_array,
+        tape_on_end,
+        tape_on_key,
+        tape_on_string,
+        tape_on_number,
+        tape_on_boolean,
+        tape_on_null
+    };
+    tape_builder builder = { NULL, NULL, NULL, 0, 0, 0 };
+    cJSON_Tape* tape = NULL;
+    size_t capacity = 0;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((value == NULL) || (0 == buffer_length))
+    {
+        return NULL;
+    }
+
+    tape = (cJSON_Tape*)global_hooks.allocate(sizeof(cJSON_Tape));
+    if (tape == NULL)
+    {
+        return NULL;
+    }
+    memset(tape, '\0', sizeof(cJSON_Tape));
+    tape->hooks = global_hooks;
+    builder.tape = tape;
+
+    /* a guess that is right for typical documents, too small ones just grow */
+    capacity = (buffer_length / 8) + 16;
+    if (capacity > TAPE_MAX_SIZE)
+    {
+        capacity = TAPE_MAX_SIZE;
+    }
+    tape->string_capacity = (buffer_length / 2) + 16;
+    tape->strings = (char*)hooks_allocate(&tape->hooks, tape->string_capacity);
+    if ((tape->strings == NULL) || !tape_reserve_nodes(tape, capacity))
+    {
+        goto fail;
+    }
+    /* node 0 and the empty string at offset 0 */
+    tape->types[0] = (unsigned char)tape_null;
+    tape->values[0] = 0;
+    tape->next[0] = 0;
+    tape->keys[0] = 0;
+    tape->count = 1;
+    tape->strings[0] = '\0';
+    tape->string_length = 1;
+
+    if (!cJSON_ParseSAX(value, buffer_length, &handler, &builder))
+    {
+        goto fail;
+    }
+    tape_shrink(tape);
+
+    hooks_deallocate(&tape->hooks, builder.open);
+    hooks_deallocate(&tape->hooks, builder.last);
+
+    return tape;
+
+fail:
+    if (builder.open != NULL)
+    {
+        hooks_deallocate(&tape->hooks, builder.open);
+    }
+    if (builder.last != NULL)
+    {
+        hooks_deallocate(&tape->hooks, builder.last);
+    }
+    cJSON_TapeDelete(tape);
+
+    return NULL;
+}
+
+CJSON_PUBLIC(void) cJSON_TapeDelete(cJSON_Tape* tape)
+{
+    if (tape == NULL)
+    {
+        return;
+    }
+
+    if (tape->types != NULL)
+    {
+        hooks_deallocate(&tape->hooks, tape->types);
+    }
+    if (tape->values != NULL)
+    {
+        hooks_deallocate(&tape->hooks, tape->values);
+    }
+    if (tape->next != NULL)
+    {
+        hooks_deallocate(&tape->hooks, tape->next);
+    }
+    if (tape->keys != NULL)
+    {
+        hooks_deallocate(&tape->hooks, tape->keys);
+    }
+    if (tape->numbers != NULL)
+    {
+        hooks_deallocate(&tape->hooks, tape->numbers);
+    }
+    if (tape->strings != NULL)
+    {
+        hooks_deallocate(&tape->hooks, tape->strings);
+    }
+    hooks_deallocate(&tape->hooks, tape);
+}
+
+#define tape_has_node(tape, node) (((tape) != NULL) && ((node) > 0) && ((node) < (tape)->count))
+
+CJSON_PUBLIC(size_t) cJSON_TapeRoot(const cJSON_Tape* tape)
+{
+    return tape_has_node(tape, 1) ? 1 : 0;
+}
+
+CJSON_PUBLIC(int) cJSON_TapeGetType(const cJSON_Tape* tape, size_t node)
+{
+    static const int types[] = { cJSON_NULL, cJSON_False, cJSON_True, cJSON_Number, cJSON_Number, cJSON_String, cJSON_Array, cJSON_Object };
+
+    if (!tape_has_node(tape, node))
+    {
+        return cJSON_Invalid;
+    }
+
+    return types[tape->types[node]];
+}
+
+CJSON_PUBLIC(size_t) cJSON_TapeGetSize(const cJSON_Tape* tape, size_t node)
+{
+    if (!tape_has_node(tape, node) || (tape->types[node] < tape_array))
+    {
+        return 0;
+    }
+
+    return tape->values[node];
+}
+
+CJSON_PUBLIC(size_t) cJSON_TapeGetChild(const cJSON_Tape* tape, size_t node)
+{
+    return (cJSON_TapeGetSize(tape, node) > 0) ? (node + 1) : 0;
+}
+
+CJSON_PUBLIC(size_t) cJSON_TapeGetNext(const cJSON_Tape* tape, size_t node)
+{
+    return tape_has_node(tape, node) ? tape->next[node] : 0;
+}
+
+CJSON_PUBLIC(size_t) cJSON_TapeGetArrayItem(const cJSON_Tape* tape, size_t array, size_t index)
+{
+    size_t child = 0;
+
+    if (!tape_has_node(tape, array) || (tape->types[array] != tape_array) || (index >= tape->values[array]))
+    {
+        return 0;
+    }
+
+    for (child = array + 1; index > 0; index--)
+    {
+        child = tape->next[child];
+    }
+
+    return child;
+}
+
+static size_t tape_get_object_item(const cJSON_Tape* const tape, const size_t object, const char* const name, const cJSON_bool case_sensitive)
+{
+    size_t child = 0;
+
+    if (!tape_has_node(tape, object) || (tape->types[object] != tape_object) || (tape->values[object] == 0) || (name == NULL))
+    {
+        return 0;
+    }
+
+    for (child = object + 1; child != 0; child = tape->next[child])
+    {
+        const char* key = tape->strings + tape->keys[child];
+        if (case_sensitive ? (strcmp(name, key) == 0) : (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)key) == 0))
+        {
+            return child;
+        }
+    }
+
+    return 0;
+}
+
+CJSON_PUBLIC(size_t) cJSON_TapeGetObjectItem(const cJSON_Tape* tape, size_t object, const char* string)
+{
+    return tape_get_object_item(tape, object, string, false);
+}
+
+CJSON_PUBLIC(size_t) cJSON_TapeGetObjectItemCaseSensitive(const cJSON_Tape* tape, size_t object, const char* string)
+{
+    return tape_get_object_item(tape, object, string, true);
+}
+
+CJSON_PUBLIC(const char*) cJSON_TapeGetKey(const cJSON_Tape* tape, size_t node)
+{
+    if (!tape_has_node(tape, node) || (tape->keys[node] == 0))
+    {
+        return NULL;
+    }
+
+    return tape->strings + tape->keys[node];
+}
+
+CJSON_PUBLIC(const char*) cJSON_TapeGetStringValue(const cJSON_Tape* tape, size_t node)
+{
+    if (!tape_has_node(tape, node) || (tape->types[node] != tape_string))
+    {
+        return NULL;
+    }
+
+    return tape->strings + tape->values[node];
+}
+
+CJSON_PUBLIC(double) cJSON_TapeGetNumberValue(const cJSON_Tape* tape, size_t node)
+{
+    if (!tape_has_node(tape, node))
+    {
+        return (double)NAN;
+    }
+    if (tape->types[node] == tape_integer)
+    {
+        return (double)(int32_t)tape->values[node];
+    }
+    if (tape->types[node] == tape_double)
+    {
+        return tape->numbers[tape->values[node]];
+    }
+
+    return (double)NAN;
+}
+
+/* Push parser: a state machine finds the tokens, so it can stop anywhere in a chunk and continue with the next one.
+ * Complete tokens are converted by parse_value right where they are in the chunk, only a token that is split between
+ * chunks is collected in a buffer first. Arrays and objects are linked up as they are opened, so the root always
+ * owns everything parsed so far. */
+typedef enum
+{
+    push_expect_value,
+    push_expect_value_or_end, /* after '[' */
+    push_expect_key,
+    push_expect_key_or_end, /* after '{' */
+    push_expect_colon,
+    push_expect_comma_or_end,
+    push_expect_nothing, /* the document is complete */
+    push_failed
+} push_state;
+
+typedef enum
+{
+    push_no_token,
+    push_string_token,
+    push_number_token,
+    push_literal_token
+} push_token_type;
+
+struct cJSON_PushParser
+{
+    internal_hooks hooks;
+    push_state state;
+    cJSON* root;
+    /* open arrays and objects, innermost last */
+    cJSON** stack;
+    size_t depth;
+    size_t stack_size;
+    /* key of the member whose value comes next */
+    char* key;
+    /* the token that is being read, token holds its beginning if it started in an earlier chunk */
+    push_token_type token_type;
+    cJSON_bool token_is_key;
+    cJSON_bool token_escaped; /* a string token ended on a backslash */
+    unsigned char* token;
+    size_t token_length;
+    size_t token_size;
+    size_t bom_length; /* bytes of the UTF-8 byte order mark read so far, 3 once it's out of the question */
+    /* position in the input; lines are only counted up to where a position is needed */
+    size_t chunk_offset; /* of the current chunk */
+    size_t counted; /* bytes of the current chunk whose newlines are counted */
+    size_t line;
+    size_t line_offset; /* where the current line starts */
+    cJSON_ParseError token_start; /* where a token that continues from an earlier chunk started */
+    cJSON_ParseError error;
+};
+
+static cJSON_bool push_fail(cJSON_PushParser* const parser, const char* const reason)
+{
+    if (parser->error.reason == NULL)
+    {
+        parser->error.reason = reason;
+    }
+
+    return false;
+}
+
+/* get the line and column of position in the current chunk, positions have to be located in ascending order */
+static void push_locate(cJSON_PushParser* const parser, const unsigned char* const chunk, const size_t position, cJSON_ParseError* const location)
+{
+    const unsigned char* newline = NULL;
+
+    while ((parser->counted < position) && ((newline = (const unsigned char*)memchr(chunk + parser->counted, '\n', position - parser->counted)) != NULL))
+    {
+        parser->line++;
+        parser->counted = (size_t)(newline - chunk) + 1;
+        parser->line_offset = parser->chunk_offset + parser->counted;
+    }
+    if (parser->counted < position)
+    {
+        parser->counted = position;
+    }
+
+    location->offset = parser->chunk_offset + position;
+    location->line = parser->line;
+    location->column = location->offset - parser->line_offset + 1;
+}
+
+static cJSON_bool push_append_token(cJSON_PushParser* const parser, const unsigned char* const bytes, const size_t length)
+{
+    if ((parser->token_length + length) > parser->token_size)
+    {
+        size_t new_size = (parser->token_size > 0) ? parser->token_size : 64;
+        unsigned char* new_token = NULL;
+
+        while (new_size < (parser->token_length + length))
+        {
+            if (new_size > (((size_t)-1) / 2))
+            {
+                return false;
+            }
+            new_size *= 2;
+        }
+
+        new_token = (unsigned char*)parser->hooks.allocate(new_size);
+        if (new_token == NULL)
+        {
+            return push_fail(parser, "out of memory");
+        }
+        if (parser->token != NULL)
+        {
+            memcpy(new_token, parser->token, parser->token_length);
+            parser->hooks.deallocate(parser->token);
+        }
+        parser->token = new_token;
+        parser->token_size = new_size;
+    }
+
+    memcpy(parser->token + parser->token_length, bytes, length);
+    parser->token_length += length;
+
+    return true;
+}
+
+/* link a completely read value into the document */
+static void push_attach(cJSON_PushParser* const parser, cJSON* const item)
+{
+    cJSON* parent = NULL;
+
+    if (parser->depth == 0)
+    {
+        parser->root = item;
+        parser->state = push_expect_nothing;
+        return;
+    }
+
+    parent = parser->stack[parser->depth - 1];
+    if ((parent->type & 0xFF) == cJSON_Object)
+    {
+        item->string = parser->key;
+        parser->key = NULL;
+    }
+
+    /* the head's prev points to the tail, as with the other parse functions */
+    if (parent->child == NULL)
+    {
+        parent->child = item;
+    }
+    else
+    {
+        parent->child->prev->next = item;
+        item->prev = parent->child->prev;
+    }
+    parent->child->prev = item;
+    index_append(parent, item);
+
+    parser->state = push_expect_comma_or_end;
+}
+
+static cJSON_bool push_open(cJSON_PushParser* const parser, const int type)
+{
+    cJSON* item = NULL;
+
+    if (parser->depth >= CJSON_NESTING_LIMIT)
+    {
+        return push_fail(parser, "nesting too deep");
+    }
+
+    if (parser->depth == parser->stack_size)
+    {
+        size_t new_size = (parser->stack_size > 0) ? (parser->stack_size * 2) : 16;
+        cJSON** new_stack = (cJSON**)parser->hooks.allocate(new_size * sizeof(cJSON*));
+        if (new_stack == NULL)
+        {
+            return push_fail(parser, "out of memory");
+        }
+        if (parser->stack != NULL)
+        {
+            memcpy(new_stack, parser->stack, parser->depth * sizeof(cJSON*));
+            parser->hooks.deallocate(parser->stack);
+        }
+        parser->stack = new_stack;
+        parser->stack_size = new_size;
+    }
+
+    item = new_container_item(&parser->hooks);
+    if (item == NULL)
+    {
+        return push_fail(parser, "out of memory");
+    }
+    set_item_type(item, type);
+
+    push_attach(parser, item);
+    parser->stack[parser->depth++] = item;
+    parser->state = (type == cJSON_Object) ? push_expect_key_or_end : push_expect_value_or_end;
+
+    return true;
+}
+
+static cJSON_bool push_close(cJSON_PushParser* const parser, const int type)
+{
+    if ((parser->depth == 0) || ((parser->stack[parser->depth - 1]->type & 0xFF) != type))
+    {
+        return false;
+    }
+
+    parser->depth--;
+    parser->state = (parser->depth == 0) ? push_expect_nothing : push_expect_comma_or_end;
+
+    return true;
+}
+
+/* convert the string, number or literal at the start of token with the regular parser, reason tells why that failed */
+static cJSON* push_parse_token(const cJSON_PushParser* const parser, const unsigned char* const token, const size_t length, size_t* const token_length, const char** const reason)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    cJSON* item = cJSON_New_Item(&parser->hooks);
+
+    if (item == NULL)
+    {
+        *reason = "out of memory";
+        return NULL;
+    }
+
+    buffer.content = token;
+    buffer.length = length;
+    buffer.hooks = parser->hooks;
+    if (!parse_value(item, &buffer))
+    {
+        *reason = buffer.error_reason;
+        cJSON_Delete(item);
+        return NULL;
+    }
+    *token_length = buffer.offset;
+
+    return item;
+}
+
+static cJSON_bool push_finish_token(cJSON_PushParser* const parser, cJSON* const item)
+{
+    parser->token_type = push_no_token;
+    parser->token_length = 0;
+
+    if (parser->token_is_key)
+    {
+        parser->key = item->valuestring;
+        item->valuestring = NULL;
+        cJSON_Delete(item);
+        parser->state = push_expect_colon;
+        return true;
+    }
+
+    push_attach(parser, item);
+
+    return true;
+}
+
+/* a token read in full, it has to be exactly one string, number or literal */
+static cJSON_bool push_convert_token(cJSON_PushParser* const parser, const unsigned char* const token, const size_t length)
+{
+    size_t token_length = 0;
+    const char* reason = NULL;
+    cJSON* item = push_parse_token(parser, token, length, &token_length, &reason);
+
+    if (item == NULL)
+    {
+        return push_fail(parser, reason);
+    }
+    if (token_length != length)
+    {
+        cJSON_Delete(item);
+        return push_fail(parser, (parser->token_type == push_number_token) ? "invalid number" : "expected a value");
+    }
+
+    return push_finish_token(parser, item);
+}
+
+/* numbers and literals end with the first byte that can't belong to them */
+static cJSON_bool push_continues_token(const push_token_type type, const unsigned char byte)
+{
+    if (type == push_number_token)
+    {
+        return ((byte >= '0') && (byte <= '9')) || (byte == '+') || (byte == '-') || (byte == '.') || (byte == 'e') || (byte == 'E');
+    }
+
+    return (byte >= 'a') && (byte <= 'z');
+}
+
+/* read as much of the current token as the chunk holds, position is advanced past it */
+static cJSON_bool push_read_token(cJSON_PushParser* const parser, const unsigned char* const chunk, const size_t length, size_t* const position)
+{
+    size_t start = *position;
+    size_t end = start;
+    cJSON_bool complete = false;
+
+    if (parser->token_length == 0)
+    {
+        /* most tokens are complete within the chunk, so try to convert them right away */
+        size_t token_length = 0;
+        const char* reason = NULL;
+        cJSON* item = push_parse_token(parser, chunk + start, length - start, &token_length, &reason);
+        if (item != NULL)
+        {
+            end = start + token_length;
+            if ((parser->token_type == push_string_token) || ((end < length) && !push_continues_token(parser->token_type, chunk[end])))
+            {
+                *position = end;
+                return push_finish_token(parser, item);
+            }
+            /* the token may go on in the next chunk */
+            cJSON_Delete(item);
+            end = start;
+        }
+    }
+
+    if (parser->token_type == push_string_token)
+    {
+        const scan_kernels* const kernels = get_scan_kernels();
+
+        if (parser->token_length == 0)
+        {
+            end++; /* the opening quote */
+        }
+        while (end < length)
+        {
+            if (parser->token_escaped)
+            {
+                parser->token_escaped = false;
+                end++;
+                continue;
+            }
+            end += kernels->find_quote_or_backslash(chunk + end, length - end);
+            if (end >= length)
+            {
+                break;
+            }
+            end++;
+            if (chunk[end - 1] == '\\')
+            {
+                parser->token_escaped = true;
+                continue;
+            }
+            complete = true;
+            break;
+        }
+    }
+    else
+    {
+        while ((end < length) && push_continues_token(parser->token_type, chunk[end]))
+        {
+            end++;
+        }
+        complete = (end < length);
+    }
+    *position = end;
+
+    if (complete && (parser->token_length == 0))
+    {
+        return push_convert_token(parser, chunk + start, end - start);
+    }
+    if (!push_append_token(parser, chunk + start, end - start))
+    {
+        return false;
+    }
+
+    return !complete || push_convert_token(parser, parser->token, parser->token_length);
+}
+
+static void push_start_token(cJSON_PushParser* const parser, const push_token_type type, const cJSON_bool is_key)
+{
+    parser->token_type = type;
+    parser->token_is_key = is_key;
+    parser->token_escaped = false;
+    parser->token_length = 0;
+}
+
+/* handle the byte at position outside of tokens, it isn't whitespace */
+static cJSON_bool push_structure(cJSON_PushParser* const parser, const unsigned char byte, size_t* const position)
+{
+    switch (parser->state)
+    {
+    case push_expect_value:
+    case push_expect_value_or_end:
+        if ((byte == ']') && (parser->state == push_expect_value_or_end))
+        {
+            (*position)++;
+            return push_close(parser, cJSON_Array);
+        }
+        if ((byte == '[') || (byte == '{'))
+        {
+            (*position)++;
+            return push_open(parser, (byte == '[') ? cJSON_Array : cJSON_Object);
+        }
+        if (byte == '\"')
+        {
+            push_start_token(parser, push_string_token, false);
+            return true;
+        }
+        if ((byte == '-') || ((byte >= '0') && (byte <= '9')))
+        {
+            push_start_token(parser, push_number_token, false);
+            return true;
+        }
+        if ((byte == 't') || (byte == 'f') || (byte == 'n'))
+        {
+            push_start_token(parser, push_literal_token, false);
+            return true;
+        }
+        return false;
+
+    case push_expect_key:
+    case push_expect_key_or_end:
+        if ((byte == '}') && (parser->state == push_expect_key_or_end))
+        {
+            (*position)++;
+            return push_close(parser, cJSON_Object);
+        }
+        if (byte == '\"')
+        {
+            push_start_token(parser, push_string_token, true);
+            return true;
+        }
+        return false;
+
+    case push_expect_colon:
+        if (byte != ':')
+        {
+            return false;
+        }
+        (*position)++;
+        parser->state = push_expect_value;
+        return true;
+
+    case push_expect_comma_or_end:
+        (*position)++;
+        if (byte == ',')
+        {
+            parser->state = ((parser->stack[parser->depth - 1]->type & 0xFF) == cJSON_Object) ? push_expect_key : push_expect_value;
+            return true;
+        }
+        if (byte == ']')
+        {
+            return push_close(parser, cJSON_Array);
+        }
+        if (byte == '}')
+        {
+            return push_close(parser, cJSON_Object);
+        }
+        return false;
+
+    default:
+        return push_fail(parser, "unexpected data after the document");
+    }
+}
+
+/* what push_structure wanted to see instead of a byte it didn't accept */
+static const char* push_expectation(const cJSON_PushParser* const parser)
+{
+    switch (parser->state)
+    {
+    case push_expect_value:
+    case push_expect_value_or_end:
+        return "expected a value";
+
+    case push_expect_key:
+    case push_expect_key_or_end:
+        return "expected a string";
+
+    case push_expect_colon:
+        return "expected ':'";
+
+    case push_expect_comma_or_end:
+        return ((parser->stack[parser->depth - 1]->type & 0xFF) == cJSON_Object) ? "expected ',' or '}'" : "expected ',' or ']'";
+
+    default:
+        return "unexpected data after the document";
+    }
+}
+
+CJSON_PUBLIC(cJSON_PushParser*) cJSON_PushParserNew(void)
+{
+    cJSON_PushParser* parser = (cJSON_PushParser*)global_hooks.allocate(sizeof(cJSON_PushParser));
+
+    if (parser != NULL)
+    {
+        memset(parser, '\0', sizeof(cJSON_PushParser));
+        parser->hooks = global_hooks;
+        parser->state = push_expect_value;
+        parser->token_type = push_no_token;
+        parser->line = 1;
+        parser->error.line = 1;
+        parser->error.column = 1;
+    }
+
+    return parser;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PushParserFeed(cJSON_PushParser* parser, const char* chunk, size_t length)
+{
+    static const unsigned char utf8_bom[3] = { 0xEF, 0xBB, 0xBF };
+    const unsigned char* const bytes = (const unsigned char*)chunk;
+    const scan_kernels* const kernels = get_scan_kernels();
+    size_t position = 0;
+
+    if ((parser == NULL) || (parser->state == push_failed) || ((chunk == NULL) && (length > 0)))
+    {
+        return false;
+    }
+
+    /* skip the UTF-8 byte order mark, which may be split between chunks as well */
+    for (; (parser->bom_length < sizeof(utf8_bom)) && (position < length); position++)
+    {
+        if (bytes[position] != utf8_bom[parser->bom_length])
+        {
+            if (parser->bom_length > 0)
+            {
+                push_fail(parser, "invalid byte order mark");
+                push_locate(parser, bytes, position, &parser->error);
+                goto fail;
+            }
+            parser->bom_length = sizeof(utf8_bom);
+            break;
+        }
+        parser->bom_length++;
+    }
+
+    while (position < length)
+    {
+        size_t start = position;
+
+        if (parser->token_type != push_no_token)
+        {
+            cJSON_bool continued = (parser->token_length > 0);
+            if (!push_read_token(parser, bytes, length, &position))
+            {
+                /* errors in tokens are reported where the token starts */
+                if (continued)
+                {
+                    parser->error.offset = parser->token_start.offset;
+                    parser->error.line = parser->token_start.line;
+                    parser->error.column = parser->token_start.column;
+                }
+                else
+                {
+                    push_locate(parser, bytes, start, &parser->error);
+                }
+                goto fail;
+            }
+            if (!continued && (parser->token_type != push_no_token))
+            {
+                /* the token goes on in the next chunk */
+                push_locate(parser, bytes, start, &parser->token_start);
+            }
+            continue;
+        }
+
+        position += kernels->skip_whitespace(bytes + position, length - position);
+        start = position;
+        if ((position < length) && !push_structure(parser, bytes[position], &position))
+        {
+            push_fail(parser, push_expectation(parser));
+            push_locate(parser, bytes, start, &parser->error);
+            goto fail;
+        }
+    }
+
+    /* carry the line count over to the next chunk, error holds where the input ends so far */
+    push_locate(parser, bytes, length, &parser->error);
+    parser->chunk_offset += length;
+    parser->counted = 0;
+
+    return true;
+
+fail:
+    parser->state = push_failed;
+
+    return false;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_PushParserFinish(cJSON_PushParser* parser, cJSON_ParseError* parse_error)
+{
+    cJSON* root = NULL;
+
+    if (parser == NULL)
+    {
+        if (parse_error != NULL)
+        {
+            memset(parse_error, '\0', sizeof(cJSON_ParseError));
+            parse_error->line = 1;
+            parse_error->column = 1;
+            parse_error->reason = "out of memory";
+        }
+        return NULL;
+    }
+
+    /* a number or literal at the very end is only complete now */
+    if ((parser->state != push_failed) && ((parser->token_type == push_number_token) || (parser->token_type == push_literal_token)))
+    {
+        if (!push_convert_token(parser, parser->token, parser->token_length))
+        {
+            parser->error.offset = parser->token_start.offset;
+            parser->error.line = parser->token_start.line;
+            parser->error.column = parser->token_start.column;
+            parser->state = push_failed;
+        }
+    }
+
+    if ((parser->state == push_expect_nothing) && (parser->token_type == push_no_token))
+    {
+        root = parser->root;
+        parser->root = NULL;
+        memset(&parser->error, '\0', sizeof(cJSON_ParseError));
+    }
+    else if (parser->state != push_failed)
+    {
+        /* the error position is where the input ended */
+        push_fail(parser, (parser->token_type == push_string_token) ? "unterminated string" : "unexpected end of input");
+    }
+
+    if (parse_error != NULL)
+    {
+        *parse_error = parser->error;
+    }
+    cJSON_PushParserDelete(parser);
+
+    return root;
+}
+
+CJSON_PUBLIC(void) cJSON_PushParserDelete(cJSON_PushParser* parser)
+{
+    if (parser == NULL)
+    {
+        return;
+    }
+
+    if (parser->root != NULL)
+    {
+        cJSON_Delete(parser->root);
+    }
+    if (parser->key != NULL)
+    {
+        parser->hooks.deallocate(parser->key);
+    }
+    if (parser->token != NULL)
+    {
+        parser->hooks.deallocate(parser->token);
+    }
+    if (parser->stack != NULL)
+    {
+        parser->hooks.deallocate(parser->stack);
+    }
+    parser->hooks.deallocate(parser);
+}
+
+/* Default options for cJSON_Parse */
+CJSON_PUBLIC(cJSON*) cJSON_Parse(const char* value)
+{
+    return cJSON_ParseWithOpts(value, 0, 0);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_ParseWithLength(const char* value, size_t buffer_length)
+{
+    return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+}
+
+#define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
+
+static unsigned char* print(const cJSON* const item, cJSON_bool format, const internal_hooks* const hooks)
+{
+    static const size_t default_buffer_size = 256;
+    printbuffer buffer[1];
+    unsigned char* printed = NULL;
+
+    memset(buffer, 0, sizeof(buffer));
+
+    /* create buffer */
+    buffer->buffer = (unsigned char*)hooks_allocate(hooks, default_buffer_size);
+    buffer->length = default_buffer_size;
+    buffer->format = format;
+    buffer->hooks = *hooks;
+    if (buffer->buffer == NULL)
+    {
+        goto fail;
+    }
+
+    /* print the value */
+    if (!print_value(item, buffer))
+    {
+        goto fail;
+    }
+
+    /* check if reallocate is available */
+    if (hooks_can_reallocate(hooks))
+    {
+        printed = (unsigned char*)hooks_reallocate(hooks, buffer->buffer, buffer->offset + 1);
+        if (printed == NULL) {
+            goto fail;
+        }
+        buffer->buffer = NULL;
+    }
+    else /* otherwise copy the JSON over to a new buffer */
+    {
+        printed = (unsigned char*)hooks_allocate(hooks, buffer->offset + 1);
+        if (printed == NULL)
+        {
+            goto fail;
+        }
+        memcpy(printed, buffer->buffer, cjson_min(buffer->length, buffer->offset + 1));
+        printed[buffer->offset] = '\0'; /* just to be sure */
+
+        /* free the buffer */
+        hooks_deallocate(hooks, buffer->buffer);
+        buffer->buffer = NULL;
+    }
+
+    return printed;
+
+fail:
+    if (buffer->buffer != NULL)
+    {
+        hooks_deallocate(hooks, buffer->buffer);
+        buffer->buffer = NULL;
+    }
+
+    if (printed != NULL)
+    {
+        hooks_deallocate(hooks, printed);
+        printed = NULL;
+    }
+
+    return NULL;
+}
+
+/* Render a cJSON item/entity/structure to text. */
+CJSON_PUBLIC(char*) cJSON_Print(const cJSON* item)
+{
+    return (char*)print(item, true, &global_hooks);
+}
+
+CJSON_PUBLIC(char*) cJSON_PrintUnformatted(const cJSON* item)
+{
+    return (char*)print(item, false, &global_hooks);
+}
+
+CJSON_PUBLIC(char*) cJSON_PrintWithAllocator(const cJSON* item, cJSON_bool format, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return (char*)print(item, format, &hooks);
+}
+
+CJSON_PUBLIC(char*) cJSON_PrintBuffered(const cJSON* item, int prebuffer, cJSON_bool fmt)
+{
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, NULL, NULL };
+
+    if (prebuffer < 0)
+    {
+        return NULL;
+    }
+
+    p.buffer = (unsigned char*)global_hooks.allocate((size_t)prebuffer);
+    if (!p.buffer)
+    {
+        return NULL;
+    }
+
+    p.length = (size_t)prebuffer;
+    p.offset = 0;
+    p.noalloc = false;
+    p.format = fmt;
+    p.hooks = global_hooks;
+
+    if (!print_value(item, &p))
+    {
+        global_hooks.deallocate(p.buffer);
+        p.buffer = NULL;
+        return NULL;
+    }
+
+    return (char*)p.buffer;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON* item, char* buffer, const int length, const cJSON_bool format)
+{
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, NULL, NULL };
+
+    if ((length < 0) || (buffer == NULL))
+    {
+        return false;
+    }
+
+    p.buffer = (unsigned char*)buffer;
+    p.length = (size_t)length;
+    p.offset = 0;
+    p.noalloc = true;
+    p.format = format;
+    p.hooks = global_hooks;
+
+    return print_value(item, &p);
+}
+
+/* Add the length of a string as print_string_ptr writes it, quotes included. */
+static void measure_string(const unsigned char* const string, size_t* const length)
+{
+    size_t string_length = 0;
+
+    if (string == NULL)
+    {
+        *length += static_strlen("\"\"");
+        return;
+    }
+
+    string_length = strlen((const char*)string);
+    *length += count_escapes(string, string_length) + string_length + static_strlen("\"\"");
+}
+
+/* Add the length of what print_value writes for item at the given nesting depth, the first pass of cJSON_PrintExact. */
+static cJSON_bool measure_value(const cJSON* const item, size_t depth, cJSON_bool format, size_t* const length)
+{
+    unsigned char number[NUMBER_TEXT_SIZE];
+    const cJSON* child = NULL;
+    size_t number_length = 0;
+
+    if (!expand_lazy(item))
+    {
+        return false;
+    }
+
+    switch (item->type & 0xFF)
+    {
+    case cJSON_NULL:
+    case cJSON_True:
+        *length += static_strlen("null");
+        return true;
+
+    case cJSON_False:
+        *length += static_strlen("false");
+        return true;
+
+    case cJSON_Number:
+        number_length = print_number_text(item, number);
+        *length += number_length;
+        return number_length != 0;
+
+    case cJSON_Raw:
+        if (item->valuestring == NULL)
+        {
+            return false;
+        }
+        *length += strlen(item->valuestring);
+        return true;
+
+    case cJSON_String:
+        measure_string((const unsigned char*)item->valuestring, length);
+        return true;
+
+    case cJSON_Array:
+        *length += static_strlen("[]");
+        for (child = item->child; child != NULL; child = child->next)
+        {
+            if (!measure_value(child, depth + 1, format, length))
+            {
+                return false;
+            }
+            if (child->next != NULL)
+            {
+                *length += format ? static_strlen(", ") : static_strlen(",");
+            }
+        }
+        return true;
+
+    case cJSON_Object:
+        /* formatted: "{\n", a line per member indented by depth + 1 tabs, the closing brace indented by depth */
+        *length += format ? (static_strlen("{\n}") + depth) : static_strlen("{}");
+        for (child = item->child; child != NULL; child = child->next)
+        {
+            measure_string((const unsigned char*)child->string, length);
+            if (!measure_value(child, depth + 1, format, length))
+            {
+                return false;
+            }
+            *length += format ? ((depth + 1) + static_strlen(":\t") + static_strlen("\n")) : static_strlen(":");
+            if (child->next != NULL)
+            {
+                *length += static_strlen(",");
+            }
+        }
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+CJSON_PUBLIC(char*) cJSON_PrintExact(const cJSON* item, cJSON_bool format)
+{
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, NULL, NULL };
+    size_t length = 0;
+
+    if ((item == NULL) || !measure_value(item, 0, format, &length) || (length > INT_MAX))
+    {
+        return NULL;
+    }
+
+    /* ensure() wants one byte more than the terminator */
+    p.buffer = (unsigned char*)global_hooks.allocate(length + 2);
+    if (p.buffer == NULL)
+    {
+        return NULL;
+    }
+
+    p.length = length + 2;
+    p.offset = 0;
+    p.noalloc = true;
+    p.format = format;
+    p.hooks = global_hooks;
+
+    if (!print_value(item, &p) || (p.offset != length))
+    {
+        global_hooks.deallocate(p.buffer);
+        return NULL;
+    }
+
+    return (char*)p.buffer;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintToWriter(const cJSON* item, cJSON_WriteFunction write_fn, void* context, const cJSON_bool format)
+{
+    unsigned char chunk[PRINT_WRITER_CHUNK_SIZE];
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, NULL, NULL };
+    cJSON_bool success = false;
+
+    if ((item == NULL) || (write_fn == NULL))
+    {
+        return false;
+    }
+
+    p.buffer = chunk;
+    p.length = sizeof(chunk);
+    p.offset = 0;
+    p.noalloc = true;
+    p.format = format;
+    p.hooks = global_hooks;
+    p.write = write_fn;
+    p.write_context = context;
+    p.fixed_buffer = chunk;
+
+    if (print_value(item, &p))
+    {
+        success = (p.offset == 0) || write_fn(context, (const char*)p.buffer, p.offset);
+    }
+
+    if (p.buffer != p.fixed_buffer)
+    {
+        hooks_deallocate(&p.hooks, p.buffer);
+    }
+
+    return success;
+}
+
+/* CBOR (RFC 8949).
+ * The items map to CBOR directly: null, false and true are simple values, whole numbers become integers and other numbers
+ * the smallest float that holds them exactly, arrays and objects become definite length arrays and maps with text keys.
+ * Raw items are byte strings with tag 262 (embedded JSON). NaN and infinity are written as null, like in text. */
+
+#define CBOR_MAJOR_UNSIGNED 0
+#define CBOR_MAJOR_NEGATIVE 1
+#define CBOR_MAJOR_BYTES 2
+#define CBOR_MAJOR_TEXT 3
+#define CBOR_MAJOR_ARRAY 4
+#define CBOR_MAJOR_MAP 5
+#define CBOR_MAJOR_TAG 6
+#define CBOR_MAJOR_SIMPLE 7
+
+#define CBOR_INDEFINITE 31
+#define CBOR_BREAK 0xFF
+#define CBOR_TAG_EMBEDDED_JSON 262
+
+/* the initial byte of a data item and its argument in as few bytes as possible */
+static cJSON_bool cbor_write_head(printbuffer* const output_buffer, const unsigned char major, const uint64_t argument)
+{
+    unsigned char* output = ensure(output_buffer, 9);
+    size_t size = 0;
+    size_t i = 0;
+
+    if (output == NULL)
+    {
+        return false;
+    }
+
+    if (argument < 24)
+    {
+        output[0] = (unsigned char)((major << 5) | argument);
+        output_buffer->offset++;
+        return true;
+    }
+
+    if (argument <= 0xFF)
+    {
+        output[0] = (unsigned char)((major << 5) | 24);
+        size = 1;
+    }
+    else if (argument <= 0xFFFF)
+    {
+        output[0] = (unsigned char)((major << 5) | 25);
+        size = 2;
+    }
+    else if (argument <= 0xFFFFFFFFUL)
+    {
+        output[0] = (unsigned char)((major << 5) | 26);
+        size = 4;
+    }
+    else
+    {
+        output[0] = (unsigned char)((major << 5) | 27);
+        size = 8;
+    }
+    for (i = 0; i < size; i++)
+    {
+        output[size - i] = (unsigned char)(argument >> (8 * i));
+    }
+    output_buffer->offset += size + 1;
+
+    return true;
+}
+
+static cJSON_bool cbor_write_string(printbuffer* const output_buffer, const unsigned char major, const char* const string)
+{
+    size_t length = (string != NULL) ? strlen(string) : 0;
+    unsigned char* output = NULL;
+
+    if (!cbor_write_head(output_buffer, major, (uint64_t)length))
+    {
+        return false;
+    }
+    if (length == 0)
+    {
+        return true;
+    }
+
+    output = ensure(output_buffer, length);
+    if (output == NULL)
+    {
+        return false;
+    }
+    memcpy(output, string, length);
+    output_buffer->offset += length;
+
+    return true;
+}
+
+static cJSON_bool cbor_write_number(printbuffer* const output_buffer, const double number)
+{
+    const double zero = 0.0;
+    unsigned char* output = NULL;
+    unsigned char bytes[8];
+    size_t size = 8;
+    size_t i = 0;
+
+    if (isnan(number) || isinf(number))
+    {
+        return cbor_write_head(output_buffer, CBOR_MAJOR_SIMPLE, 22);
+    }
+
+    /* -0 stays a float so it keeps its sign */
+    if ((number == floor(number)) && (number >= -9223372036854775808.0) && (number < 9223372036854775808.0) && ((number != 0) || (memcmp(&number, &zero, sizeof(number)) == 0)))
+    {
+        int64_t integer = (int64_t)number;
+        if (integer >= 0)
+        {
+            return cbor_write_head(output_buffer, CBOR_MAJOR_UNSIGNED, (uint64_t)integer);
+        }
+        return cbor_write_head(output_buffer, CBOR_MAJOR_NEGATIVE, (uint64_t)(-(integer + 1)));
+    }
+
+    output = ensure(output_buffer, 9);
+    if (output == NULL)
+    {
+        return false;
+    }
+    if ((fabs(number) <= FLT_MAX) && ((double)(float)number == number))
+    {
+        float single = (float)number;
+        uint32_t bits = 0;
+        memcpy(&bits, &single, sizeof(bits));
+        output[0] = (unsigned char)((CBOR_MAJOR_SIMPLE << 5) | 26);
+        size = 4;
+        for (i = 0; i < size; i++)
+        {
+            bytes[size - 1 - i] = (unsigned char)(bits >> (8 * i));
+        }
+    }
+    else
+    {
+        uint64_t bits = 0;
+        memcpy(&bits, &number, sizeof(bits));
+        output[0] = (unsigned char)((CBOR_MAJOR_SIMPLE << 5) | 27);
+        for (i = 0; i < size; i++)
+        {
+            bytes[size - 1 - i] = (unsigned char)(bits >> (8 * i));
+        }
+    }
+    memcpy(output + 1, bytes, size);
+    output_buffer->offset += size + 1;
+
+    return true;
+}
+
+static cJSON_bool cbor_write_value(const cJSON* const item, printbuffer* const output_buffer)
+{
+    const cJSON* child = NULL;
+    size_t count = 0;
+
+    if ((item == NULL) || !expand_lazy(item))
+    {
+        return false;
+    }
+
+    switch ((item->type) & 0xFF)
+    {
+        case cJSON_NULL:
+            return cbor_write_head(output_buffer, CBOR_MAJOR_SIMPLE, 22);
+
+        case cJSON_False:
+            return cbor_write_head(output_buffer, CBOR_MAJOR_SIMPLE, 20);
+
+        case cJSON_True:
+            return cbor_write_head(output_buffer, CBOR_MAJOR_SIMPLE, 21);
+
+        case cJSON_Number:
+            return cbor_write_number(output_buffer, item->valuedouble);
+
+        case cJSON_String:
+            return cbor_write_string(output_buffer, CBOR_MAJOR_TEXT, item->valuestring);
+
+        case cJSON_Raw:
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            return cbor_write_head(output_buffer, CBOR_MAJOR_TAG, CBOR_TAG_EMBEDDED_JSON) && cbor_write_string(output_buffer, CBOR_MAJOR_BYTES, item->valuestring);
+
+        case cJSON_Array:
+        case cJSON_Object:
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                count++;
+            }
+            if (!cbor_write_head(output_buffer, ((item->type & 0xFF) == cJSON_Array) ? CBOR_MAJOR_ARRAY : CBOR_MAJOR_MAP, (uint64_t)count))
+            {
+                return false;
+            }
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                if (((item->type & 0xFF) == cJSON_Object) && !cbor_write_string(output_buffer, CBOR_MAJOR_TEXT, child->string))
+                {
+                    return false;
+                }
+                if (!cbor_write_value(child, output_buffer))
+                {
+                    return false;
+                }
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+CJSON_PUBLIC(unsigned char*) cJSON_ToCBOR(const cJSON* item, size_t* length)
+{
+    static const size_t default_buffer_size = 256;
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, NULL, NULL };
+    unsigned char* encoded = NULL;
+
+    if ((item == NULL) || (length == NULL))
+    {
+        return NULL;
+    }
+
+    p.buffer = (unsigned char*)global_hooks.allocate(default_buffer_size);
+    if (p.buffer == NULL)
+    {
+        return NULL;
+    }
+    p.length = default_buffer_size;
+    p.hooks = global_hooks;
+
+    if (!cbor_write_value(item, &p))
+    {
+        hooks_deallocate(&p.hooks, p.buffer);
+        return NULL;
+    }
+
+    /* give back what the doubling of the buffer left over */
+    encoded = (unsigned char*)resize_array(&p.hooks, p.buffer, 1, p.offset, (p.offset > 0) ? p.offset : 1);
+    if (encoded == NULL)
+    {
+        hooks_deallocate(&p.hooks, p.buffer);
+        return NULL;
+    }
+    *length = p.offset;
+
+    return encoded;
+}
+
+/* read the initial byte of a data item, info is its low 5 bits and argument the value that follows them (if any) */
+static cJSON_bool cbor_read_head(parse_buffer* const input_buffer, unsigned char* const major, unsigned char* const info, uint64_t* const argument)
+{
+    size_t size = 0;
+    size_t i = 0;
+
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        set_error_reason(input_buffer, "unexpected end of input");
+        return false;
+    }
+
+    *major = (unsigned char)(buffer_at_offset(input_buffer)[0] >> 5);
+    *info = (unsigned char)(buffer_at_offset(input_buffer)[0] & 0x1F);
+    *argument = *info;
+
+    if (*info < 24)
+    {
+        input_buffer->offset++;
+        return true;
+    }
+    if (*info == CBOR_INDEFINITE)
+    {
+        if ((*major == CBOR_MAJOR_UNSIGNED) || (*major == CBOR_MAJOR_NEGATIVE) || (*major == CBOR_MAJOR_TAG))
+        {
+            set_error_reason(input_buffer, "invalid CBOR item");
+            return false;
+        }
+        input_buffer->offset++;
+        return true;
+    }
+    if (*info > 27)
+    {
+        set_error_reason(input_buffer, "invalid CBOR item");
+        return false;
+    }
+
+    size = (size_t)1 << (*info - 24);
+    if (!can_read(input_buffer, size + 1))
+    {
+        set_error_reason(input_buffer, "unexpected end of input");
+        return false;
+    }
+    *argument = 0;
+    for (i = 1; i <= size; i++)
+    {
+        *argument = (*argument << 8) | buffer_at_offset(input_buffer)[i];
+    }
+    input_buffer->offset += size + 1;
+
+    return true;
+}
+
+/* read a text or byte string (of the given major type) whose head was just read into a new zero terminated copy,
+ * indefinite length strings are concatenated from their chunks */
+static cJSON_bool cbor_read_string(parse_buffer* const input_buffer, const unsigned char major, const unsigned char info, const uint64_t argument, char** const string)
+{
+    unsigned char chunk_major = 0;
+    unsigned char chunk_info = 0;
+    uint64_t chunk_length = 0;
+    size_t length = 0;
+    size_t start = input_buffer->offset;
+    unsigned char* output = NULL;
+
+    if (info != CBOR_INDEFINITE)
+    {
+        if (argument > (uint64_t)(input_buffer->length - input_buffer->offset))
+        {
+            set_error_reason(input_buffer, "unexpected end of input");
+            return false;
+        }
+        output = (unsigned char*)parse_allocate(input_buffer, (size_t)argument + 1);
+        if (output == NULL)
+        {
+            set_error_reason(input_buffer, "out of memory");
+            return false;
+        }
+        memcpy(output, buffer_at_offset(input_buffer), (size_t)argument);
+        output[argument] = '\0';
+        input_buffer->offset += (size_t)argument;
+        *string = (char*)output;
+        return true;
+    }
+
+    /* measure the chunks first, then copy them */
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] != CBOR_BREAK))
+    {
+        if (!cbor_read_head(input_buffer, &chunk_major, &chunk_info, &chunk_length))
+        {
+            return false;
+        }
+        if ((chunk_major != major) || (chunk_info == CBOR_INDEFINITE))
+        {
+            set_error_reason(input_buffer, "invalid CBOR string chunk");
+            return false;
+        }
+        if (chunk_length > (uint64_t)(input_buffer->length - input_buffer->offset))
+        {
+            set_error_reason(input_buffer, "unexpected end of input");
+            return false;
+        }
+        input_buffer->offset += (size_t)chunk_length;
+        length += (size_t)chunk_length;
+    }
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        set_error_reason(input_buffer, "unexpected end of input");
+        return false;
+    }
+
+    output = (unsigned char*)parse_allocate(input_buffer, length + 1);
+    if (output == NULL)
+    {
+        set_error_reason(input_buffer, "out of memory");
+        return false;
+    }
+    input_buffer->offset = start;
+    length = 0;
+    while (buffer_at_offset(input_buffer)[0] != CBOR_BREAK)
+    {
+        cbor_read_head(input_buffer, &chunk_major, &chunk_info, &chunk_length);
+        memcpy(output + length, buffer_at_offset(input_buffer), (size_t)chunk_length);
+        input_buffer->offset += (size_t)chunk_length;
+        length += (size_t)chunk_length;
+    }
+    output[length] = '\0';
+    input_buffer->offset++;
+    *string = (char*)output;
+
+    return true;
+}
+
+/* IEEE 754 half precision */
+static double cbor_half_to_double(const unsigned int half)
+{
+    int exponent = (int)((half >> 10) & 0x1F);
+    double mantissa = (double)(half & 0x3FF);
+    double value = 0;
+
+    if (exponent == 0)
+    {
+        value = ldexp(mantissa, -24);
+    }
+    else if (exponent != 31)
+    {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    }
+    else
+    {
+        value = (mantissa == 0) ? HUGE_VAL : NAN;
+    }
+
+    return (half & 0x8000) ? -value : value;
+}
+
+static cJSON_bool cbor_read_value(cJSON* const item, parse_buffer* const input_buffer);
+
+/* whether the next item is an array or map */
+static cJSON_bool cbor_container_follows(const parse_buffer* const input_buffer)
+{
+    return can_access_at_index(input_buffer, 0) && (((buffer_at_offset(input_buffer)[0] >> 5) == CBOR_MAJOR_ARRAY) || ((buffer_at_offset(input_buffer)[0] >> 5) == CBOR_MAJOR_MAP));
+}
+
+/* the elements of an array or the members of a map whose head was just read */
+static cJSON_bool cbor_read_container(cJSON* const item, parse_buffer* const input_buffer, const unsigned char major, const unsigned char info, uint64_t count)
+{
+    cJSON* head = NULL;
+    cJSON* current_item = NULL;
+    cJSON* new_item = NULL;
+    char* key = NULL;
+    unsigned char key_major = 0;
+    unsigned char key_info = 0;
+    uint64_t key_argument = 0;
+    size_t item_count = 0;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        set_error_reason(input_buffer, "nesting too deep");
+        return false;
+    }
+    input_buffer->depth++;
+
+    while ((info == CBOR_INDEFINITE) ? (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] != CBOR_BREAK)) : (count > 0))
+    {
+        /* the key comes first, so the item can be allocated knowing whether the value is an array or map */
+        if (major == CBOR_MAJOR_MAP)
+        {
+            if (!cbor_read_head(input_buffer, &key_major, &key_info, &key_argument))
+            {
+                goto fail;
+            }
+            if (key_major != CBOR_MAJOR_TEXT)
+            {
+                set_error_reason(input_buffer, "map keys have to be text strings");
+                goto fail;
+            }
+            if (!cbor_read_string(input_buffer, key_major, key_info, key_argument, &key))
+            {
+                goto fail;
+            }
+        }
+
+        new_item = parse_new_item(input_buffer, cbor_container_follows(input_buffer));
+        if (new_item == NULL)
+        {
+            set_error_reason(input_buffer, "out of memory");
+            goto fail;
+        }
+        new_item->string = key;
+        key = NULL;
+        if (head == NULL)
+        {
+            head = new_item;
+        }
+        else
+        {
+            current_item->next = new_item;
+            new_item->prev = current_item;
+        }
+        current_item = new_item;
+        item_count++;
+
+        if (!cbor_read_value(current_item, input_buffer))
+        {
+            goto fail;
+        }
+        count--;
+    }
+    if (info == CBOR_INDEFINITE)
+    {
+        if (cannot_access_at_index(input_buffer, 0))
+        {
+            set_error_reason(input_buffer, "unexpected end of input");
+            goto fail;
+        }
+        input_buffer->offset++;
+    }
+
+    input_buffer->depth--;
+
+    if (head != NULL)
+    {
+        head->prev = current_item;
+    }
+    set_item_type(item, (major == CBOR_MAJOR_ARRAY) ? cJSON_Array : cJSON_Object);
+    item->child = head;
+    index_linked_children(item, item_count);
+
+    return true;
+
+fail:
+    if (key != NULL)
+    {
+        hooks_deallocate(&input_buffer->hooks, key);
+    }
+    if (head != NULL)
+    {
+        cJSON_Delete(head);
+    }
+
+    return false;
+}
+
+static cJSON_bool cbor_read_value(cJSON* const item, parse_buffer* const input_buffer)
+{
+    unsigned char major = 0;
+    unsigned char info = 0;
+    uint64_t argument = 0;
+    double number = 0;
+
+    if (!cbor_read_head(input_buffer, &major, &info, &argument))
+    {
+        return false;
+    }
+
+    switch (major)
+    {
+        case CBOR_MAJOR_UNSIGNED:
+            number = (double)argument;
+            break;
+
+        case CBOR_MAJOR_NEGATIVE:
+            /* -1 - argument, rounded once: the subtraction in double would round a second time above 2^53 */
+            number = (argument == UINT64_MAX) ? -18446744073709551616.0 : -(double)(argument + 1);
+            break;
+
+        case CBOR_MAJOR_TEXT:
+            if (!cbor_read_string(input_buffer, major, info, argument, &item->valuestring))
+            {
+                return false;
+            }
+            set_item_type(item, cJSON_String);
+            return true;
+
+        case CBOR_MAJOR_ARRAY:
+        case CBOR_MAJOR_MAP:
+            return cbor_read_container(item, input_buffer, major, info, argument);
+
+        case CBOR_MAJOR_TAG:
+            /* tags only annotate the item that follows, except for embedded JSON */
+            if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+            {
+                set_error_reason(input_buffer, "nesting too deep");
+                return false;
+            }
+            if ((argument == CBOR_TAG_EMBEDDED_JSON) && can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] >> 5) == CBOR_MAJOR_BYTES))
+            {
+                if (!cbor_read_head(input_buffer, &major, &info, &argument) || !cbor_read_string(input_buffer, major, info, argument, &item->valuestring))
+                {
+                    return false;
+                }
+                set_item_type(item, cJSON_Raw);
+                return true;
+            }
+            {
+                cJSON_bool success = false;
+                input_buffer->depth++;
+                success = cbor_read_value(item, input_buffer);
+                input_buffer->depth--;
+                return success;
+            }
+
+        case CBOR_MAJOR_SIMPLE:
+            switch (info)
+            {
+                case 20:
+                    set_item_type(item, cJSON_False);
+                    return true;
+
+                case 21:
+                    set_item_type(item, cJSON_True);
+                    item->valueint = 1;
+                    return true;
+
+                case 22:
+                case 23: /* undefined */
+                    set_item_type(item, cJSON_NULL);
+                    return true;
+
+                case 25:
+                    number = cbor_half_to_double((unsigned int)argument);
+                    break;
+
+                case 26:
+                {
+                    uint32_t bits = (uint32_t)argument;
+                    float single = 0;
+                    memcpy(&single, &bits, sizeof(single));
+                    number = (double)single;
+                    break;
+                }
+
+                case 27:
+                    memcpy(&number, &argument, sizeof(number));
+                    break;
+
+                default:
+                    set_error_reason(input_buffer, "invalid CBOR item");
+                    return false;
+            }
+            break;
+
+        default:
+            set_error_reason(input_buffer, "byte strings have no JSON equivalent");
+            return false;
+    }
+
+    if (isnan(number))
+    {
+        /* NaN has no valueint */
+        item->valuedouble = number;
+    }
+    else
+    {
+        cJSON_SetNumberHelper(item, number);
+    }
+    set_item_type(item, cJSON_Number);
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_FromCBOR(const unsigned char* data, size_t length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, NULL }, NULL, false, NULL, NULL, NULL, 0, NULL };
+    cJSON* item = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((data == NULL) || (length == 0))
+    {
+        goto fail;
+    }
+
+    buffer.content = data;
+    buffer.length = length;
+    buffer.hooks = global_hooks;
+
+    item = cbor_container_follows(&buffer) ? new_container_item(&buffer.hooks) : cJSON_New_Item(&buffer.hooks);
+    if (item == NULL)
+    {
+        goto fail;
+    }
+    if (!cbor_read_value(item, &buffer))
+    {
+        goto fail;
+    }
+    if (buffer.offset != buffer.length)
+    {
+        set_error_reason(&buffer, "unexpected data after the item");
+        goto fail;
+    }
+
+    return item;
+
+fail:
+    if (item != NULL)
+    {
+        cJSON_Delete(item);
+    }
+    if (data != NULL)
+    {
+        set_parse_error((const char*)data, &buffer, NULL);
+    }
+
+    return NULL;
+}
+
+/* make item a lazy array or object and skip its text, it is parsed by expand_lazy when it's accessed */
+static cJSON_bool defer_container(cJSON* const item, parse_buffer* const input_buffer, const int type)
+{
+    const lazy_span* span = NULL;
+
+    if ((input_buffer->next_span >= input_buffer->lazy->span_count) || (input_buffer->lazy->spans[input_buffer->next_span].open != input_buffer->offset))
+    {
+        return false; /* the spans don't match the text */
+    }
+    span = &input_buffer->lazy->spans[input_buffer->next_span];
+
+    set_item_type(item, type | cJSON_IsReference | cJSON_Lazy);
+    item->valuestring = (char*)input_buffer->lazy;
+    item->valuedouble = (double)input_buffer->next_span;
+
+    input_buffer->offset = span->close + 1;
+    input_buffer->next_span = span->next;
+
+    return true;
+}
+
+/* Parser core - when encountering text, process appropriately. */
+static cJSON_bool parse_value(cJSON* const item, parse_buffer* const input_buffer)
+{
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false; /* no input */
+    }
+
+    /* parse the different types of values */
+    /* null */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
+    {
+        set_item_type(item, cJSON_NULL);
+        input_buffer->offset += 4;
+        return true;
+    }
+    /* false */
+    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
+    {
+        set_item_type(item, cJSON_False);
+        input_buffer->offset += 5;
+        return true;
+    }
+    /* true */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+    {
+        set_item_type(item, cJSON_True);
+        item->valueint = 1;
+        input_buffer->offset += 4;
+        return true;
+    }
+    /* string */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    {
+        return parse_string(item, input_buffer);
+    }
+    /* number */
+    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
+    {
+        return parse_number(item, input_buffer);
+    }
+    /* array */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+    {
+        return (input_buffer->lazy != NULL) ? defer_container(item, input_buffer, cJSON_Array) : parse_array(item, input_buffer);
+    }
+    /* object */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+    {
+        return (input_buffer->lazy != NULL) ? defer_container(item, input_buffer, cJSON_Object) : parse_object(item, input_buffer);
+    }
+
+    set_error_reason(input_buffer, cannot_access_at_index(input_buffer, 0) ? "unexpected end of input" : "expected a value");
+    return false;
+}
+
+/* Render a value to text. */
+static cJSON_bool print_value(const cJSON* const item, printbuffer* const output_buffer)
+{
+    unsigned char* output = NULL;
+
+    if ((item == NULL) || (output_buffer == NULL) || !expand_lazy(item))
+    {
+        return false;
+    }
+
+    switch ((item->type) & 0xFF)
+    {
+    case cJSON_NULL:
+        output = ensure(output_buffer, 5);
+        if (output == NULL)
+        {
+            return false;
+        }
+        strcpy((char*)output, "null");
+        output_buffer->offset += 4;
+        return true;
+
+    case cJSON_False:
+        output = ensure(output_buffer, 6);
+        if (output == NULL)
+        {
+            return false;
+        }
+        strcpy((char*)output, "false");
+        output_buffer->offset += 5;
+        return true;
+
+    case cJSON_True:
+        output = ensure(output_buffer, 5);
+        if (output == NULL)
+        {
+            return false;
+        }
+        strcpy((char*)output, "true");
+        output_buffer->offset += 4;
+        return true;
+
+    case cJSON_Number:
+        return print_number(item, output_buffer);
+
+    case cJSON_Raw:
+    {
+        size_t raw_length = 0;
+        if (item->valuestring == NULL)
+        {
+            return false;
+        }
+
+        raw_length = strlen(item->valuestring) + sizeof("");
+        output = ensure(output_buffer, raw_length);
         if (output == NULL)
         {
             return false;
         }
-        strcpy((char*)output, "\"\"");
+        memcpy(output, item->valuestring, raw_length);
+        output_buffer->offset += raw_length - 1;
+        return true;
+    }
+
+    case cJSON_String:
+        return print_string(item, output_buffer);
+
+    case cJSON_Array:
+        return print_array(item, output_buffer);
+
+    case cJSON_Object:
+        return print_object(item, output_buffer);
+
+    default:
+        return false;
+    }
+}
+
+/* Build an array from input text. */
+static cJSON_bool parse_array(cJSON* const item, parse_buffer* const input_buffer)
+{
+    cJSON* head = NULL; /* head of the linked list */
+    cJSON* current_item = NULL;
+    size_t count = 0;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        set_error_reason(input_buffer, "nesting too deep");
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    if (buffer_at_offset(input_buffer)[0] != '[')
+    {
+        /* not an array */
+        goto fail;
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
+    {
+        /* empty array */
+        goto success;
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        set_error_reason(input_buffer, "unexpected end of input");
+        goto fail;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    /* loop through the comma separated array elements */
+    do
+    {
+        cJSON* new_item = NULL;
+
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+
+        /* allocate next item */
+        new_item = parse_new_item(input_buffer, container_follows(input_buffer, input_buffer->offset));
+        if (new_item == NULL)
+        {
+            set_error_reason(input_buffer, "out of memory");
+            goto fail; /* allocation failure */
+        }
+
+        /* attach next item to list */
+        if (head == NULL)
+        {
+            /* start the linked list */
+            current_item = head = new_item;
+        }
+        else
+        {
+            /* add to the end and advance */
+            current_item->next = new_item;
+            new_item->prev = current_item;
+            current_item = new_item;
+        }
+        count++;
+
+        /* parse next value */
+        if (!parse_value(current_item, input_buffer))
+        {
+            goto fail; /* failed to parse value */
+        }
+        finish_parsed_item(current_item, input_buffer);
+        buffer_skip_whitespace(input_buffer);
+    } while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
+    {
+        set_error_reason(input_buffer, "expected ',' or ']'");
+        goto fail; /* expected end of array */
+    }
+
+success:
+    input_buffer->depth--;
+
+    if (head != NULL) {
+        head->prev = current_item;
+    }
+
+    set_item_type(item, cJSON_Array);
+    item->child = head;
+    index_linked_children(item, count);
+
+    input_buffer->offset++;
+
+    return true;
+
+fail:
+    /* arena memory is released by the caller in one go */
+    if ((head != NULL) && (input_buffer->arena == NULL))
+    {
+        cJSON_Delete(head);
+    }
+
+    return false;
+}
+
+/* Render an array to text */
+static cJSON_bool print_array(const cJSON* const item, printbuffer* const output_buffer)
+{
+    unsigned char* output_pointer = NULL;
+    size_t length = 0;
+    cJSON* current_element = item->child;
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    /* Compose the output array. */
+    /* opening square bracket */
+    output_pointer = ensure(output_buffer, 1);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+
+    *output_pointer = '[';
+    output_buffer->offset++;
+    output_buffer->depth++;
+
+    while (current_element != NULL)
+    {
+        if (!print_value(current_element, output_buffer))
+        {
+            return false;
+        }
+        if (current_element->next)
+        {
+            length = (size_t)(output_buffer->format ? 2 : 1);
+            output_pointer = ensure(output_buffer, length + 1);
+            if (output_pointer == NULL)
+            {
+                return false;
+            }
+            *output_pointer++ = ',';
+            if (output_buffer->format)
+            {
+                *output_pointer++ = ' ';
+            }
+            *output_pointer = '\0';
+            output_buffer->offset += length;
+        }
+        current_element = current_element->next;
+    }
 
-        return true;
+    output_pointer = ensure(output_buffer, 2);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    *output_pointer++ = ']';
+    *output_pointer = '\0';
+    output_buffer->offset++;
+    output_buffer->depth--;
+
+    return true;
+}
+
+/* Build an object from the text. */
+static cJSON_bool parse_object(cJSON* const item, parse_buffer* const input_buffer)
+{
+    cJSON* head = NULL; /* linked list head */
+    cJSON* current_item = NULL;
+    size_t count = 0;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        set_error_reason(input_buffer, "nesting too deep");
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '{'))
+    {
+        goto fail; /* not an object */
     }
 
-    /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++)
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
+    {
+        goto success; /* empty object */
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        set_error_reason(input_buffer, "unexpected end of input");
+        goto fail;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    /* loop through the comma separated array elements */
+    do
     {
-        switch (*input_pointer)
+        /* the name is parsed first, the item is allocated once it's known whether its value is an array or object */
+        cJSON name;
+        cJSON_bool owns_name = (input_buffer->keys == NULL) && !input_buffer->in_situ && (input_buffer->arena == NULL);
+        cJSON* new_item = NULL;
+
+        if (cannot_access_at_index(input_buffer, 1))
         {
-        case '\"':
-        case '\\':
-        case '\b':
-        case '\f':
-        case '\n':
-        case '\r':
-        case '\t':
-            /* one character escape sequence */
-            escape_characters++;
-            break;
-        default:
-            if (*input_pointer < 32)
+            set_error_reason(input_buffer, "unexpected end of input");
+            goto fail; /* nothing comes after the comma */
+        }
+
+        /* parse the name of the child */
+        memset(&name, '\0', sizeof(name));
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (input_buffer->keys != NULL)
+        {
+            /* decode the name into the scratch buffer of the table and keep the copy in the table */
+            input_buffer->scratch = &input_buffer->keys->scratch;
+            if (!parse_string(&name, input_buffer))
             {
-                /* UTF-16 escape sequence uXXXX */
-                escape_characters += 5;
+                input_buffer->scratch = NULL;
+                goto fail; /* failed to parse name */
             }
-            break;
+            input_buffer->scratch = NULL;
+            name.valuestring = (char*)cast_away_const(key_table_intern(input_buffer->keys, name.valuestring));
+            if (name.valuestring == NULL)
+            {
+                set_error_reason(input_buffer, "out of memory");
+                goto fail;
+            }
+        }
+        else if (!parse_string(&name, input_buffer))
+        {
+            goto fail; /* failed to parse name */
+        }
+        buffer_skip_whitespace(input_buffer);
+
+        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+        {
+            set_error_reason(input_buffer, "expected ':'");
+            if (owns_name)
+            {
+                hooks_deallocate(&input_buffer->hooks, name.valuestring);
+            }
+            goto fail; /* invalid object */
+        }
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+
+        /* allocate next item */
+        new_item = parse_new_item(input_buffer, container_follows(input_buffer, input_buffer->offset));
+        if (new_item == NULL)
+        {
+            if (owns_name)
+            {
+                hooks_deallocate(&input_buffer->hooks, name.valuestring);
+            }
+            set_error_reason(input_buffer, "out of memory");
+            goto fail; /* allocation failure */
+        }
+        new_item->string = name.valuestring;
+        if ((input_buffer->keys != NULL) || input_buffer->in_situ)
+        {
+            /* don't let cJSON_Delete free the key if parsing the value fails */
+            new_item->type |= cJSON_StringIsConst;
+        }
+
+        /* attach next item to list */
+        if (head == NULL)
+        {
+            /* start the linked list */
+            current_item = head = new_item;
+        }
+        else
+        {
+            /* add to the end and advance */
+            current_item->next = new_item;
+            new_item->prev = current_item;
+            current_item = new_item;
+        }
+        count++;
+
+        /* parse the value */
+        if (!parse_value(current_item, input_buffer))
+        {
+            goto fail; /* failed to parse value */
         }
+        finish_parsed_item(current_item, input_buffer);
+        buffer_skip_whitespace(input_buffer);
+    } while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
+    {
+        set_error_reason(input_buffer, "expected ',' or '}'");
+        goto fail; /* expected end of object */
     }
-    output_length = (size_t)(input_pointer - input) + escape_characters;
 
-    output = ensure(output_buffer, output_length + sizeof("\"\""));
-    if (output == NULL)
+success:
+    input_buffer->depth--;
+
+    if (head != NULL) {
+        head->prev = current_item;
+    }
+
+    set_item_type(item, cJSON_Object);
+    item->child = head;
+    index_linked_children(item, count);
+
+    input_buffer->offset++;
+    return true;
+
+fail:
+    /* arena memory is released by the caller in one go */
+    if ((head != NULL) && (input_buffer->arena == NULL))
+    {
+        cJSON_Delete(head);
+    }
+
+    return false;
+}
+
+/* Render an object to text. */
+static cJSON_bool print_object(const cJSON* const item, printbuffer* const output_buffer)
+{
+    unsigned char* output_pointer = NULL;
+    size_t length = 0;
+    cJSON* current_item = item->child;
+
+    if (output_buffer == NULL)
     {
         return false;
     }
 
-    /* no characters have to be escaped */
-    if (escape_characters == 0)
+    /* Compose the output: */
+    length = (size_t)(output_buffer->format ? 2 : 1); /* fmt: {\n */
+    output_pointer = ensure(output_buffer, length + 1);
+    if (output_pointer == NULL)
     {
-        output[0] = '\"';
-        memcpy(output + 1, input, output_length);
-        output[output_length + 1] = '\"';
-        output[output_length + 2] = '\0';
+        return false;
+    }
 
-        return true;
+    *output_pointer++ = '{';
+    output_buffer->depth++;
+    if (output_buffer->format)
+    {
+        *output_pointer++ = '\n';
+    }
+    output_buffer->offset += length;
+
+    while (current_item)
+    {
+        if (output_buffer->format)
+        {
+            size_t i;
+            output_pointer = ensure(output_buffer, output_buffer->depth);
+            if (output_pointer == NULL)
+            {
+                return false;
+            }
+            for (i = 0; i < output_buffer->depth; i++)
+            {
+                *output_pointer++ = '\t';
+            }
+            output_buffer->offset += output_buffer->depth;
+        }
+
+        /* print key */
+        if (!print_string_ptr((unsigned char*)current_item->string, output_buffer))
+        {
+            return false;
+        }
+
+        length = (size_t)(output_buffer->format ? 2 : 1);
+        output_pointer = ensure(output_buffer, length);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        *output_pointer++ = ':';
+        if (output_buffer->format)
+        {
+            *output_pointer++ = '\t';
+        }
+        output_buffer->offset += length;
+
+        /* print value */
+        if (!print_value(current_item, output_buffer))
+        {
+            return false;
+        }
+
+        /* print comma if not last */
+        length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(current_item->next ? 1 : 0));
+        output_pointer = ensure(output_buffer, length + 1);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        if (current_item->next)
+        {
+            *output_pointer++ = ',';
+        }
+
+        if (output_buffer->format)
+        {
+            *output_pointer++ = '\n';
+        }
+        *output_pointer = '\0';
+        output_buffer->offset += length;
+
+        current_item = current_item->next;
+    }
+
+    output_pointer = ensure(output_buffer, output_buffer->format ? (output_buffer->depth + 1) : 2);
+    if (output_pointer == NULL)
+    {
+        return false;
     }
-
-    output[0] = '\"';
-    output_pointer = output + 1;
-    /* copy the string */
-    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    if (output_buffer->format)
     {
-        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
-        {
-            /* normal character, copy */
-            *output_pointer = *input_pointer;
-        }
-        else
+        size_t i;
+        for (i = 0; i < (output_buffer->depth - 1); i++)
         {
-            /* character needs to be escaped */
-            *output_pointer++ = '\\';
-            switch (*input_pointer)
-            {
-            case '\\':
-                *output_pointer = '\\';
-                break;
-            case '\"':
-                *output_pointer = '\"';
-                break;
-            case '\b':
-                *output_pointer = 'b';
-                break;
-            case '\f':
-                *output_pointer = 'f';
-                break;
-            case '\n':
-                *output_pointer = 'n';
-                break;
-            case '\r':
-                *output_pointer = 'r';
-                break;
-            case '\t':
-                *output_pointer = 't';
-                break;
-            default:
-                /* escape and print as unicode codepoint */
-                sprintf((char*)output_pointer, "u%04x", *input_pointer);
-                output_pointer += 4;
-                break;
-            }
+            *output_pointer++ = '\t';
         }
+        output_buffer->offset += output_buffer->depth - 1;
     }
-    output[output_length + 1] = '\"';
-    output[output_length + 2] = '\0';
+    *output_pointer++ = '}';
+    *output_pointer = '\0';
+    output_buffer->offset++;
+    output_buffer->depth--;
 
     return true;
 }
 
-/* Invoke print_string_ptr (which is useful) on an item. */
-static cJSON_bool print_string(const cJSON* const item, printbuffer* const p)
+/* Get Array size/item / object item. */
+CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON* array)
 {
-    return print_string_ptr((unsigned char*)item->valuestring, p);
-}
-
-/* Predeclare these prototypes. */
-static cJSON_bool parse_value(cJSON* const item, parse_buffer* const input_buffer);
-static cJSON_bool print_value(const cJSON* const item, printbuffer* const output_buffer);
-static cJSON_bool parse_array(cJSON* const item, parse_buffer* const input_buffer);
-static cJSON_bool print_array(const cJSON* const item, printbuffer* const output_buffer);
-static cJSON_bool parse_object(cJSON* const item, parse_buffer* const input_buffer);
-static cJSON_bool print_object(const cJSON* const item, printbuffer* const output_buffer);
+    const struct cJSON_Index* index = NULL;
+    cJSON* child = NULL;
+    size_t size = 0;
 
-/* Utility to jump whitespace and cr/lf */
-static parse_buffer* buffer_skip_whitespace(parse_buffer* const buffer)
-{
-    if ((buffer == NULL) || (buffer->content == NULL))
+    if ((array == NULL) || !expand_lazy(array))
     {
-        return NULL;
+        return 0;
     }
 
-    if (cannot_access_at_index(buffer, 0))
+    index = item_index(array);
+    if (index != NULL)
     {
-        return buffer;
+        return (int)index->count;
     }
 
-    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
-    {
-        buffer->offset++;
-    }
+    child = array->child;
 
-    if (buffer->offset == buffer->length)
+    while (child != NULL)
     {
-        buffer->offset--;
+        size++;
+        child = child->next;
     }
 
-    return buffer;
+    /* FIXME: Can overflow here. Cannot be fixed without breaking the API */
+
+    return (int)size;
 }
 
-/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
-static parse_buffer* skip_utf8_bom(parse_buffer* const buffer)
+/* Copy-on-write.
+ * A shared item starts out with the children of the item it was copied from. The first time they are looked up or
+ * the list is changed it gets a list of its own, made of shared copies of those children, so a copy only pays for
+ * the containers on the paths that are actually used. */
+static cJSON* share_item(const cJSON* const item, const internal_hooks* const hooks)
 {
-    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    cJSON* shared = (item->type & (cJSON_Array | cJSON_Object)) ? new_container_item(hooks) : cJSON_New_Item(hooks);
+    if (shared == NULL)
     {
         return NULL;
     }
 
-    if (can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
-    {
-        buffer->offset += 3;
-    }
+    set_item_type(shared, (item->type & ~(cJSON_InArena | cJSON_ArenaRoot | cJSON_InSitu | cJSON_HasAllocator | cJSON_Indexable | cJSON_LazyRoot)) | cJSON_IsReference | cJSON_StringIsConst | cJSON_Shared);
+    shared->child = item->child;
+    shared->valueint = item->valueint;
+    shared->valuedouble = item->valuedouble;
+    shared->valuestring = item->valuestring;
+    shared->string = item->string;
 
-    return buffer;
+    return shared;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_ParseWithOpts(const char* value, const char** return_parse_end, cJSON_bool require_null_terminated)
+/* give a shared array or object children of its own, fails if there is not enough memory */
+static cJSON_bool unshare_children(cJSON* const item)
 {
-    size_t buffer_length;
+    internal_hooks hooks;
+    cJSON* source = NULL;
+    cJSON* first = NULL;
+    cJSON* last = NULL;
+    cJSON* copy = NULL;
+    size_t count = 0;
 
-    if (NULL == value)
+    if (!(item->type & cJSON_Shared) || !(item->type & (cJSON_Array | cJSON_Object)))
     {
-        return NULL;
+        return true;
     }
 
-    /* Adding null character size due to require_null_terminated. */
-    buffer_length = strlen(value) + sizeof("");
+    hooks = item_hooks(item);
+    for (source = item->child; source != NULL; source = source->next)
+    {
+        copy = share_item(source, &hooks);
+        if (copy == NULL)
+        {
+            cJSON_Delete(first);
+            return false;
+        }
 
-    return cJSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+        if (first == NULL)
+        {
+            first = copy;
+        }
+        else
+        {
+            last->next = copy;
+            copy->prev = last;
+        }
+        last = copy;
+        count++;
+    }
+    if (first != NULL)
+    {
+        first->prev = last;
+    }
+
+    item->child = first;
+    item->type &= ~(cJSON_IsReference | cJSON_Shared);
+    index_linked_children(item, count);
+
+    return true;
 }
 
-/* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON*) cJSON_ParseWithLengthOpts(const char* value, size_t buffer_length, const char** return_parse_end, cJSON_bool require_null_terminated)
+static cJSON* get_array_item(const cJSON* array, size_t index)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
-    cJSON* item = NULL;
-
-    /* reset error position */
-    global_error.json = NULL;
-    global_error.position = 0;
+    const struct cJSON_Index* children = NULL;
+    cJSON* current_child = NULL;
 
-    if (value == NULL || 0 == buffer_length)
+    if ((array == NULL) || !expand_lazy(array) || !unshare_children((cJSON*)cast_away_const(array)))
     {
-        goto fail;
+        return NULL;
     }
 
-    buffer.content = (const unsigned char*)value;
-    buffer.length = buffer_length;
-    buffer.offset = 0;
-    buffer.hooks = global_hooks;
-
-    item = cJSON_New_Item(&global_hooks);
-    if (item == NULL) /* memory fail */
+    children = item_index(array);
+    if (children != NULL)
     {
-        goto fail;
+        return (index < children->count) ? children->items[index] : NULL;
     }
 
-    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer))))
+    current_child = array->child;
+    while ((current_child != NULL) && (index > 0))
     {
-        /* parse failure. ep is set. */
-        goto fail;
+        index--;
+        current_child = current_child->next;
     }
 
-    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
-    if (require_null_terminated)
-    {
-        buffer_skip_whitespace(&buffer);
-        if ((buffer.offset >= buffer.length) || buffer_at_offset(&buffer)[0] != '\0')
-        {
-            goto fail;
-        }
-    }
-    if (return_parse_end)
+    return current_child;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_GetArrayItem(const cJSON* array, int index)
+{
+    if (index < 0)
     {
-        *return_parse_end = (const char*)buffer_at_offset(&buffer);
+        return NULL;
     }
 
-    return item;
+    return get_array_item(array, (size_t)index);
+}
 
-fail:
-    if (item != NULL)
+/* name_hash is hash_key(name) if the caller knows it, otherwise 0 */
+static cJSON* find_object_item(const cJSON* const object, const char* const name, const size_t name_hash, const cJSON_bool case_sensitive)
+{
+    const struct cJSON_Index* index = NULL;
+    cJSON* current_element = NULL;
+
+    if ((object == NULL) || (name == NULL) || !expand_lazy(object) || !unshare_children((cJSON*)cast_away_const(object)))
     {
-        cJSON_Delete(item);
+        return NULL;
     }
 
-    if (value != NULL)
+    index = item_index(object);
+    if ((index != NULL) && (index->slot_count > 0))
     {
-        error local_error;
-        local_error.json = (const unsigned char*)value;
-        local_error.position = 0;
+        return index_find(index, name, name_hash, case_sensitive);
+    }
 
-        if (buffer.offset < buffer.length)
-        {
-            local_error.position = buffer.offset;
-        }
-        else if (buffer.length > 0)
+    current_element = object->child;
+    if (case_sensitive)
+    {
+        /* names from the key table of the document are found by their address */
+        while ((current_element != NULL) && (current_element->string != NULL) && (name != current_element->string) && (strcmp(name, current_element->string) != 0))
         {
-            local_error.position = buffer.length - 1;
+            current_element = current_element->next;
         }
-
-        if (return_parse_end != NULL)
+    }
+    else
+    {
+        while ((current_element != NULL) && (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)(current_element->string)) != 0))
         {
-            *return_parse_end = (const char*)local_error.json + local_error.position;
+            current_element = current_element->next;
         }
+    }
 
-        global_error = local_error;
+    if ((current_element == NULL) || (current_element->string == NULL)) {
+        return NULL;
     }
 
-    return NULL;
+    return current_element;
 }
 
-/* Default options for cJSON_Parse */
-CJSON_PUBLIC(cJSON*) cJSON_Parse(const char* value)
+static cJSON* get_object_item(const cJSON* const object, const char* const name, const cJSON_bool case_sensitive)
 {
-    return cJSON_ParseWithOpts(value, 0, 0);
+    return find_object_item(object, name, 0, case_sensitive);
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_ParseWithLength(const char* value, size_t buffer_length)
+CJSON_PUBLIC(cJSON*) cJSON_GetObjectItem(const cJSON* const object, const char* const string)
 {
-    return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+    return get_object_item(object, string, false);
 }
 
-#define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
+CJSON_PUBLIC(cJSON*) cJSON_GetObjectItemCaseSensitive(const cJSON* const object, const char* const string)
+{
+    return get_object_item(object, string, true);
+}
 
-static unsigned char* print(const cJSON* const item, cJSON_bool format, const internal_hooks* const hooks)
+CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON* object, const char* string)
 {
-    static const size_t default_buffer_size = 256;
-    printbuffer buffer[1];
-    unsigned char* printed = NULL;
+    return cJSON_GetObjectItem(object, string) ? 1 : 0;
+}
 
-    memset(buffer, 0, sizeof(buffer));
+/* JSON Pointer (RFC 6901) and path queries.
+ * A path is compiled into an array of steps whose keys are decoded and hashed once. Evaluating it only follows the steps
+ * with the lookup functions (so the indexes of large arrays and objects are used), a wildcard step branches into every
+ * child; nothing is allocated for the evaluation itself. */
+typedef struct
+{
+    const char* key; /* decoded, into the block of the path */
+    size_t hash; /* hash_key(key) */
+    size_t index; /* valid if is_index */
+    cJSON_bool is_index; /* key is an array index: 0 or digits without a leading zero */
+    cJSON_bool wildcard;
+} path_step;
+
+struct cJSON_Path
+{
+    path_step* steps; /* followed by the keys in the same block */
+    size_t step_count;
+    internal_hooks hooks;
+};
 
-    /* create buffer */
-    buffer->buffer = (unsigned char*)hooks->allocate(default_buffer_size);
-    buffer->length = default_buffer_size;
-    buffer->format = format;
-    buffer->hooks = *hooks;
-    if (buffer->buffer == NULL)
+/* compile pointer, a "*" step matches every child if wildcards are allowed and the key "*" otherwise */
+static cJSON_Path* compile_path(const char* const pointer, const cJSON_bool wildcards, const internal_hooks* const hooks)
+{
+    cJSON_Path* path = NULL;
+    const char* position = NULL;
+    char* key = NULL;
+    size_t step_count = 0;
+    size_t length = 0;
+    size_t i = 0;
+
+    if ((pointer == NULL) || ((pointer[0] != '\0') && (pointer[0] != '/')))
     {
-        goto fail;
+        return NULL;
     }
 
-    /* print the value */
-    if (!print_value(item, buffer))
+    length = strlen(pointer);
+    for (position = pointer; *position != '\0'; position++)
     {
-        goto fail;
+        if (*position == '/')
+        {
+            step_count++;
+        }
+        else if ((*position == '~') && (position[1] != '0') && (position[1] != '1'))
+        {
+            return NULL; /* the only escapes are ~0 and ~1 */
+        }
     }
-    update_offset(buffer);
 
-    /* check if reallocate is available */
-    if (hooks->reallocate != NULL)
+    /* the decoded keys are never longer than the pointer, and each of them ends with a '\0' instead of starting with a '/' */
+    if (step_count > ((((size_t)-1) - sizeof(cJSON_Path) - length - 1) / sizeof(path_step)))
     {
-        printed = (unsigned char*)hooks->reallocate(buffer->buffer, buffer->offset + 1);
-        if (printed == NULL) {
-            goto fail;
-        }
-        buffer->buffer = NULL;
+        return NULL;
     }
-    else /* otherwise copy the JSON over to a new buffer */
+    path = (cJSON_Path*)hooks_allocate(hooks, sizeof(cJSON_Path) + (step_count * sizeof(path_step)) + length + 1);
+    if (path == NULL)
     {
-        printed = (unsigned char*)hooks->allocate(buffer->offset + 1);
-        if (printed == NULL)
+        return NULL;
+    }
+    path->steps = (path_step*)(path + 1);
+    path->step_count = step_count;
+    path->hooks = *hooks;
+    key = (char*)(path->steps + step_count);
+
+    position = pointer;
+    for (i = 0; i < step_count; i++)
+    {
+        path_step* step = &path->steps[i];
+        const char* digit = NULL;
+
+        step->key = key;
+        for (position++; (*position != '\0') && (*position != '/'); position++)
         {
-            goto fail;
+            if (*position == '~')
+            {
+                position++;
+                *key++ = (*position == '0') ? '~' : '/';
+            }
+            else
+            {
+                *key++ = *position;
+            }
         }
-        memcpy(printed, buffer->buffer, cjson_min(buffer->length, buffer->offset + 1));
-        printed[buffer->offset] = '\0'; /* just to be sure */
+        *key++ = '\0';
 
-        /* free the buffer */
-        hooks->deallocate(buffer->buffer);
-        buffer->buffer = NULL;
+        step->hash = hash_key((const unsigned char*)step->key);
+        step->wildcard = wildcards && (strcmp(step->key, "*") == 0);
+        step->index = 0;
+        step->is_index = (step->key[0] != '\0') && ((step->key[0] != '0') || (step->key[1] == '\0'));
+        for (digit = step->key; step->is_index && (*digit != '\0'); digit++)
+        {
+            if ((*digit < '0') || (*digit > '9') || (step->index > ((((size_t)-1) - 9) / 10)))
+            {
+                step->is_index = false;
+            }
+            else
+            {
+                step->index = (step->index * 10) + (size_t)(*digit - '0');
+            }
+        }
     }
 
-    return printed;
+    return path;
+}
 
-fail:
-    if (buffer->buffer != NULL)
+/* the child of item that a step leads to */
+static cJSON* follow_path_step(const cJSON* const item, const path_step* const step)
+{
+    if (cJSON_IsArray(item))
+    {
+        return step->is_index ? get_array_item(item, step->index) : NULL;
+    }
+    if (cJSON_IsObject(item))
+    {
+        return find_object_item(item, step->key, step->hash, true);
+    }
+
+    return NULL;
+}
+
+/* report the matches of the steps from step_number on, returns false once callback did */
+static cJSON_bool visit_path(const cJSON_Path* const path, size_t step_number, cJSON* item, const cJSON_PathCallback callback, void* const context, size_t* const matches)
+{
+    cJSON* child = NULL;
+
+    for (; (item != NULL) && (step_number < path->step_count); step_number++)
     {
-        hooks->deallocate(buffer->buffer);
-        buffer->buffer = NULL;
+        if (path->steps[step_number].wildcard)
+        {
+            if (!(item->type & (cJSON_Array | cJSON_Object)) || !expand_lazy(item) || !unshare_children(item))
+            {
+                return true;
+            }
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                if (!visit_path(path, step_number + 1, child, callback, context, matches))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        item = follow_path_step(item, &path->steps[step_number]);
     }
 
-    if (printed != NULL)
+    if (item == NULL)
     {
-        hooks->deallocate(printed);
-        printed = NULL;
+        return true;
     }
+    (*matches)++;
 
-    return NULL;
+    return (callback == NULL) || callback(item, context);
 }
 
-/* Render a cJSON item/entity/structure to text. */
-CJSON_PUBLIC(char*) cJSON_Print(const cJSON* item)
+/* stops at the first match */
+static cJSON_bool take_first_match(cJSON* item, void* context)
 {
-    return (char*)print(item, true, &global_hooks);
+    *(cJSON**)context = item;
+
+    return false;
 }
 
-CJSON_PUBLIC(char*) cJSON_PrintUnformatted(const cJSON* item)
+CJSON_PUBLIC(cJSON_Path*) cJSON_PathCompile(const char* path)
 {
-    return (char*)print(item, false, &global_hooks);
+    return compile_path(path, true, &global_hooks);
 }
 
-CJSON_PUBLIC(char*) cJSON_PrintBuffered(const cJSON* item, int prebuffer, cJSON_bool fmt)
+CJSON_PUBLIC(void) cJSON_PathDelete(cJSON_Path* path)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
-
-    if (prebuffer < 0)
-    {
-        return NULL;
-    }
-
-    p.buffer = (unsigned char*)global_hooks.allocate((size_t)prebuffer);
-    if (!p.buffer)
+    if (path != NULL)
     {
-        return NULL;
+        internal_hooks hooks = path->hooks;
+        hooks_deallocate(&hooks, path);
     }
+}
 
-    p.length = (size_t)prebuffer;
-    p.offset = 0;
-    p.noalloc = false;
-    p.format = fmt;
-    p.hooks = global_hooks;
+CJSON_PUBLIC(cJSON*) cJSON_PathGet(const cJSON_Path* path, const cJSON* root)
+{
+    cJSON* match = NULL;
+    size_t matches = 0;
 
-    if (!print_value(item, &p))
+    if ((path == NULL) || (root == NULL))
     {
-        global_hooks.deallocate(p.buffer);
-        p.buffer = NULL;
         return NULL;
     }
 
-    return (char*)p.buffer;
+    visit_path(path, 0, (cJSON*)cast_away_const(root), take_first_match, &match, &matches);
+
+    return match;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON* item, char* buffer, const int length, const cJSON_bool format)
+CJSON_PUBLIC(size_t) cJSON_PathForEach(const cJSON_Path* path, const cJSON* root, cJSON_PathCallback callback, void* context)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    size_t matches = 0;
 
-    if ((length < 0) || (buffer == NULL))
+    if ((path == NULL) || (root == NULL))
     {
-        return false;
+        return 0;
     }
 
-    p.buffer = (unsigned char*)buffer;
-    p.length = (size_t)length;
-    p.offset = 0;
-    p.noalloc = true;
-    p.format = format;
-    p.hooks = global_hooks;
+    visit_path(path, 0, (cJSON*)cast_away_const(root), callback, context, &matches);
 
-    return print_value(item, &p);
+    return matches;
 }
 
-/* Parser core - when encountering text, process appropriately. */
-static cJSON_bool parse_value(cJSON* const item, parse_buffer* const input_buffer)
+CJSON_PUBLIC(cJSON*) cJSON_GetPointer(const cJSON* root, const char* pointer)
 {
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
-    {
-        return false; /* no input */
-    }
+    cJSON_Path* path = NULL;
+    cJSON* match = NULL;
 
-    /* parse the different types of values */
-    /* null */
-    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
+    if (root == NULL)
     {
-        item->type = cJSON_NULL;
-        input_buffer->offset += 4;
-        return true;
-    }
-    /* false */
-    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
-    {
-        item->type = cJSON_False;
-        input_buffer->offset += 5;
-        return true;
-    }
-    /* true */
-    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
-    {
-        item->type = cJSON_True;
-        item->valueint = 1;
-        input_buffer->offset += 4;
-        return true;
-    }
-    /* string */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
-    {
-        return parse_string(item, input_buffer);
-    }
-    /* number */
-    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
-    {
-        return parse_number(item, input_buffer);
-    }
-    /* array */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
-    {
-        return parse_array(item, input_buffer);
-    }
-    /* object */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
-    {
-        return parse_object(item, input_buffer);
+        return NULL;
     }
 
-    return false;
+    path = compile_path(pointer, false, &global_hooks);
+    match = cJSON_PathGet(path, root);
+    cJSON_PathDelete(path);
+
+    return match;
 }
 
-/* Render a value to text. */
-static cJSON_bool print_value(const cJSON* const item, printbuffer* const output_buffer)
+
+/* Schema validation.
+ * cJSON_SchemaCompile turns a JSON Schema (a subset of it) into a flat program: an array of nodes that refer to each other
+ * by their number, and the declared properties of all objects in one array, each node owning a range of it. Property keys
+ * are copied and hashed once. Validating walks the document and the nodes together, so every item is checked once. */
+
+/* node 0 accepts anything, it stands for "no schema" */
+typedef struct
 {
-    unsigned char* output = NULL;
+    int types; /* the item types that are allowed, 0 for all */
+    cJSON_bool integer; /* numbers have to be whole */
+    cJSON_bool has_minimum;
+    cJSON_bool has_maximum;
+    double minimum;
+    double maximum;
+    size_t min_length; /* of strings, in code points */
+    size_t max_length;
+    size_t min_items;
+    size_t max_items;
+    size_t items; /* node of the elements of an array */
+    size_t first_property;
+    size_t property_count;
+    cJSON_bool closed; /* additionalProperties is false */
+    size_t additional; /* node of the members that aren't declared */
+} schema_node;
 
-    if ((item == NULL) || (output_buffer == NULL))
-    {
-        return false;
-    }
+typedef struct
+{
+    size_t key; /* offset into the keys of the schema */
+    size_t hash; /* hash_key(key) */
+    size_t node;
+    cJSON_bool required;
+} schema_property;
 
-    switch ((item->type) & 0xFF)
-    {
-    case cJSON_NULL:
-        output = ensure(output_buffer, 5);
-        if (output == NULL)
-        {
-            return false;
-        }
-        strcpy((char*)output, "null");
-        return true;
+struct cJSON_Schema
+{
+    schema_node* nodes;
+    size_t node_count;
+    schema_property* properties;
+    size_t property_count;
+    char* keys;
+    size_t keys_length;
+    size_t root;
+    internal_hooks hooks;
+};
 
-    case cJSON_False:
-        output = ensure(output_buffer, 6);
-        if (output == NULL)
-        {
-            return false;
-        }
-        strcpy((char*)output, "false");
-        return true;
+typedef struct
+{
+    cJSON_Schema* schema;
+    size_t node_capacity;
+    size_t property_capacity;
+    size_t keys_capacity;
+    size_t depth;
+} schema_compiler;
+
+/* where an item is in the document, a chain up to the root on the stack of the validation */
+typedef struct schema_location
+{
+    const struct schema_location* parent;
+    const char* key; /* NULL for an array element */
+    size_t index;
+} schema_location;
 
-    case cJSON_True:
-        output = ensure(output_buffer, 5);
-        if (output == NULL)
-        {
-            return false;
-        }
-        strcpy((char*)output, "true");
-        return true;
+typedef struct
+{
+    const cJSON_Schema* schema;
+    cJSON_SchemaErrorCallback callback;
+    void* context;
+    size_t error_count;
+} schema_validation;
 
-    case cJSON_Number:
-        return print_number(item, output_buffer);
+static cJSON_bool grow_schema_array(const internal_hooks* const hooks, void** const array, const size_t element_size, const size_t count, size_t* const capacity, const size_t needed)
+{
+    size_t new_capacity = (*capacity > 0) ? *capacity : 16;
+    void* new_array = NULL;
 
-    case cJSON_Raw:
+    if (needed <= *capacity)
     {
-        size_t raw_length = 0;
-        if (item->valuestring == NULL)
-        {
-            return false;
-        }
-
-        raw_length = strlen(item->valuestring) + sizeof("");
-        output = ensure(output_buffer, raw_length);
-        if (output == NULL)
+        return true;
+    }
+    while (new_capacity < needed)
+    {
+        if (new_capacity > (((size_t)-1) / 2))
         {
             return false;
         }
-        memcpy(output, item->valuestring, raw_length);
-        return true;
+        new_capacity *= 2;
     }
 
-    case cJSON_String:
-        return print_string(item, output_buffer);
-
-    case cJSON_Array:
-        return print_array(item, output_buffer);
+    new_array = resize_array(hooks, *array, element_size, count, new_capacity);
+    if (new_array == NULL)
+    {
+        return false;
+    }
+    *array = new_array;
+    *capacity = new_capacity;
 
-    case cJSON_Object:
-        return print_object(item, output_buffer);
+    return true;
+}
 
-    default:
+static cJSON_bool read_schema_count(const cJSON* const keyword, size_t* const count)
+{
+    if (!cJSON_IsNumber(keyword) || (keyword->valuedouble < 0) || (keyword->valuedouble != floor(keyword->valuedouble)))
+    {
         return false;
     }
+    *count = (keyword->valuedouble >= (double)(((size_t)-1) / 2)) ? ((size_t)-1) : (size_t)keyword->valuedouble;
+
+    return true;
 }
 
-/* Build an array from input text. */
-static cJSON_bool parse_array(cJSON* const item, parse_buffer* const input_buffer)
+static int schema_type_bits(const cJSON* const name, cJSON_bool* const integer)
 {
-    cJSON* head = NULL; /* head of the linked list */
-    cJSON* current_item = NULL;
+    const char* type = cJSON_GetStringValue(name);
 
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    if (type == NULL)
     {
-        return false; /* to deeply nested */
+        return 0;
     }
-    input_buffer->depth++;
-
-    if (buffer_at_offset(input_buffer)[0] != '[')
+    if (strcmp(type, "null") == 0)
     {
-        /* not an array */
-        goto fail;
+        return cJSON_NULL;
     }
-
-    input_buffer->offset++;
-    buffer_skip_whitespace(input_buffer);
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
+    if (strcmp(type, "boolean") == 0)
     {
-        /* empty array */
-        goto success;
+        return cJSON_True | cJSON_False;
     }
-
-    /* check if we skipped to the end of the buffer */
-    if (cannot_access_at_index(input_buffer, 0))
+    if (strcmp(type, "number") == 0)
     {
-        input_buffer->offset--;
-        goto fail;
+        return cJSON_Number;
     }
-
-    /* step back to character in front of the first element */
-    input_buffer->offset--;
-    /* loop through the comma separated array elements */
-    do
+    if (strcmp(type, "integer") == 0)
     {
-        /* allocate next item */
-        cJSON* new_item = cJSON_New_Item(&(input_buffer->hooks));
-        if (new_item == NULL)
-        {
-            goto fail; /* allocation failure */
-        }
-
-        /* attach next item to list */
-        if (head == NULL)
-        {
-            /* start the linked list */
-            current_item = head = new_item;
-        }
-        else
-        {
-            /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
-            current_item = new_item;
-        }
-
-        /* parse next value */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_value(current_item, input_buffer))
-        {
-            goto fail; /* failed to parse value */
-        }
-        buffer_skip_whitespace(input_buffer);
-    } while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
-
-    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
+        *integer = true;
+        return cJSON_Number;
+    }
+    if (strcmp(type, "string") == 0)
     {
-        goto fail; /* expected end of array */
+        return cJSON_String;
+    }
+    if (strcmp(type, "array") == 0)
+    {
+        return cJSON_Array;
+    }
+    if (strcmp(type, "object") == 0)
+    {
+        return cJSON_Object;
     }
 
-success:
-    input_buffer->depth--;
+    return 0;
+}
 
-    if (head != NULL) {
-        head->prev = current_item;
+/* find key among the count properties of a node, which start at first */
+static schema_property* find_schema_property(const cJSON_Schema* const schema, const size_t first, const size_t count, const char* const key)
+{
+    size_t hash = hash_key((const unsigned char*)key);
+    size_t i = 0;
+
+    for (i = first; i < (first + count); i++)
+    {
+        if ((schema->properties[i].hash == hash) && (strcmp(schema->keys + schema->properties[i].key, key) == 0))
+        {
+            return &schema->properties[i];
+        }
     }
 
-    item->type = cJSON_Array;
-    item->child = head;
-
-    input_buffer->offset++;
+    return NULL;
+}
 
-    return true;
+static cJSON_bool add_schema_property(schema_compiler* const compiler, const char* const key)
+{
+    cJSON_Schema* schema = compiler->schema;
+    size_t length = strlen(key) + 1;
+    schema_property* property = NULL;
 
-fail:
-    if (head != NULL)
+    if (!grow_schema_array(&schema->hooks, (void**)&schema->keys, 1, schema->keys_length, &compiler->keys_capacity, schema->keys_length + length)
+        || !grow_schema_array(&schema->hooks, (void**)&schema->properties, sizeof(schema_property), schema->property_count, &compiler->property_capacity, schema->property_count + 1))
     {
-        cJSON_Delete(head);
+        return false;
     }
 
-    return false;
+    property = &schema->properties[schema->property_count++];
+    property->key = schema->keys_length;
+    property->hash = hash_key((const unsigned char*)key);
+    property->node = 0;
+    property->required = false;
+    memcpy(schema->keys + schema->keys_length, key, length);
+    schema->keys_length += length;
+
+    return true;
 }
 
-/* Render an array to text */
-static cJSON_bool print_array(const cJSON* const item, printbuffer* const output_buffer)
+/* compile a schema into a new node and store its number, fails if the schema isn't supported */
+static cJSON_bool compile_schema_node(schema_compiler* const compiler, const cJSON* const source, size_t* const number)
 {
-    unsigned char* output_pointer = NULL;
-    size_t length = 0;
-    cJSON* current_element = item->child;
+    cJSON_Schema* schema = compiler->schema;
+    schema_node node;
+    const cJSON* keyword = NULL;
+    const cJSON* member = NULL;
 
-    if (output_buffer == NULL)
+    if (cJSON_IsTrue(source))
     {
-        return false;
+        /* the schema that allows everything */
+        *number = 0;
+        return true;
     }
-
-    /* Compose the output array. */
-    /* opening square bracket */
-    output_pointer = ensure(output_buffer, 1);
-    if (output_pointer == NULL)
+    if (!cJSON_IsObject(source) || (compiler->depth >= CJSON_NESTING_LIMIT))
     {
         return false;
     }
 
-    *output_pointer = '[';
-    output_buffer->offset++;
-    output_buffer->depth++;
+    memset(&node, '\0', sizeof(node));
+    node.max_length = (size_t)-1;
+    node.max_items = (size_t)-1;
 
-    while (current_element != NULL)
+    keyword = cJSON_GetObjectItemCaseSensitive(source, "type");
+    if (cJSON_IsString(keyword))
     {
-        if (!print_value(current_element, output_buffer))
+        node.types = schema_type_bits(keyword, &node.integer);
+        if (node.types == 0)
         {
             return false;
         }
-        update_offset(output_buffer);
-        if (current_element->next)
+    }
+    else if (cJSON_IsArray(keyword))
+    {
+        cJSON_bool integer = false;
+        cJSON_bool number_allowed = false;
+        for (member = keyword->child; member != NULL; member = member->next)
         {
-            length = (size_t)(output_buffer->format ? 2 : 1);
-            output_pointer = ensure(output_buffer, length + 1);
-            if (output_pointer == NULL)
+            cJSON_bool member_integer = false;
+            int bits = schema_type_bits(member, &member_integer);
+            if (bits == 0)
             {
                 return false;
             }
-            *output_pointer++ = ',';
-            if (output_buffer->format)
-            {
-                *output_pointer++ = ' ';
-            }
-            *output_pointer = '\0';
-            output_buffer->offset += length;
+            integer = integer || member_integer;
+            number_allowed = number_allowed || ((bits == cJSON_Number) && !member_integer);
+            node.types |= bits;
         }
-        current_element = current_element->next;
+        node.integer = integer && !number_allowed;
     }
-
-    output_pointer = ensure(output_buffer, 2);
-    if (output_pointer == NULL)
+    else if (keyword != NULL)
     {
         return false;
     }
-    *output_pointer++ = ']';
-    *output_pointer = '\0';
-    output_buffer->depth--;
-
-    return true;
-}
-
-/* Build an object from the text. */
-static cJSON_bool parse_object(cJSON* const item, parse_buffer* const input_buffer)
-{
-    cJSON* head = NULL; /* linked list head */
-    cJSON* current_item = NULL;
 
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    if (((keyword = cJSON_GetObjectItemCaseSensitive(source, "minimum")) != NULL))
     {
-        return false; /* to deeply nested */
+        if (!cJSON_IsNumber(keyword))
+        {
+            return false;
+        }
+        node.has_minimum = true;
+        node.minimum = keyword->valuedouble;
     }
-    input_buffer->depth++;
-
-    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '{'))
+    if (((keyword = cJSON_GetObjectItemCaseSensitive(source, "maximum")) != NULL))
     {
-        goto fail; /* not an object */
+        if (!cJSON_IsNumber(keyword))
+        {
+            return false;
+        }
+        node.has_maximum = true;
+        node.maximum = keyword->valuedouble;
     }
-
-    input_buffer->offset++;
-    buffer_skip_whitespace(input_buffer);
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
+    if ((((keyword = cJSON_GetObjectItemCaseSensitive(source, "minLength")) != NULL) && !read_schema_count(keyword, &node.min_length))
+        || (((keyword = cJSON_GetObjectItemCaseSensitive(source, "maxLength")) != NULL) && !read_schema_count(keyword, &node.max_length))
+        || (((keyword = cJSON_GetObjectItemCaseSensitive(source, "minItems")) != NULL) && !read_schema_count(keyword, &node.min_items))
+        || (((keyword = cJSON_GetObjectItemCaseSensitive(source, "maxItems")) != NULL) && !read_schema_count(keyword, &node.max_items)))
     {
-        goto success; /* empty object */
+        return false;
     }
 
-    /* check if we skipped to the end of the buffer */
-    if (cannot_access_at_index(input_buffer, 0))
+    /* reserve the node, the nodes it refers to come after it */
+    if (!grow_schema_array(&schema->hooks, (void**)&schema->nodes, sizeof(schema_node), schema->node_count, &compiler->node_capacity, schema->node_count + 1))
     {
-        input_buffer->offset--;
-        goto fail;
+        return false;
     }
+    *number = schema->node_count++;
+    compiler->depth++;
 
-    /* step back to character in front of the first element */
-    input_buffer->offset--;
-    /* loop through the comma separated array elements */
-    do
+    /* the properties of a node are next to each other, so they are all added before compiling their schemas */
+    node.first_property = schema->property_count;
+    keyword = cJSON_GetObjectItemCaseSensitive(source, "properties");
+    if (keyword != NULL)
     {
-        /* allocate next item */
-        cJSON* new_item = cJSON_New_Item(&(input_buffer->hooks));
-        if (new_item == NULL)
+        if (!cJSON_IsObject(keyword))
         {
-            goto fail; /* allocation failure */
+            return false;
         }
-
-        /* attach next item to list */
-        if (head == NULL)
+        for (member = keyword->child; member != NULL; member = member->next)
         {
-            /* start the linked list */
-            current_item = head = new_item;
+            if (find_schema_property(schema, node.first_property, schema->property_count - node.first_property, member->string) == NULL)
+            {
+                if (!add_schema_property(compiler, member->string))
+                {
+                    return false;
+                }
+            }
         }
-        else
+    }
+    member = cJSON_GetObjectItemCaseSensitive(source, "required");
+    if (member != NULL)
+    {
+        if (!cJSON_IsArray(member))
         {
-            /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
-            current_item = new_item;
+            return false;
         }
-
-        if (cannot_access_at_index(input_buffer, 1))
+        for (member = member->child; member != NULL; member = member->next)
         {
-            goto fail; /* nothing comes after the comma */
+            schema_property* property = NULL;
+            if (!cJSON_IsString(member))
+            {
+                return false;
+            }
+            property = find_schema_property(schema, node.first_property, schema->property_count - node.first_property, member->valuestring);
+            if (property == NULL)
+            {
+                if (!add_schema_property(compiler, member->valuestring))
+                {
+                    return false;
+                }
+                property = &schema->properties[schema->property_count - 1];
+            }
+            property->required = true;
         }
-
-        /* parse the name of the child */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_string(current_item, input_buffer))
+    }
+    node.property_count = schema->property_count - node.first_property;
+    for (member = (keyword != NULL) ? keyword->child : NULL; member != NULL; member = member->next)
+    {
+        size_t property_node = 0;
+        if (!compile_schema_node(compiler, member, &property_node))
         {
-            goto fail; /* failed to parse name */
+            return false;
         }
-        buffer_skip_whitespace(input_buffer);
+        /* with duplicate keys the last schema wins */
+        find_schema_property(schema, node.first_property, node.property_count, member->string)->node = property_node;
+    }
 
-        /* swap valuestring and string, because we parsed the name */
-        current_item->string = current_item->valuestring;
-        current_item->valuestring = NULL;
+    keyword = cJSON_GetObjectItemCaseSensitive(source, "additionalProperties");
+    if (cJSON_IsFalse(keyword))
+    {
+        node.closed = true;
+    }
+    else if ((keyword != NULL) && !compile_schema_node(compiler, keyword, &node.additional))
+    {
+        return false;
+    }
 
-        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+    keyword = cJSON_GetObjectItemCaseSensitive(source, "items");
+    if ((keyword != NULL) && !compile_schema_node(compiler, keyword, &node.items))
+    {
+        return false;
+    }
+
+    compiler->depth--;
+    schema->nodes[*number] = node;
+
+    return true;
+}
+
+/* report an error at location, its path is a JSON Pointer */
+static void report_schema_error(schema_validation* const validation, const schema_location* const location, const char* const message)
+{
+    const schema_location* current = NULL;
+    char* path = NULL;
+    size_t length = 0;
+
+    validation->error_count++;
+    if (validation->callback == NULL)
+    {
+        return;
+    }
+
+    /* render the chain from the end */
+    for (current = location; current != NULL; current = current->parent)
+    {
+        char digits[32];
+        const char* key = current->key;
+        length++;
+        if (key == NULL)
         {
-            goto fail; /* invalid object */
+            length += (size_t)sprintf(digits, "%lu", (unsigned long)current->index);
+            continue;
         }
-
-        /* parse the value */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_value(current_item, input_buffer))
+        for (; *key != '\0'; key++)
         {
-            goto fail; /* failed to parse value */
+            length += ((*key == '~') || (*key == '/')) ? 2 : 1;
         }
-        buffer_skip_whitespace(input_buffer);
-    } while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+    }
 
-    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
+    path = (char*)hooks_allocate(&validation->schema->hooks, length + 1);
+    if (path != NULL)
     {
-        goto fail; /* expected end of object */
+        path[length] = '\0';
+        for (current = location; current != NULL; current = current->parent)
+        {
+            if (current->key == NULL)
+            {
+                char digits[32];
+                size_t digit_count = (size_t)sprintf(digits, "%lu", (unsigned long)current->index);
+                length -= digit_count;
+                memcpy(path + length, digits, digit_count);
+            }
+            else
+            {
+                const char* key = current->key + strlen(current->key);
+                while (key != current->key)
+                {
+                    key--;
+                    if ((*key == '~') || (*key == '/'))
+                    {
+                        path[--length] = (*key == '~') ? '0' : '1';
+                        path[--length] = '~';
+                    }
+                    else
+                    {
+                        path[--length] = *key;
+                    }
+                }
+            }
+            path[--length] = '/';
+        }
     }
 
-success:
-    input_buffer->depth--;
+    validation->callback(validation->context, path, message);
 
-    if (head != NULL) {
-        head->prev = current_item;
+    if (path != NULL)
+    {
+        hooks_deallocate(&validation->schema->hooks, path);
     }
+}
 
-    item->type = cJSON_Object;
-    item->child = head;
+static const char* schema_type_message(const schema_node* const node)
+{
+    switch (node->types)
+    {
+        case cJSON_NULL:
+            return "should be null";
+        case cJSON_True | cJSON_False:
+            return "should be a boolean";
+        case cJSON_Number:
+            return node->integer ? "should be an integer" : "should be a number";
+        case cJSON_String:
+            return "should be a string";
+        case cJSON_Array:
+            return "should be an array";
+        case cJSON_Object:
+            return "should be an object";
+        default:
+            return "has the wrong type";
+    }
+}
 
-    input_buffer->offset++;
-    return true;
+/* length of a UTF-8 string in code points */
+static size_t utf8_length(const unsigned char* string)
+{
+    size_t length = 0;
 
-fail:
-    if (head != NULL)
+    for (; *string != '\0'; string++)
     {
-        cJSON_Delete(head);
+        length += ((*string & 0xC0) != 0x80);
     }
 
-    return false;
+    return length;
 }
 
-/* Render an object to text. */
-static cJSON_bool print_object(const cJSON* const item, printbuffer* const output_buffer)
+static void validate_schema_node(schema_validation* const validation, const size_t number, const cJSON* const item, const schema_location* const location)
 {
-    unsigned char* output_pointer = NULL;
+    const schema_node* node = &validation->schema->nodes[number];
+    schema_location child_location;
+    const cJSON* child = NULL;
     size_t length = 0;
-    cJSON* current_item = item->child;
+    size_t i = 0;
 
-    if (output_buffer == NULL)
+    if (number == 0)
     {
-        return false;
+        return;
     }
-
-    /* Compose the output: */
-    length = (size_t)(output_buffer->format ? 2 : 1); /* fmt: {\n */
-    output_pointer = ensure(output_buffer, length + 1);
-    if (output_pointer == NULL)
+    if ((node->types != 0) && !(item->type & node->types))
     {
-        return false;
+        report_schema_error(validation, location, schema_type_message(node));
+        return;
     }
 
-    *output_pointer++ = '{';
-    output_buffer->depth++;
-    if (output_buffer->format)
+    switch (item->type & 0xFF)
     {
-        *output_pointer++ = '\n';
-    }
-    output_buffer->offset += length;
+        case cJSON_Number:
+            if (node->integer && (isnan(item->valuedouble) || isinf(item->valuedouble) || (item->valuedouble != floor(item->valuedouble))))
+            {
+                report_schema_error(validation, location, "should be an integer");
+            }
+            if (node->has_minimum && !(item->valuedouble >= node->minimum))
+            {
+                report_schema_error(validation, location, "is less than the minimum");
+            }
+            if (node->has_maximum && !(item->valuedouble <= node->maximum))
+            {
+                report_schema_error(validation, location, "is greater than the maximum");
+            }
+            return;
 
-    while (current_item)
-    {
-        if (output_buffer->format)
-        {
-            size_t i;
-            output_pointer = ensure(output_buffer, output_buffer->depth);
-            if (output_pointer == NULL)
+        case cJSON_String:
+            length = (item->valuestring != NULL) ? utf8_length((const unsigned char*)item->valuestring) : 0;
+            if (length < node->min_length)
             {
-                return false;
+                report_schema_error(validation, location, "is too short");
             }
-            for (i = 0; i < output_buffer->depth; i++)
+            if (length > node->max_length)
             {
-                *output_pointer++ = '\t';
+                report_schema_error(validation, location, "is too long");
             }
-            output_buffer->offset += output_buffer->depth;
-        }
+            return;
 
-        /* print key */
-        if (!print_string_ptr((unsigned char*)current_item->string, output_buffer))
-        {
-            return false;
-        }
-        update_offset(output_buffer);
+        case cJSON_Array:
+        case cJSON_Object:
+            if (!expand_lazy(item))
+            {
+                report_schema_error(validation, location, "is not valid JSON");
+                return;
+            }
+            break;
 
-        length = (size_t)(output_buffer->format ? 2 : 1);
-        output_pointer = ensure(output_buffer, length);
-        if (output_pointer == NULL)
-        {
-            return false;
-        }
-        *output_pointer++ = ':';
-        if (output_buffer->format)
-        {
-            *output_pointer++ = '\t';
-        }
-        output_buffer->offset += length;
+        default:
+            return;
+    }
+
+    child_location.parent = location;
+    child_location.key = NULL;
+    child_location.index = 0;
 
-        /* print value */
-        if (!print_value(current_item, output_buffer))
+    if ((item->type & 0xFF) == cJSON_Array)
+    {
+        for (child = item->child; child != NULL; child = child->next)
         {
-            return false;
+            child_location.index = length++;
+            validate_schema_node(validation, node->items, child, &child_location);
         }
-        update_offset(output_buffer);
-
-        /* print comma if not last */
-        length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(current_item->next ? 1 : 0));
-        output_pointer = ensure(output_buffer, length + 1);
-        if (output_pointer == NULL)
+        if (length < node->min_items)
         {
-            return false;
+            report_schema_error(validation, location, "has too few elements");
         }
-        if (current_item->next)
+        if (length > node->max_items)
         {
-            *output_pointer++ = ',';
+            report_schema_error(validation, location, "has too many elements");
         }
+        return;
+    }
 
-        if (output_buffer->format)
+    for (i = node->first_property; i < (node->first_property + node->property_count); i++)
+    {
+        const schema_property* property = &validation->schema->properties[i];
+        child_location.key = validation->schema->keys + property->key;
+        child = find_object_item(item, child_location.key, property->hash, true);
+        if (child == NULL)
         {
-            *output_pointer++ = '\n';
+            if (property->required)
+            {
+                report_schema_error(validation, &child_location, "is required");
+            }
+            continue;
         }
-        *output_pointer = '\0';
-        output_buffer->offset += length;
-
-        current_item = current_item->next;
+        validate_schema_node(validation, property->node, child, &child_location);
     }
 
-    output_pointer = ensure(output_buffer, output_buffer->format ? (output_buffer->depth + 1) : 2);
-    if (output_pointer == NULL)
-    {
-        return false;
-    }
-    if (output_buffer->format)
+    if (node->closed || (node->additional != 0))
     {
-        size_t i;
-        for (i = 0; i < (output_buffer->depth - 1); i++)
+        for (child = item->child; child != NULL; child = child->next)
         {
-            *output_pointer++ = '\t';
+            if ((child->string == NULL) || (find_schema_property(validation->schema, node->first_property, node->property_count, child->string) != NULL))
+            {
+                continue;
+            }
+            child_location.key = child->string;
+            if (node->closed)
+            {
+                report_schema_error(validation, &child_location, "is not allowed");
+            }
+            else
+            {
+                validate_schema_node(validation, node->additional, child, &child_location);
+            }
         }
     }
-    *output_pointer++ = '}';
-    *output_pointer = '\0';
-    output_buffer->depth--;
-
-    return true;
 }
 
-/* Get Array size/item / object item. */
-CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON* array)
+CJSON_PUBLIC(cJSON_Schema*) cJSON_SchemaCompile(const cJSON* schema)
 {
-    cJSON* child = NULL;
-    size_t size = 0;
+    schema_compiler compiler;
+    cJSON_Schema* compiled = NULL;
+    schema_node anything;
 
-    if (array == NULL)
+    if (schema == NULL)
     {
-        return 0;
+        return NULL;
     }
 
-    child = array->child;
-
-    while (child != NULL)
+    compiled = (cJSON_Schema*)global_hooks.allocate(sizeof(cJSON_Schema));
+    if (compiled == NULL)
     {
-        size++;
-        child = child->next;
+        return NULL;
     }
+    memset(compiled, '\0', sizeof(cJSON_Schema));
+    memset(&compiler, '\0', sizeof(compiler));
+    compiled->hooks = global_hooks;
+    compiler.schema = compiled;
 
-    /* FIXME: Can overflow here. Cannot be fixed without breaking the API */
-
-    return (int)size;
-}
-
-static cJSON* get_array_item(const cJSON* array, size_t index)
-{
-    cJSON* current_child = NULL;
-
-    if (array == NULL)
+    /* node 0 */
+    memset(&anything, '\0', sizeof(anything));
+    anything.max_length = (size_t)-1;
+    anything.max_items = (size_t)-1;
+    if (!grow_schema_array(&compiled->hooks, (void**)&compiled->nodes, sizeof(schema_node), 0, &compiler.node_capacity, 1))
     {
-        return NULL;
+        goto fail;
     }
+    compiled->nodes[compiled->node_count++] = anything;
 
-    current_child = array->child;
-    while ((current_child != NULL) && (index > 0))
+    if (!compile_schema_node(&compiler, schema, &compiled->root))
     {
-        index--;
-        current_child = current_child->next;
+        goto fail;
     }
 
-    return current_child;
+    return compiled;
+
+fail:
+    cJSON_SchemaDelete(compiled);
+
+    return NULL;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_GetArrayItem(const cJSON* array, int index)
+CJSON_PUBLIC(size_t) cJSON_SchemaValidate(const cJSON_Schema* schema, const cJSON* item, cJSON_SchemaErrorCallback callback, void* context)
 {
-    if (index < 0)
+    schema_validation validation;
+
+    if ((schema == NULL) || (item == NULL))
     {
-        return NULL;
+        return 0;
     }
 
-    return get_array_item(array, (size_t)index);
+    validation.schema = schema;
+    validation.callback = callback;
+    validation.context = context;
+    validation.error_count = 0;
+
+    validate_schema_node(&validation, schema->root, item, NULL);
+
+    return validation.error_count;
 }
 
-static cJSON* get_object_item(const cJSON* const object, const char* const name, const cJSON_bool case_sensitive)
+CJSON_PUBLIC(void) cJSON_SchemaDelete(cJSON_Schema* schema)
 {
-    cJSON* current_element = NULL;
+    internal_hooks hooks;
 
-    if ((object == NULL) || (name == NULL))
+    if (schema == NULL)
     {
-        return NULL;
+        return;
     }
 
-    current_element = object->child;
-    if (case_sensitive)
+    hooks = schema->hooks;
+    if (schema->nodes != NULL)
     {
-        while ((current_element != NULL) && (current_element->string != NULL) && (strcmp(name, current_element->string) != 0))
-        {
-            current_element = current_element->next;
-        }
+        hooks_deallocate(&hooks, schema->nodes);
     }
-    else
+    if (schema->properties != NULL)
     {
-        while ((current_element != NULL) && (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)(current_element->string)) != 0))
-        {
-            current_element = current_element->next;
-        }
+        hooks_deallocate(&hooks, schema->properties);
     }
-
-    if ((current_element == NULL) || (current_element->string == NULL)) {
-        return NULL;
+    if (schema->keys != NULL)
+    {
+        hooks_deallocate(&hooks, schema->keys);
     }
-
-    return current_element;
-}
-
-CJSON_PUBLIC(cJSON*) cJSON_GetObjectItem(const cJSON* const object, const char* const string)
-{
-    return get_object_item(object, string, false);
-}
-
-CJSON_PUBLIC(cJSON*) cJSON_GetObjectItemCaseSensitive(const cJSON* const object, const char* const string)
-{
-    return get_object_item(object, string, true);
-}
-
-CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON* object, const char* string)
-{
-    return cJSON_GetObjectItem(object, string) ? 1 : 0;
+    hooks_deallocate(&hooks, schema);
 }
 
 /* Utility for array list handling. */
@@ -1962,7 +8617,7 @@ static void suffix_object(cJSON* prev, cJSON* item)
 static cJSON* create_reference(const cJSON* item, const internal_hooks* const hooks)
 {
     cJSON* reference = NULL;
-    if (item == NULL)
+    if ((item == NULL) || !expand_lazy(item))
     {
         return NULL;
     }
@@ -1975,7 +8630,11 @@ static cJSON* create_reference(const cJSON* item, const internal_hooks* const ho
 
     memcpy(reference, item, sizeof(cJSON));
     reference->string = NULL;
-    reference->type |= cJSON_IsReference;
+    reference->type = (item->type | cJSON_IsReference) & ~(cJSON_InArena | cJSON_ArenaRoot | cJSON_InSitu | cJSON_HasAllocator | cJSON_Indexable | cJSON_LazyRoot);
+    if (hooks->allocator != NULL)
+    {
+        reference->type |= cJSON_HasAllocator;
+    }
     reference->next = reference->prev = NULL;
     return reference;
 }
@@ -1984,7 +8643,7 @@ static cJSON_bool add_item_to_array(cJSON* array, cJSON* item)
 {
     cJSON* child = NULL;
 
-    if ((item == NULL) || (array == NULL) || (array == item))
+    if ((item == NULL) || (array == NULL) || (array == item) || !expand_lazy(array) || !unshare_children(array))
     {
         return false;
     }
@@ -2009,6 +8668,7 @@ static cJSON_bool add_item_to_array(cJSON* array, cJSON* item)
             array->child->prev = item;
         }
     }
+    index_append(array, item);
 
     return true;
 }
@@ -2019,51 +8679,39 @@ CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToArray(cJSON* array, cJSON* item)
     return add_item_to_array(array, item);
 }
 
-#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-#pragma GCC diagnostic push
-#endif
-#ifdef __GNUC__
-#pragma GCC diagnostic ignored "-Wcast-qual"
-#endif
-/* helper function to cast away const */
-static void* cast_away_const(const void* string)
-{
-    return (void*)string;
-}
-#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-#pragma GCC diagnostic pop
-#endif
-
 
-static cJSON_bool add_item_to_object(cJSON* const object, const char* const string, cJSON* const item, const internal_hooks* const hooks, const cJSON_bool constant_key)
+static cJSON_bool add_item_to_object(cJSON* const object, const char* const string, cJSON* const item, const cJSON_bool constant_key)
 {
     char* new_key = NULL;
     int new_type = cJSON_Invalid;
+    internal_hooks hooks;
 
-    if ((object == NULL) || (string == NULL) || (item == NULL) || (object == item))
+    if ((object == NULL) || (string == NULL) || (item == NULL) || (object == item) || !unshare_children(object))
     {
         return false;
     }
 
+    /* the key is freed together with the item */
+    hooks = item_hooks(item);
     if (constant_key)
     {
         new_key = (char*)cast_away_const(string);
-        new_type = item->type | cJSON_StringIsConst;
+        new_type = (item->type & ~cJSON_InternedKey) | cJSON_StringIsConst;
     }
     else
     {
-        new_key = (char*)cJSON_strdup((const unsigned char*)string, hooks);
+        new_key = (char*)cJSON_strdup((const unsigned char*)string, &hooks);
         if (new_key == NULL)
         {
             return false;
         }
 
-        new_type = item->type & ~cJSON_StringIsConst;
+        new_type = item->type & ~(cJSON_StringIsConst | cJSON_InternedKey);
     }
 
-    if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
+    if (!(item->type & (cJSON_StringIsConst | cJSON_InArena)) && (item->string != NULL))
     {
-        hooks->deallocate(item->string);
+        hooks_deallocate(&hooks, item->string);
     }
 
     item->string = new_key;
@@ -2074,39 +8722,102 @@ static cJSON_bool add_item_to_object(cJSON* const object, const char* const stri
 
 CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObject(cJSON* object, const char* string, cJSON* item)
 {
-    return add_item_to_object(object, string, item, &global_hooks, false);
+    return add_item_to_object(object, string, item, false);
 }
 
 /* Add an item to an object with constant string as key */
 CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObjectCS(cJSON* object, const char* string, cJSON* item)
 {
-    return add_item_to_object(object, string, item, &global_hooks, true);
+    return add_item_to_object(object, string, item, true);
 }
 
 CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToArray(cJSON* array, cJSON* item)
 {
+    internal_hooks hooks;
+
     if (array == NULL)
     {
         return false;
     }
 
-    return add_item_to_array(array, create_reference(item, &global_hooks));
+    hooks = item_hooks(array);
+    return add_item_to_array(array, create_reference(item, &hooks));
 }
 
 CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToObject(cJSON* object, const char* string, cJSON* item)
 {
+    internal_hooks hooks;
+
     if ((object == NULL) || (string == NULL))
     {
         return false;
     }
 
-    return add_item_to_object(object, string, create_reference(item, &global_hooks), &global_hooks, false);
+    hooks = item_hooks(object);
+    return add_item_to_object(object, string, create_reference(item, &hooks), false);
+}
+
+/* Constructors behind the Create functions, the Add...ToObject helpers give them the allocator of the object. */
+static cJSON* create_item(int type, const internal_hooks* const hooks)
+{
+    cJSON* item = (type & (cJSON_Array | cJSON_Object)) ? new_container_item(hooks) : cJSON_New_Item(hooks);
+    if (item)
+    {
+        set_item_type(item, type);
+    }
+
+    return item;
+}
+
+static cJSON* create_number(double num, const internal_hooks* const hooks)
+{
+    cJSON* item = cJSON_New_Item(hooks);
+    if (item)
+    {
+        set_item_type(item, cJSON_Number);
+        item->valuedouble = num;
+
+        /* use saturation in case of overflow */
+        if (num >= INT_MAX)
+        {
+            item->valueint = INT_MAX;
+        }
+        else if (num <= (double)INT_MIN)
+        {
+            item->valueint = INT_MIN;
+        }
+        else
+        {
+            item->valueint = (int)num;
+        }
+    }
+
+    return item;
+}
+
+/* cJSON_String or cJSON_Raw */
+static cJSON* create_string(int type, const char* string, const internal_hooks* const hooks)
+{
+    cJSON* item = cJSON_New_Item(hooks);
+    if (item)
+    {
+        set_item_type(item, type);
+        item->valuestring = (char*)cJSON_strdup((const unsigned char*)string, hooks);
+        if (!item->valuestring)
+        {
+            cJSON_Delete(item);
+            return NULL;
+        }
+    }
+
+    return item;
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_AddNullToObject(cJSON* const object, const char* const name)
 {
-    cJSON* null = cJSON_CreateNull();
-    if (add_item_to_object(object, name, null, &global_hooks, false))
+    internal_hooks hooks = item_hooks(object);
+    cJSON* null = create_item(cJSON_NULL, &hooks);
+    if (add_item_to_object(object, name, null, false))
     {
         return null;
     }
@@ -2117,8 +8828,9 @@ CJSON_PUBLIC(cJSON*) cJSON_AddNullToObject(cJSON* const object, const char* cons
 
 CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObject(cJSON* const object, const char* const name)
 {
-    cJSON* true_item = cJSON_CreateTrue();
-    if (add_item_to_object(object, name, true_item, &global_hooks, false))
+    internal_hooks hooks = item_hooks(object);
+    cJSON* true_item = create_item(cJSON_True, &hooks);
+    if (add_item_to_object(object, name, true_item, false))
     {
         return true_item;
     }
@@ -2129,8 +8841,9 @@ CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObject(cJSON* const object, const char* cons
 
 CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObject(cJSON* const object, const char* const name)
 {
-    cJSON* false_item = cJSON_CreateFalse();
-    if (add_item_to_object(object, name, false_item, &global_hooks, false))
+    internal_hooks hooks = item_hooks(object);
+    cJSON* false_item = create_item(cJSON_False, &hooks);
+    if (add_item_to_object(object, name, false_item, false))
     {
         return false_item;
     }
@@ -2141,8 +8854,9 @@ CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObject(cJSON* const object, const char* con
 
 CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObject(cJSON* const object, const char* const name, const cJSON_bool boolean)
 {
-    cJSON* bool_item = cJSON_CreateBool(boolean);
-    if (add_item_to_object(object, name, bool_item, &global_hooks, false))
+    internal_hooks hooks = item_hooks(object);
+    cJSON* bool_item = create_item(boolean ? cJSON_True : cJSON_False, &hooks);
+    if (add_item_to_object(object, name, bool_item, false))
     {
         return bool_item;
     }
@@ -2153,8 +8867,9 @@ CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObject(cJSON* const object, const char* cons
 
 CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObject(cJSON* const object, const char* const name, const double number)
 {
-    cJSON* number_item = cJSON_CreateNumber(number);
-    if (add_item_to_object(object, name, number_item, &global_hooks, false))
+    internal_hooks hooks = item_hooks(object);
+    cJSON* number_item = create_number(number, &hooks);
+    if (add_item_to_object(object, name, number_item, false))
     {
         return number_item;
     }
@@ -2165,8 +8880,9 @@ CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObject(cJSON* const object, const char* co
 
 CJSON_PUBLIC(cJSON*) cJSON_AddStringToObject(cJSON* const object, const char* const name, const char* const string)
 {
-    cJSON* string_item = cJSON_CreateString(string);
-    if (add_item_to_object(object, name, string_item, &global_hooks, false))
+    internal_hooks hooks = item_hooks(object);
+    cJSON* string_item = create_string(cJSON_String, string, &hooks);
+    if (add_item_to_object(object, name, string_item, false))
     {
         return string_item;
     }
@@ -2177,8 +8893,9 @@ CJSON_PUBLIC(cJSON*) cJSON_AddStringToObject(cJSON* const object, const char* co
 
 CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON* const object, const char* const name, const char* const raw)
 {
-    cJSON* raw_item = cJSON_CreateRaw(raw);
-    if (add_item_to_object(object, name, raw_item, &global_hooks, false))
+    internal_hooks hooks = item_hooks(object);
+    cJSON* raw_item = create_string(cJSON_Raw, raw, &hooks);
+    if (add_item_to_object(object, name, raw_item, false))
     {
         return raw_item;
     }
@@ -2189,8 +8906,9 @@ CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON* const object, const char* const
 
 CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON* const object, const char* const name)
 {
-    cJSON* object_item = cJSON_CreateObject();
-    if (add_item_to_object(object, name, object_item, &global_hooks, false))
+    internal_hooks hooks = item_hooks(object);
+    cJSON* object_item = create_item(cJSON_Object, &hooks);
+    if (add_item_to_object(object, name, object_item, false))
     {
         return object_item;
     }
@@ -2201,8 +8919,9 @@ CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON* const object, const char* co
 
 CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON* const object, const char* const name)
 {
-    cJSON* array = cJSON_CreateArray();
-    if (add_item_to_object(object, name, array, &global_hooks, false))
+    internal_hooks hooks = item_hooks(object);
+    cJSON* array = create_item(cJSON_Array, &hooks);
+    if (add_item_to_object(object, name, array, false))
     {
         return array;
     }
@@ -2218,6 +8937,12 @@ CJSON_PUBLIC(cJSON*) cJSON_DetachItemViaPointer(cJSON* parent, cJSON* const item
         return NULL;
     }
 
+    /* the document of a lazy item is freed with its root */
+    if (!expand_lazy_tree(item))
+    {
+        return NULL;
+    }
+
     if (item != parent->child)
     {
         /* not the first element */
@@ -2243,6 +8968,7 @@ CJSON_PUBLIC(cJSON*) cJSON_DetachItemViaPointer(cJSON* parent, cJSON* const item
     /* make sure the detached item doesn't point anywhere anymore */
     item->prev = NULL;
     item->next = NULL;
+    index_remove(parent, item);
 
     return item;
 }
@@ -2318,6 +9044,7 @@ CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON* array, int which, cJSON*
     {
         newitem->prev->next = newitem;
     }
+    index_insert(array, (size_t)which, newitem);
     return true;
 }
 
@@ -2363,6 +9090,8 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON* const parent, cJSON*
         }
     }
 
+    index_replace(parent, item, replacement);
+
     item->next = NULL;
     item->prev = NULL;
     cJSON_Delete(item);
@@ -2382,23 +9111,26 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInArray(cJSON* array, int which, cJSON
 
 static cJSON_bool replace_item_in_object(cJSON* object, const char* string, cJSON* replacement, cJSON_bool case_sensitive)
 {
+    internal_hooks hooks;
+
     if ((replacement == NULL) || (string == NULL))
     {
         return false;
     }
 
     /* replace the name in the replacement */
-    if (!(replacement->type & cJSON_StringIsConst) && (replacement->string != NULL))
+    hooks = item_hooks(replacement);
+    if (!(replacement->type & (cJSON_StringIsConst | cJSON_InArena)) && (replacement->string != NULL))
     {
-        cJSON_free(replacement->string);
+        hooks_deallocate(&hooks, replacement->string);
     }
-    replacement->string = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
+    replacement->string = (char*)cJSON_strdup((const unsigned char*)string, &hooks);
     if (replacement->string == NULL)
     {
         return false;
     }
 
-    replacement->type &= ~cJSON_StringIsConst;
+    replacement->type &= ~(cJSON_StringIsConst | cJSON_InternedKey);
 
     return cJSON_ReplaceItemViaPointer(object, get_object_item(object, string, case_sensitive), replacement);
 }
@@ -2416,165 +9148,158 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObjectCaseSensitive(cJSON* object, c
 /* Create basic types: */
 CJSON_PUBLIC(cJSON*) cJSON_CreateNull(void)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item)
-    {
-        item->type = cJSON_NULL;
-    }
-
-    return item;
+    return create_item(cJSON_NULL, &global_hooks);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_CreateTrue(void)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item)
-    {
-        item->type = cJSON_True;
-    }
-
-    return item;
+    return create_item(cJSON_True, &global_hooks);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_CreateFalse(void)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item)
-    {
-        item->type = cJSON_False;
-    }
-
-    return item;
+    return create_item(cJSON_False, &global_hooks);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_CreateBool(cJSON_bool boolean)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item)
-    {
-        item->type = boolean ? cJSON_True : cJSON_False;
-    }
-
-    return item;
+    return create_item(boolean ? cJSON_True : cJSON_False, &global_hooks);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_CreateNumber(double num)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item)
-    {
-        item->type = cJSON_Number;
-        item->valuedouble = num;
+    return create_number(num, &global_hooks);
+}
 
-        /* use saturation in case of overflow */
-        if (num >= INT_MAX)
-        {
-            item->valueint = INT_MAX;
-        }
-        else if (num <= (double)INT_MIN)
+CJSON_PUBLIC(cJSON*) cJSON_CreateString(const char* string)
+{
+    return create_string(cJSON_String, string, &global_hooks);
+}
+
+/* a string that references string, or an array or object that references the children starting at target */
+static cJSON* create_reference_to(int type, const void* target, const internal_hooks* const hooks)
+{
+    cJSON* item = cJSON_New_Item(hooks);
+    if (item != NULL)
+    {
+        set_item_type(item, type | cJSON_IsReference);
+        if (type == cJSON_String)
         {
-            item->valueint = INT_MIN;
+            item->valuestring = (char*)cast_away_const(target);
         }
         else
         {
-            item->valueint = (int)num;
+            item->child = (cJSON*)cast_away_const(target);
         }
     }
 
     return item;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_CreateString(const char* string)
+CJSON_PUBLIC(cJSON*) cJSON_CreateStringReference(const char* string)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item)
-    {
-        item->type = cJSON_String;
-        item->valuestring = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
-        if (!item->valuestring)
-        {
-            cJSON_Delete(item);
-            return NULL;
-        }
-    }
+    return create_reference_to(cJSON_String, string, &global_hooks);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_CreateObjectReference(const cJSON* child)
+{
+    return create_reference_to(cJSON_Object, child, &global_hooks);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_CreateArrayReference(const cJSON* child)
+{
+    return create_reference_to(cJSON_Array, child, &global_hooks);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_CreateRaw(const char* raw)
+{
+    return create_string(cJSON_Raw, raw, &global_hooks);
+}
 
-    return item;
+CJSON_PUBLIC(cJSON*) cJSON_CreateArray(void)
+{
+    return create_item(cJSON_Array, &global_hooks);
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_CreateStringReference(const char* string)
+CJSON_PUBLIC(cJSON*) cJSON_CreateObject(void)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item != NULL)
-    {
-        item->type = cJSON_String | cJSON_IsReference;
-        item->valuestring = (char*)cast_away_const(string);
-    }
+    return create_item(cJSON_Object, &global_hooks);
+}
 
-    return item;
+CJSON_PUBLIC(cJSON*) cJSON_CreateObjectWithAllocator(const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_item(cJSON_Object, &hooks);
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_CreateObjectReference(const cJSON* child)
+CJSON_PUBLIC(cJSON*) cJSON_CreateArrayWithAllocator(const cJSON_Allocator* allocator)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item != NULL) {
-        item->type = cJSON_Object | cJSON_IsReference;
-        item->child = (cJSON*)cast_away_const(child);
-    }
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_item(cJSON_Array, &hooks);
+}
 
-    return item;
+CJSON_PUBLIC(cJSON*) cJSON_CreateStringWithAllocator(const char* string, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_string(cJSON_String, string, &hooks);
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_CreateArrayReference(const cJSON* child) {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item != NULL) {
-        item->type = cJSON_Array | cJSON_IsReference;
-        item->child = (cJSON*)cast_away_const(child);
-    }
+CJSON_PUBLIC(cJSON*) cJSON_CreateNumberWithAllocator(double num, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_number(num, &hooks);
+}
 
-    return item;
+CJSON_PUBLIC(cJSON*) cJSON_CreateNullWithAllocator(const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_item(cJSON_NULL, &hooks);
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_CreateRaw(const char* raw)
+CJSON_PUBLIC(cJSON*) cJSON_CreateTrueWithAllocator(const cJSON_Allocator* allocator)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item)
-    {
-        item->type = cJSON_Raw;
-        item->valuestring = (char*)cJSON_strdup((const unsigned char*)raw, &global_hooks);
-        if (!item->valuestring)
-        {
-            cJSON_Delete(item);
-            return NULL;
-        }
-    }
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_item(cJSON_True, &hooks);
+}
 
-    return item;
+CJSON_PUBLIC(cJSON*) cJSON_CreateFalseWithAllocator(const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_item(cJSON_False, &hooks);
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_CreateArray(void)
+CJSON_PUBLIC(cJSON*) cJSON_CreateBoolWithAllocator(cJSON_bool boolean, const cJSON_Allocator* allocator)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item)
-    {
-        item->type = cJSON_Array;
-    }
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_item(boolean ? cJSON_True : cJSON_False, &hooks);
+}
 
-    return item;
+CJSON_PUBLIC(cJSON*) cJSON_CreateRawWithAllocator(const char* raw, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_string(cJSON_Raw, raw, &hooks);
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_CreateObject(void)
+CJSON_PUBLIC(cJSON*) cJSON_CreateStringReferenceWithAllocator(const char* string, const cJSON_Allocator* allocator)
 {
-    cJSON* item = cJSON_New_Item(&global_hooks);
-    if (item)
-    {
-        item->type = cJSON_Object;
-    }
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_reference_to(cJSON_String, string, &hooks);
+}
 
-    return item;
+CJSON_PUBLIC(cJSON*) cJSON_CreateObjectReferenceWithAllocator(const cJSON* child, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_reference_to(cJSON_Object, child, &hooks);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_CreateArrayReferenceWithAllocator(const cJSON* child, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_reference_to(cJSON_Array, child, &hooks);
 }
 
 /* Create Arrays: */
-CJSON_PUBLIC(cJSON*) cJSON_CreateIntArray(const int* numbers, int count)
+static cJSON* create_int_array(const int* numbers, int count, const internal_hooks* const hooks)
 {
     size_t i = 0;
     cJSON* n = NULL;
@@ -2586,11 +9311,11 @@ CJSON_PUBLIC(cJSON*) cJSON_CreateIntArray(const int* numbers, int count)
         return NULL;
     }
 
-    a = cJSON_CreateArray();
+    a = create_item(cJSON_Array, hooks);
 
     for (i = 0; a && (i < (size_t)count); i++)
     {
-        n = cJSON_CreateNumber(numbers[i]);
+        n = create_number(numbers[i], hooks);
         if (!n)
         {
             cJSON_Delete(a);
@@ -2610,11 +9335,26 @@ CJSON_PUBLIC(cJSON*) cJSON_CreateIntArray(const int* numbers, int count)
     if (a && a->child) {
         a->child->prev = n;
     }
+    if (a)
+    {
+        index_linked_children(a, (size_t)count);
+    }
 
     return a;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_CreateFloatArray(const float* numbers, int count)
+CJSON_PUBLIC(cJSON*) cJSON_CreateIntArray(const int* numbers, int count)
+{
+    return create_int_array(numbers, count, &global_hooks);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_CreateIntArrayWithAllocator(const int* numbers, int count, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_int_array(numbers, count, &hooks);
+}
+
+static cJSON* create_float_array(const float* numbers, int count, const internal_hooks* const hooks)
 {
     size_t i = 0;
     cJSON* n = NULL;
@@ -2626,11 +9366,11 @@ CJSON_PUBLIC(cJSON*) cJSON_CreateFloatArray(const float* numbers, int count)
         return NULL;
     }
 
-    a = cJSON_CreateArray();
+    a = create_item(cJSON_Array, hooks);
 
     for (i = 0; a && (i < (size_t)count); i++)
     {
-        n = cJSON_CreateNumber((double)numbers[i]);
+        n = create_number((double)numbers[i], hooks);
         if (!n)
         {
             cJSON_Delete(a);
@@ -2650,11 +9390,26 @@ CJSON_PUBLIC(cJSON*) cJSON_CreateFloatArray(const float* numbers, int count)
     if (a && a->child) {
         a->child->prev = n;
     }
+    if (a)
+    {
+        index_linked_children(a, (size_t)count);
+    }
 
     return a;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_CreateDoubleArray(const double* numbers, int count)
+CJSON_PUBLIC(cJSON*) cJSON_CreateFloatArray(const float* numbers, int count)
+{
+    return create_float_array(numbers, count, &global_hooks);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_CreateFloatArrayWithAllocator(const float* numbers, int count, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_float_array(numbers, count, &hooks);
+}
+
+static cJSON* create_double_array(const double* numbers, int count, const internal_hooks* const hooks)
 {
     size_t i = 0;
     cJSON* n = NULL;
@@ -2666,11 +9421,11 @@ CJSON_PUBLIC(cJSON*) cJSON_CreateDoubleArray(const double* numbers, int count)
         return NULL;
     }
 
-    a = cJSON_CreateArray();
+    a = create_item(cJSON_Array, hooks);
 
     for (i = 0; a && (i < (size_t)count); i++)
     {
-        n = cJSON_CreateNumber(numbers[i]);
+        n = create_number(numbers[i], hooks);
         if (!n)
         {
             cJSON_Delete(a);
@@ -2690,11 +9445,26 @@ CJSON_PUBLIC(cJSON*) cJSON_CreateDoubleArray(const double* numbers, int count)
     if (a && a->child) {
         a->child->prev = n;
     }
+    if (a)
+    {
+        index_linked_children(a, (size_t)count);
+    }
 
     return a;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_CreateStringArray(const char* const* strings, int count)
+CJSON_PUBLIC(cJSON*) cJSON_CreateDoubleArray(const double* numbers, int count)
+{
+    return create_double_array(numbers, count, &global_hooks);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_CreateDoubleArrayWithAllocator(const double* numbers, int count, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_double_array(numbers, count, &hooks);
+}
+
+static cJSON* create_string_array(const char* const* strings, int count, const internal_hooks* const hooks)
 {
     size_t i = 0;
     cJSON* n = NULL;
@@ -2706,11 +9476,11 @@ CJSON_PUBLIC(cJSON*) cJSON_CreateStringArray(const char* const* strings, int cou
         return NULL;
     }
 
-    a = cJSON_CreateArray();
+    a = create_item(cJSON_Array, hooks);
 
     for (i = 0; a && (i < (size_t)count); i++)
     {
-        n = cJSON_CreateString(strings[i]);
+        n = create_string(cJSON_String, strings[i], hooks);
         if (!n)
         {
             cJSON_Delete(a);
@@ -2730,43 +9500,81 @@ CJSON_PUBLIC(cJSON*) cJSON_CreateStringArray(const char* const* strings, int cou
     if (a && a->child) {
         a->child->prev = n;
     }
+    if (a)
+    {
+        index_linked_children(a, (size_t)count);
+    }
 
     return a;
 }
 
+CJSON_PUBLIC(cJSON*) cJSON_CreateStringArray(const char* const* strings, int count)
+{
+    return create_string_array(strings, count, &global_hooks);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_CreateStringArrayWithAllocator(const char* const* strings, int count, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return create_string_array(strings, count, &hooks);
+}
+
 /* Duplication */
 cJSON* cJSON_Duplicate_rec(const cJSON* item, size_t depth, cJSON_bool recurse);
+static cJSON* duplicate_rec(const cJSON* item, size_t depth, cJSON_bool recurse, const internal_hooks* const hooks);
+
+CJSON_PUBLIC(cJSON*) cJSON_DuplicateShared(const cJSON* item)
+{
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    return share_item(item, &global_hooks);
+}
 
 CJSON_PUBLIC(cJSON*) cJSON_Duplicate(const cJSON* item, cJSON_bool recurse)
 {
-    return cJSON_Duplicate_rec(item, 0, recurse);
+    return duplicate_rec(item, 0, recurse, &global_hooks);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_DuplicateWithAllocator(const cJSON* item, cJSON_bool recurse, const cJSON_Allocator* allocator)
+{
+    internal_hooks hooks = allocator_hooks(allocator);
+    return duplicate_rec(item, 0, recurse, &hooks);
 }
 
 cJSON* cJSON_Duplicate_rec(const cJSON* item, size_t depth, cJSON_bool recurse)
+{
+    return duplicate_rec(item, depth, recurse, &global_hooks);
+}
+
+static cJSON* duplicate_rec(const cJSON* item, size_t depth, cJSON_bool recurse, const internal_hooks* const hooks)
 {
     cJSON* newitem = NULL;
     cJSON* child = NULL;
     cJSON* next = NULL;
     cJSON* newchild = NULL;
+    size_t count = 0;
 
     /* Bail on bad ptr */
-    if (!item)
+    if (!item || !expand_lazy(item))
     {
         goto fail;
     }
     /* Create new item */
-    newitem = cJSON_New_Item(&global_hooks);
+    newitem = (item->type & (cJSON_Array | cJSON_Object)) ? new_container_item(hooks) : cJSON_New_Item(hooks);
     if (!newitem)
     {
         goto fail;
     }
     /* Copy over all vars */
-    newitem->type = item->type & (~cJSON_IsReference);
+    set_item_type(newitem, item->type & ~(cJSON_IsReference | cJSON_InArena | cJSON_ArenaRoot | cJSON_InSitu | cJSON_HasAllocator | cJSON_Indexable | cJSON_Shared | cJSON_InternedKey | cJSON_LazyRoot));
     newitem->valueint = item->valueint;
     newitem->valuedouble = item->valuedouble;
     if (item->valuestring)
     {
-        newitem->valuestring = (char*)cJSON_strdup((unsigned char*)item->valuestring, &global_hooks);
+        newitem->valuestring = (char*)cJSON_strdup((unsigned char*)item->valuestring, hooks);
         if (!newitem->valuestring)
         {
             goto fail;
@@ -2774,7 +9582,16 @@ cJSON* cJSON_Duplicate_rec(const cJSON* item, size_t depth, cJSON_bool recurse)
     }
     if (item->string)
     {
-        newitem->string = (item->type & cJSON_StringIsConst) ? item->string : (char*)cJSON_strdup((unsigned char*)item->string, &global_hooks);
+        /* keys parsed in situ, interned or shared belong to something else, the copy shouldn't depend on it */
+        if ((item->type & (cJSON_StringIsConst | cJSON_InSitu | cJSON_Shared | cJSON_InternedKey)) == cJSON_StringIsConst)
+        {
+            newitem->string = item->string;
+        }
+        else
+        {
+            newitem->string = (char*)cJSON_strdup((unsigned char*)item->string, hooks);
+            newitem->type &= ~cJSON_StringIsConst;
+        }
         if (!newitem->string)
         {
             goto fail;
@@ -2792,7 +9609,7 @@ cJSON* cJSON_Duplicate_rec(const cJSON* item, size_t depth, cJSON_bool recurse)
         if (depth >= CJSON_CIRCULAR_LIMIT) {
             goto fail;
         }
-        newchild = cJSON_Duplicate_rec(child, depth + 1, true); /* Duplicate (with recurse) each item in the ->next chain */
+        newchild = duplicate_rec(child, depth + 1, true, hooks); /* Duplicate (with recurse) each item in the ->next chain */
         if (!newchild)
         {
             goto fail;
@@ -2810,12 +9627,14 @@ cJSON* cJSON_Duplicate_rec(const cJSON* item, size_t depth, cJSON_bool recurse)
             newitem->child = newchild;
             next = newchild;
         }
+        count++;
         child = child->next;
     }
     if (newitem && newitem->child)
     {
         newitem->child->prev = newchild;
     }
+    index_linked_children(newitem, count);
 
     return newitem;
 
@@ -2828,98 +9647,121 @@ fail:
     return NULL;
 }
 
-static void skip_oneline_comment(char** input)
+/* returns the length of the comment at input, up to and including its terminator */
+static size_t skip_oneline_comment(const unsigned char* input, size_t length)
 {
-    *input += static_strlen("//");
+    const unsigned char* line_feed = (const unsigned char*)memchr(input + static_strlen("//"), '\n', length - static_strlen("//"));
 
-    for (; (*input)[0] != '\0'; ++(*input))
+    if (line_feed == NULL)
     {
-        if ((*input)[0] == '\n') {
-            *input += static_strlen("\n");
-            return;
-        }
+        return length;
     }
+
+    return (size_t)(line_feed - input) + static_strlen("\n");
 }
 
-static void skip_multiline_comment(char** input)
+static size_t skip_multiline_comment(const unsigned char* input, size_t length)
 {
-    *input += static_strlen("/*");
+    size_t offset = static_strlen("/*");
 
-    for (; (*input)[0] != '\0'; ++(*input))
+    while (offset < length)
     {
-        if (((*input)[0] == '*') && ((*input)[1] == '/'))
+        const unsigned char* star = (const unsigned char*)memchr(input + offset, '*', length - offset);
+        if (star == NULL)
         {
-            *input += static_strlen("*/");
-            return;
+            break;
+        }
+
+        offset = (size_t)(star - input) + 1;
+        if ((offset < length) && (input[offset] == '/'))
+        {
+            return offset + static_strlen("/");
         }
     }
-}
 
-static void minify_string(char** input, char** output) {
-    (*output)[0] = (*input)[0];
-    *input += static_strlen("\"");
-    *output += static_strlen("\"");
+    return length;
+}
 
+/* copies the string at input to output and returns its length in input.
+ * A quote preceded by a backslash doesn't end the string, even if the backslash is escaped itself. */
+static size_t minify_string(const unsigned char* input, size_t length, unsigned char** output, const scan_kernels* kernels)
+{
+    size_t offset = static_strlen("\"");
 
-    for (; (*input)[0] != '\0'; (void)++(*input), ++(*output)) {
-        (*output)[0] = (*input)[0];
+    while (offset < length)
+    {
+        offset += kernels->find_quote_or_backslash(input + offset, length - offset);
+        if (offset == length)
+        {
+            break;
+        }
 
-        if ((*input)[0] == '\"') {
-            (*output)[0] = '\"';
-            *input += static_strlen("\"");
-            *output += static_strlen("\"");
-            return;
+        offset++;
+        if (input[offset - 1] == '\"')
+        {
+            break;
         }
-        else if (((*input)[0] == '\\') && ((*input)[1] == '\"')) {
-            (*output)[1] = (*input)[1];
-            *input += static_strlen("\"");
-            *output += static_strlen("\"");
+
+        if ((offset < length) && (input[offset] == '\"'))
+        {
+            offset++;
         }
     }
+
+    /* as long as nothing was left out the string is already in place */
+    if (*output != input)
+    {
+        memmove(*output, input, offset);
+    }
+    *output += offset;
+
+    return offset;
 }
 
 CJSON_PUBLIC(void) cJSON_Minify(char* json)
 {
-    char* into = json;
+    const scan_kernels* kernels = NULL;
+    unsigned char* input = (unsigned char*)json;
+    unsigned char* into = input;
+    size_t length = 0;
+    size_t offset = 0;
+    size_t written = 0;
 
     if (json == NULL)
     {
         return;
     }
 
-    while (json[0] != '\0')
+    kernels = get_scan_kernels();
+    length = strlen(json);
+
+    /* everything between strings and comments is compacted a vector at a time,
+     * strings and comments are skipped to their end in one go */
+    while (offset < length)
     {
-        switch (json[0])
+        offset += kernels->compact_whitespace(input + offset, length - offset, into, &written);
+        into += written;
+        if (offset == length)
         {
-        case ' ':
-        case '\t':
-        case '\r':
-        case '\n':
-            json++;
-            break;
-
-        case '/':
-            if (json[1] == '/')
-            {
-                skip_oneline_comment(&json);
-            }
-            else if (json[1] == '*')
-            {
-                skip_multiline_comment(&json);
-            }
-            else {
-                json++;
-            }
-            break;
-
-        case '\"':
-            minify_string(&json, (char**)&into);
             break;
+        }
 
-        default:
-            into[0] = json[0];
-            json++;
-            into++;
+        if (input[offset] == '\"')
+        {
+            offset += minify_string(input + offset, length - offset, &into, kernels);
+        }
+        else if (((offset + 1) < length) && (input[offset + 1] == '/'))
+        {
+            offset += skip_oneline_comment(input + offset, length - offset);
+        }
+        else if (((offset + 1) < length) && (input[offset + 1] == '*'))
+        {
+            offset += skip_multiline_comment(input + offset, length - offset);
+        }
+        else
+        {
+            /* a lone slash is dropped */
+            offset++;
         }
     }
 
@@ -3027,6 +9869,169 @@ CJSON_PUBLIC(cJSON_bool) cJSON_IsRaw(const cJSON* const item)
     return (item->type & 0xFF) == cJSON_Raw;
 }
 
+/* Structural hashing.
+ * Object members are hashed as a set: every member adds mix(key, value) and equal contributions are only added
+ * once, so members can be in any order and duplicate keys that cJSON_Compare pairs up don't change the hash.
+ * Keys are case-folded to match cJSON_Compare in both modes. */
+#define HASH_CONSTANT(high, low) (((uint64_t)(high) << 32) | (uint64_t)(low))
+/* members hashed on the stack before a buffer is allocated */
+#define HASH_LOCAL_MEMBERS 32
+
+static uint64_t mix_hash(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= HASH_CONSTANT(0xFF51AFD7U, 0xED558CCDU);
+    hash ^= hash >> 33;
+    hash *= HASH_CONSTANT(0xC4CEB9FEU, 0x1A85EC53U);
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/* FNV-1a */
+static uint64_t hash_text(const unsigned char* text, cJSON_bool fold_case)
+{
+    uint64_t hash = HASH_CONSTANT(0xCBF29CE4U, 0x84222325U);
+
+    for (; *text != '\0'; text++)
+    {
+        hash ^= (uint64_t)(fold_case ? (unsigned char)tolower(*text) : *text);
+        hash *= HASH_CONSTANT(0x00000100U, 0x000001B3U);
+    }
+
+    return hash;
+}
+
+static int compare_hashes(const void* a, const void* b)
+{
+    uint64_t first = *(const uint64_t*)a;
+    uint64_t second = *(const uint64_t*)b;
+
+    return (first < second) ? -1 : ((first > second) ? 1 : 0);
+}
+
+/* fails if there isn't enough memory to sort the members of a large object */
+static cJSON_bool hash_item(const cJSON* const item, uint64_t* const hash)
+{
+    uint64_t result = (uint64_t)(item->type & 0xFF);
+    uint64_t value = 0;
+    const cJSON* child = NULL;
+
+    if (!expand_lazy(item))
+    {
+        return false;
+    }
+
+    switch (item->type & 0xFF)
+    {
+    case cJSON_Number:
+    {
+        /* 0.0 == -0.0 */
+        double number = (item->valuedouble == 0) ? 0.0 : item->valuedouble;
+        memcpy(&value, &number, sizeof(value));
+        result ^= mix_hash(value);
+        break;
+    }
+
+    case cJSON_String:
+    case cJSON_Raw:
+        if (item->valuestring != NULL)
+        {
+            result ^= hash_text((const unsigned char*)item->valuestring, false);
+        }
+        break;
+
+    case cJSON_Array:
+        for (child = item->child; child != NULL; child = child->next)
+        {
+            if (!hash_item(child, &value))
+            {
+                return false;
+            }
+            result = mix_hash(result ^ value) + 1;
+        }
+        break;
+
+    case cJSON_Object:
+    {
+        uint64_t local[HASH_LOCAL_MEMBERS];
+        uint64_t* members = local;
+        size_t count = 0;
+        size_t i = 0;
+        internal_hooks hooks = item_hooks(item);
+        cJSON_bool success = true;
+
+        for (child = item->child; child != NULL; child = child->next)
+        {
+            count++;
+        }
+        if (count > HASH_LOCAL_MEMBERS)
+        {
+            if (count > (((size_t)-1) / sizeof(uint64_t)))
+            {
+                return false;
+            }
+            members = (uint64_t*)hooks_allocate(&hooks, count * sizeof(uint64_t));
+            if (members == NULL)
+            {
+                return false;
+            }
+        }
+
+        for (child = item->child, i = 0; child != NULL; child = child->next, i++)
+        {
+            if (!hash_item(child, &value))
+            {
+                success = false;
+                break;
+            }
+            members[i] = mix_hash(((child->string != NULL) ? hash_text((const unsigned char*)child->string, true) : 0) ^ mix_hash(value));
+        }
+
+        if (success)
+        {
+            qsort(members, count, sizeof(uint64_t), compare_hashes);
+            for (i = 0; i < count; i++)
+            {
+                if ((i == 0) || (members[i] != members[i - 1]))
+                {
+                    result += members[i];
+                }
+            }
+            result = mix_hash(result);
+        }
+
+        if (members != local)
+        {
+            hooks_deallocate(&hooks, members);
+        }
+        if (!success)
+        {
+            return false;
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    *hash = result;
+    return true;
+}
+
+CJSON_PUBLIC(size_t) cJSON_Hash(const cJSON* const item)
+{
+    uint64_t hash = 0;
+
+    if ((item == NULL) || !hash_item(item, &hash))
+    {
+        return 0;
+    }
+
+    return (size_t)hash;
+}
+
 CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON* const a, const cJSON* const b, const cJSON_bool case_sensitive)
 {
     if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
@@ -3057,6 +10062,11 @@ CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON* const a, const cJSON* const
         return true;
     }
 
+    if (!expand_lazy(a) || !expand_lazy(b))
+    {
+        return false;
+    }
+
     switch (a->type & 0xFF)
     {
         /* in these cases and equal type is enough */
@@ -3113,9 +10123,8 @@ CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON* const a, const cJSON* const
     {
         cJSON* a_element = NULL;
         cJSON* b_element = NULL;
-        cJSON_ArrayForEach(a_element, a)
+        for (a_element = a->child; a_element != NULL; a_element = a_element->next)
         {
-            /* TODO This has O(n^2) runtime, which is horrible! */
             b_element = get_object_item(b, a_element->string, case_sensitive);
             if (b_element == NULL)
             {
@@ -3128,9 +10137,9 @@ CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON* const a, const cJSON* const
             }
         }
 
-        /* doing this twice, once on a and b to prevent true comparison if a subset of b
-         * TODO: Do this the proper way, this is just a fix for now */
-        cJSON_ArrayForEach(b_element, b)
+        /* doing this twice, once on a and b to prevent true comparison if a subset of b.
+         * A pair that was compared above is only compared again if duplicate keys paired it differently. */
+        for (b_element = b->child; b_element != NULL; b_element = b_element->next)
         {
             a_element = get_object_item(a, b_element->string, case_sensitive);
             if (a_element == NULL)
@@ -3138,7 +10147,7 @@ CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON* const a, const cJSON* const
                 return false;
             }
 
-            if (!cJSON_Compare(b_element, a_element, case_sensitive))
+            if ((get_object_item(b, a_element->string, case_sensitive) != b_element) && !cJSON_Compare(b_element, a_element, case_sensitive))
             {
                 return false;
             }
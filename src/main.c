@@ -161,46 +161,231 @@ void get_parent_directory(char *buffer, size_t size)
     }
 #endif
 }
+
+// What parse_json_file expects of config.json, so the loader below can use every field it reads without checking it
+static const char config_schema[] =
+    "{"
+    "  \"type\": \"object\","
+    "  \"required\": [\"categories\", \"dependencies\"],"
+    "  \"properties\": {"
+    "    \"categories\": {"
+    "      \"type\": \"array\","
+    "      \"items\": {"
+    "        \"type\": \"object\","
+    "        \"required\": [\"name\", \"frameworks\"],"
+    "        \"properties\": {"
+    "          \"name\": {\"type\": \"string\", \"minLength\": 1},"
+    "          \"frameworks\": {"
+    "            \"type\": \"array\","
+    "            \"items\": {"
+    "              \"type\": \"object\","
+    "              \"required\": [\"name\", \"tools\"],"
+    "              \"properties\": {"
+    "                \"name\": {\"type\": \"string\", \"minLength\": 1},"
+    "                \"tools\": {"
+    "                  \"type\": \"array\","
+    "                  \"items\": {"
+    "                    \"type\": \"object\","
+    "                    \"required\": [\"name\", \"command\", \"dependencies\"],"
+    "                    \"properties\": {"
+    "                      \"name\": {\"type\": \"string\", \"minLength\": 1},"
+    "                      \"command\": {\"type\": \"string\", \"minLength\": 1},"
+    "                      \"dependencies\": {\"type\": \"array\", \"items\": {\"type\": \"string\"}}"
+    "                    }"
+    "                  }"
+    "                }"
+    "              }"
+    "            }"
+    "          }"
+    "        }"
+    "      }"
+    "    },"
+    "    \"dependencies\": {"
+    "      \"type\": \"array\","
+    "      \"items\": {"
+    "        \"type\": \"object\","
+    "        \"required\": [\"name\", \"check_command\", \"install_commands\"],"
+    "        \"properties\": {"
+    "          \"name\": {\"type\": \"string\", \"minLength\": 1},"
+    "          \"check_command\": {\"type\": \"string\", \"minLength\": 1},"
+    "          \"install_commands\": {\"type\": \"object\", \"additionalProperties\": {\"type\": \"string\"}}"
+    "        }"
+    "      }"
+    "    }"
+    "  }"
+    "}";
+
+static void print_config_error(void *context, const char *path, const char *message)
+{
+    if (path == NULL)
+    {
+        fprintf(stderr, "%s: %s\n", (const char *)context, message);
+        return;
+    }
+    fprintf(stderr, "%s: %s %s\n", (const char *)context, path[0] != '\0' ? path : "(root)", message);
+}
+
+// Every dependency a tool refers to has to be declared, which the schema can't express
+static size_t check_tool_dependencies(const char *filename, const cJSON *json)
+{
+    const cJSON *dependencies = cJSON_GetObjectItemCaseSensitive(json, "dependencies");
+    const cJSON *category = NULL;
+    size_t error_count = 0;
+    int i = 0;
+    cJSON_ArrayForEach(category, cJSON_GetObjectItemCaseSensitive(json, "categories"))
+    {
+        const cJSON *framework = NULL;
+        int j = 0;
+        cJSON_ArrayForEach(framework, cJSON_GetObjectItemCaseSensitive(category, "frameworks"))
+        {
+            const cJSON *tool = NULL;
+            int k = 0;
+            cJSON_ArrayForEach(tool, cJSON_GetObjectItemCaseSensitive(framework, "tools"))
+            {
+                const cJSON *tool_dep = NULL;
+                int l = 0;
+                cJSON_ArrayForEach(tool_dep, cJSON_GetObjectItemCaseSensitive(tool, "dependencies"))
+                {
+                    // Entries that aren't strings are already reported by the schema
+                    const char *dep_key = cJSON_GetStringValue(tool_dep);
+                    const cJSON *dep = NULL;
+                    cJSON_ArrayForEach(dep, dependencies)
+                    {
+                        const char *name = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(dep, "name"));
+                        if (name != NULL && dep_key != NULL && strcmp(dep_key, name) == 0)
+                        {
+                            break;
+                        }
+                    }
+                    if (dep_key != NULL && dep == NULL)
+                    {
+                        char path[128];
+                        snprintf(path, sizeof(path), "/categories/%d/frameworks/%d/tools/%d/dependencies/%d", i, j, k, l);
+                        print_config_error((void *)filename, path, "is not a declared dependency");
+                        error_count++;
+                    }
+                    l++;
+                }
+                k++;
+            }
+            j++;
+        }
+        i++;
+    }
+    return error_count;
+}
+
+// Report every problem in the configuration at once instead of stopping at the first one
+static int validate_config(const char *filename, const cJSON *json)
+{
+    cJSON *schema_json = cJSON_Parse(config_schema);
+    cJSON_Schema *schema = cJSON_SchemaCompile(schema_json);
+    cJSON_Delete(schema_json);
+    if (schema == NULL)
+    {
+        printf("Configuration schema could not be compiled.\n");
+        return 0;
+    }
+    size_t error_count = cJSON_SchemaValidate(schema, json, print_config_error, (void *)filename);
+    cJSON_SchemaDelete(schema);
+    error_count += check_tool_dependencies(filename, json);
+    if (error_count > 0)
+    {
+        fprintf(stderr, "%s: %lu error(s), the configuration was not loaded.\n", filename, (unsigned long)error_count);
+        return 0;
+    }
+    return 1;
+}
+
+// The path of the install command for key in a dependency, with key escaped as a JSON Pointer step
+static cJSON_Path *compile_install_path(const char *key)
+{
+    const char prefix[] = "/install_commands/";
+    size_t length = sizeof(prefix) - 1;
+    for (const char *c = key; *c != '\0'; c++)
+    {
+        length += (*c == '~' || *c == '/') ? 2 : 1;
+    }
+    char *pointer = malloc(length + 1);
+    if (pointer == NULL)
+    {
+        return NULL;
+    }
+    char *end = pointer + sizeof(prefix) - 1;
+    memcpy(pointer, prefix, sizeof(prefix) - 1);
+    for (const char *c = key; *c != '\0'; c++)
+    {
+        if (*c == '~' || *c == '/')
+        {
+            *end++ = '~';
+            *end++ = (*c == '~') ? '0' : '1';
+        }
+        else
+        {
+            *end++ = *c;
+        }
+    }
+    *end = '\0';
+
+    cJSON_Path *path = cJSON_PathCompile(pointer);
+    free(pointer);
+    return path;
+}
+
 int parse_json_file(const char *filename, Configuration *configuration, MachineInfo *machine_info)
 {
-    FILE *file = fopen(filename, "r");
+    FILE *file = fopen(filename, "rb");
     if (!file)
     {
         perror("Error opening file");
         return 0;
     }
 
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    char *json_string = malloc(file_size + 1);
-    if (json_string == NULL)
+    // Feed the file to the parser as it is read, there is no need to hold all of it in memory
+    cJSON_PushParser *parser = cJSON_PushParserNew();
+    if (parser == NULL)
     {
         printf("Configuration file could not be read.\n");
+        fclose(file);
         return 0;
     }
-    fread(json_string, 1, file_size, file);
-    json_string[file_size] = '\0';
+    char chunk[16384];
+    size_t chunk_length;
+    while ((chunk_length = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        if (!cJSON_PushParserFeed(parser, chunk, chunk_length))
+        {
+            break;
+        }
+    }
+    int read_error = ferror(file);
     fclose(file);
 
-    cJSON *json = cJSON_Parse(json_string);
-    free(json_string);
+    cJSON_ParseError parse_error;
+    cJSON *json = cJSON_PushParserFinish(parser, &parse_error);
 
+    if (read_error)
+    {
+        printf("Configuration file could not be read.\n");
+        cJSON_Delete(json);
+        return 0;
+    }
     if (!json)
     {
-        const char *error_ptr = cJSON_GetErrorPtr();
-        fprintf(stderr, "JSON parsing error: %s\n", error_ptr);
+        fprintf(stderr, "JSON parsing error in %s at line %lu, column %lu: %s\n", filename,
+                (unsigned long)parse_error.line, (unsigned long)parse_error.column, parse_error.reason);
         return 0;
     }
 
-    // Parse dependencies first
-    cJSON *dependencies = cJSON_GetObjectItemCaseSensitive(json, "dependencies");
-    if (!cJSON_IsArray(dependencies))
+    if (!validate_config(filename, json))
     {
-        fprintf(stderr, "Invalid JSON schema: 'dependencies' should be an array.\n");
         cJSON_Delete(json);
         return 0;
     }
+
+    // Everything below relies on the schema for the types of the fields it reads
+    // Parse dependencies first
+    cJSON *dependencies = cJSON_GetObjectItemCaseSensitive(json, "dependencies");
     configuration->dependency_count = cJSON_GetArraySize(dependencies);
     configuration->dependencies = malloc(configuration->dependency_count * sizeof(Dependency));
     if (configuration->dependencies == NULL)
@@ -208,28 +393,43 @@ int parse_json_file(const char *filename, Configuration *configuration, MachineI
         printf("Memory allocation failed for configuration obj\n");
         return 0;
     }
+
+    // The install command of this machine is at the same place in every dependency, compile its path once
+    const char *install_key = NULL;
+    switch (machine_info->os)
+    {
+    case WIN:
+        install_key = "windows";
+        break;
+    case MACOS:
+        install_key = "macos";
+        break;
+    case LINUX:
+        install_key = machine_info->package_manager;
+        break;
+    }
+    cJSON_Path *install_path = NULL;
+    if (install_key != NULL)
+    {
+        install_path = compile_install_path(install_key);
+        if (install_path == NULL)
+        {
+            printf("Memory allocation failed for configuration obj\n");
+            cJSON_Delete(json);
+            return 0;
+        }
+    }
+
     for (int i = 0; i < configuration->dependency_count; i++)
     {
         cJSON *dep = cJSON_GetArrayItem(dependencies, i);
         cJSON *name = cJSON_GetObjectItemCaseSensitive(dep, "name");
         cJSON *check_command = cJSON_GetObjectItemCaseSensitive(dep, "check_command");
-        cJSON *install_commands = cJSON_GetObjectItemCaseSensitive(dep, "install_commands");
-        cJSON *install_command = NULL;
-        switch (machine_info->os)
-        {
-        case WIN:
-            install_command = cJSON_GetObjectItemCaseSensitive(install_commands, "windows");
-            break;
-        case MACOS:
-            install_command = cJSON_GetObjectItemCaseSensitive(install_commands, "macos");
-            break;
-        case LINUX:
-            install_command = cJSON_GetObjectItemCaseSensitive(install_commands, machine_info->package_manager);
-            break;
-        }
+        cJSON *install_command = cJSON_PathGet(install_path, dep);
         if (install_command == NULL || !cJSON_IsString(install_command))
         {
             printf("Cannot find installation command for dependency: %s\n", name->valuestring);
+            cJSON_PathDelete(install_path);
             cJSON_Delete(json);
             return 0;
         }
@@ -237,6 +437,7 @@ int parse_json_file(const char *filename, Configuration *configuration, MachineI
         configuration->dependencies[i].name = _strdup(name->valuestring);
         configuration->dependencies[i].check_command = _strdup(check_command->valuestring);
     }
+    cJSON_PathDelete(install_path);
 
     // Parse categories
     cJSON *categories_json = cJSON_GetObjectItemCaseSensitive(json, "categories");
@@ -291,17 +492,14 @@ int parse_json_file(const char *filename, Configuration *configuration, MachineI
                 }
                 for (int l = 0; l < configuration->categories[i].frameworks[j].tools[k].dependency_count; l++)
                 {
+                    // validate_config made sure that the dependency is declared
                     cJSON *tool_dep_json = cJSON_GetArrayItem(tool_dependencies, l);
-                    char *dep_key = _strdup(tool_dep_json->valuestring);
-                    for (int m = 0; m < configuration->dependency_count; m++)
+                    int m = 0;
+                    while (strcmp(tool_dep_json->valuestring, configuration->dependencies[m].name) != 0)
                     {
-                        if (strcmp(dep_key, configuration->dependencies[m].name) == 0)
-                        {
-                            configuration->categories[i].frameworks[j].tools[k].dependencies[l].check_command = configuration->dependencies[m].check_command;
-                            configuration->categories[i].frameworks[j].tools[k].dependencies[l].install_command = configuration->dependencies[m].install_command;
-                            configuration->categories[i].frameworks[j].tools[k].dependencies[l].name = configuration->dependencies[m].name;
-                        }
+                        m++;
                     }
+                    configuration->categories[i].frameworks[j].tools[k].dependencies[l] = configuration->dependencies[m];
                 }
                 configuration->categories[i].frameworks[j].tools[k].name = _strdup(tool_name->valuestring);
                 configuration->categories[i].frameworks[j].tools[k].run_command = _strdup(tool_command->valuestring);
@@ -0,0 +1,404 @@
+/*
+  Fuzz equivalence of the CBOR and the text paths.
+
+  Random trees, and the documents given on the command line, have to print the same after a round trip through
+  cJSON_ToCBOR/cJSON_FromCBOR as after one through cJSON_PrintUnformatted/cJSON_Parse. Every truncation of an encoding
+  has to be rejected. Byte mutations of an encoding, and of the printed text, either fail or give a tree that passes
+  both round trips again (only the CBOR one if a mutation made a raw value something the text path would change).
+  Run it under ASan/UBSan to also catch memory errors on the failure paths.
+
+  usage: cbor_test [file.json ...]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "cJSON.h"
+
+#define TREE_COUNT 20000
+#define MUTATIONS_PER_INPUT 20
+
+static unsigned long failures = 0;
+static unsigned long checked = 0;
+
+/* xorshift64, so the generated trees are the same on every run (one call per expression, the order of calls within one
+ * is unspecified) */
+static uint64_t random_state = UINT64_C(0x9E3779B97F4A7C15);
+
+static uint64_t next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+static double random_number(void)
+{
+    static const double special[] =
+    {
+        0.0, 1.0, -1.0, 0.1, 1e22, 1e23, 9007199254740992.0, 9007199254740993.0, 4.9406564584124654e-324,
+        2.2250738585072014e-308, 1.7976931348623157e308, 65504.0, 5.960464477539063e-08, 4294967296.0, -4294967297.0
+    };
+    uint64_t bits = next_random();
+    double number = 0;
+
+    switch (next_random() % 6)
+    {
+    case 0:
+        return special[next_random() % (sizeof(special) / sizeof(special[0]))];
+    case 1:
+        return -0.0;
+    case 2:
+        return (double)(int64_t)(bits >> (next_random() % 64)) * (((bits & 1) != 0) ? -1.0 : 1.0);
+    case 3:
+        return (double)(bits >> 40) / 64.0;
+    case 4:
+        /* includes NaN and infinity, which become null on both paths */
+        memcpy(&number, &bits, sizeof(number));
+        return number;
+    default:
+        return (double)(float)((double)(bits >> 11) / 1024.0);
+    }
+}
+
+/* any bytes but '\0' */
+static void random_string(char* const string, const size_t capacity)
+{
+    size_t length = (size_t)(next_random() % capacity);
+    size_t i = 0;
+
+    for (i = 0; i < length; i++)
+    {
+        string[i] = (char)((next_random() % 255) + 1);
+        if ((next_random() % 2) == 0)
+        {
+            /* mostly printable, so keys repeat now and then */
+            string[i] = (char)('a' + (next_random() % 4));
+        }
+    }
+    string[length] = '\0';
+}
+
+/* mostly a few children, now and then enough for an index */
+static size_t random_count(void)
+{
+    uint64_t limit = ((next_random() % 8) == 0) ? 40 : 5;
+    return (size_t)(next_random() % limit);
+}
+
+static cJSON* random_tree(const int depth)
+{
+    static const char* const raw_values[] = { "1", "[]", "{\"a\":[true,null]}", "\"raw\"", "-2.5" };
+    char string[32];
+    cJSON* item = NULL;
+    size_t count = 0;
+    size_t i = 0;
+
+    switch (next_random() % ((depth > 0) ? 9 : 7))
+    {
+    case 0:
+        return cJSON_CreateNull();
+    case 1:
+        return cJSON_CreateBool((next_random() % 2) == 0);
+    case 2:
+    case 3:
+        return cJSON_CreateNumber(random_number());
+    case 4:
+    case 5:
+        random_string(string, sizeof(string));
+        return cJSON_CreateString(string);
+    case 6:
+        return cJSON_CreateRaw(raw_values[next_random() % (sizeof(raw_values) / sizeof(raw_values[0]))]);
+    case 7:
+        item = cJSON_CreateArray();
+        count = random_count();
+        for (i = 0; i < count; i++)
+        {
+            cJSON_AddItemToArray(item, random_tree(depth - 1));
+        }
+        return item;
+    default:
+        item = cJSON_CreateObject();
+        count = random_count();
+        for (i = 0; i < count; i++)
+        {
+            random_string(string, 8);
+            cJSON_AddItemToObject(item, string, random_tree(depth - 1));
+        }
+        return item;
+    }
+}
+
+/* the printed form of item after a round trip through CBOR, NULL if that fails */
+static char* print_through_cbor(const cJSON* const item)
+{
+    size_t length = 0;
+    unsigned char* encoded = cJSON_ToCBOR(item, &length);
+    cJSON* decoded = NULL;
+    char* printed = NULL;
+
+    if (encoded == NULL)
+    {
+        return NULL;
+    }
+    decoded = cJSON_FromCBOR(encoded, length);
+    if (decoded != NULL)
+    {
+        printed = cJSON_PrintUnformatted(decoded);
+    }
+    cJSON_Delete(decoded);
+    cJSON_free(encoded);
+    return printed;
+}
+
+/* the printed form of item after a round trip through text, NULL if that fails */
+static char* print_through_text(const cJSON* const item)
+{
+    char* text = cJSON_PrintUnformatted(item);
+    cJSON* parsed = NULL;
+    char* printed = NULL;
+
+    if (text == NULL)
+    {
+        return NULL;
+    }
+    parsed = cJSON_ParseWithOpts(text, NULL, 1);
+    if (parsed != NULL)
+    {
+        printed = cJSON_PrintUnformatted(parsed);
+    }
+    cJSON_Delete(parsed);
+    cJSON_free(text);
+    return printed;
+}
+
+/* Raw values are printed verbatim, so the text path only gives the same output if they are printed as they would be
+ * parsed. A mutated encoding can make them anything. */
+static int raw_values_canonical(const cJSON* const item)
+{
+    const cJSON* child = NULL;
+
+    if (cJSON_IsRaw(item))
+    {
+        cJSON* parsed = cJSON_ParseWithOpts(item->valuestring, NULL, 1);
+        char* printed = (parsed != NULL) ? cJSON_PrintUnformatted(parsed) : NULL;
+        int canonical = (printed != NULL) && (strcmp(printed, item->valuestring) == 0);
+
+        cJSON_free(printed);
+        cJSON_Delete(parsed);
+        return canonical;
+    }
+    for (child = item->child; child != NULL; child = child->next)
+    {
+        if (!raw_values_canonical(child))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void check_equivalent(const cJSON* const item, const char* const what)
+{
+    char* original = cJSON_PrintUnformatted(item);
+    char* cbor = print_through_cbor(item);
+    char* text = raw_values_canonical(item) ? print_through_text(item) : NULL;
+
+    checked++;
+    if ((original == NULL) || (cbor == NULL) || (strcmp(original, cbor) != 0) || ((text != NULL) && (strcmp(original, text) != 0))
+        || ((text == NULL) && raw_values_canonical(item)))
+    {
+        printf("FAIL %s:\n  printed    %s\n  via CBOR   %s\n  via text   %s\n", what,
+               (original != NULL) ? original : "(null)", (cbor != NULL) ? cbor : "(null)", (text != NULL) ? text : "(null)");
+        failures++;
+    }
+    cJSON_free(text);
+    cJSON_free(cbor);
+    cJSON_free(original);
+}
+
+static void check_truncations(const unsigned char* const encoded, const size_t length, const char* const what)
+{
+    size_t cut = 0;
+    size_t step = (length > 64) ? (length / 32) : 1;
+
+    for (cut = 0; cut < length; cut += step)
+    {
+        cJSON* decoded = cJSON_FromCBOR(encoded, cut);
+
+        checked++;
+        if (decoded != NULL)
+        {
+            printf("FAIL %s: the first %lu of %lu bytes decode\n", what, (unsigned long)cut, (unsigned long)length);
+            failures++;
+            cJSON_Delete(decoded);
+        }
+    }
+}
+
+static void check_cbor_mutations(const unsigned char* const encoded, const size_t length, const char* const what)
+{
+    unsigned char* mutated = NULL;
+    int i = 0;
+
+    if (length == 0)
+    {
+        return;
+    }
+    mutated = (unsigned char*)malloc(length);
+    if (mutated == NULL)
+    {
+        return;
+    }
+    for (i = 0; i < MUTATIONS_PER_INPUT; i++)
+    {
+        cJSON* decoded = NULL;
+        size_t position = 0;
+
+        memcpy(mutated, encoded, length);
+        position = (size_t)(next_random() % length);
+        mutated[position] = (unsigned char)next_random();
+        if ((next_random() % 2) == 0)
+        {
+            position = (size_t)(next_random() % length);
+            mutated[position] ^= (unsigned char)(1 << (next_random() % 8));
+        }
+        decoded = cJSON_FromCBOR(mutated, length);
+        if (decoded != NULL)
+        {
+            check_equivalent(decoded, what);
+            cJSON_Delete(decoded);
+        }
+    }
+    free(mutated);
+}
+
+static void check_text_mutations(const char* const text, const char* const what)
+{
+    static const char replacements[] = "{}[],:\"\\0123456789.eE+-tfnul x";
+    size_t length = strlen(text);
+    char* mutated = NULL;
+    int i = 0;
+
+    if (length == 0)
+    {
+        return;
+    }
+    mutated = (char*)malloc(length + 1);
+    if (mutated == NULL)
+    {
+        return;
+    }
+    for (i = 0; i < MUTATIONS_PER_INPUT; i++)
+    {
+        cJSON* parsed = NULL;
+        size_t position = 0;
+
+        memcpy(mutated, text, length + 1);
+        position = (size_t)(next_random() % length);
+        mutated[position] = replacements[next_random() % (sizeof(replacements) - 1)];
+        parsed = cJSON_Parse(mutated);
+        if (parsed != NULL)
+        {
+            check_equivalent(parsed, what);
+            cJSON_Delete(parsed);
+        }
+    }
+    free(mutated);
+}
+
+static void check_item(const cJSON* const item, const char* const what)
+{
+    size_t length = 0;
+    unsigned char* encoded = NULL;
+    char* text = NULL;
+
+    check_equivalent(item, what);
+
+    encoded = cJSON_ToCBOR(item, &length);
+    if (encoded == NULL)
+    {
+        printf("FAIL %s: cannot be encoded\n", what);
+        failures++;
+        return;
+    }
+    check_truncations(encoded, length, what);
+    check_cbor_mutations(encoded, length, what);
+    cJSON_free(encoded);
+
+    text = cJSON_PrintUnformatted(item);
+    if (text != NULL)
+    {
+        check_text_mutations(text, what);
+    }
+    cJSON_free(text);
+}
+
+static void check_file(const char* const filename)
+{
+    FILE* file = fopen(filename, "rb");
+    char* text = NULL;
+    long size = 0;
+    cJSON* document = NULL;
+
+    if ((file == NULL) || (fseek(file, 0, SEEK_END) != 0) || ((size = ftell(file)) < 0) || (fseek(file, 0, SEEK_SET) != 0))
+    {
+        printf("FAIL cannot read %s\n", filename);
+        failures++;
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+        return;
+    }
+    text = (char*)malloc((size_t)size + 1);
+    if ((text == NULL) || (fread(text, 1, (size_t)size, file) != (size_t)size))
+    {
+        printf("FAIL cannot read %s\n", filename);
+        failures++;
+        free(text);
+        fclose(file);
+        return;
+    }
+    text[size] = '\0';
+    fclose(file);
+
+    document = cJSON_Parse(text);
+    if (document == NULL)
+    {
+        printf("FAIL %s does not parse\n", filename);
+        failures++;
+    }
+    else
+    {
+        check_item(document, filename);
+    }
+    cJSON_Delete(document);
+    free(text);
+}
+
+int main(int argc, char** argv)
+{
+    char what[32];
+    int i = 0;
+
+    for (i = 1; i < argc; i++)
+    {
+        check_file(argv[i]);
+    }
+    for (i = 0; i < TREE_COUNT; i++)
+    {
+        cJSON* tree = random_tree(4);
+
+        sprintf(what, "random tree %d", i);
+        check_item(tree, what);
+        cJSON_Delete(tree);
+    }
+
+    printf("cbor_test: %lu checks, %lu failures\n", checked, failures);
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
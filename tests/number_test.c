@@ -0,0 +1,158 @@
+/*
+  Checks number parsing against strtod and printing against parsing.
+
+  Every numeral in the corpus (tests/numbers.txt) and a set of generated ones are parsed by cJSON and compared
+  bit for bit with strtod in the "C" locale, both null terminated and through cJSON_ParseWithLength without a
+  terminator. Random doubles are printed by cJSON and have to parse back to the same bits.
+
+  usage: number_test [corpus]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <float.h>
+
+#include "cJSON.h"
+
+#define RANDOM_COUNT 200000
+
+static unsigned long failures = 0;
+static unsigned long checked = 0;
+
+/* xorshift64, so the generated numerals are the same on every run */
+static uint64_t random_state = UINT64_C(0x9E3779B97F4A7C15);
+
+static uint64_t next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+static int same_double(const double a, const double b)
+{
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+static void check_numeral(const char* const numeral)
+{
+    double expected = strtod(numeral, NULL);
+    size_t length = strlen(numeral);
+    char* unterminated = NULL;
+    cJSON* item = NULL;
+
+    checked++;
+
+    item = cJSON_Parse(numeral);
+    if (!cJSON_IsNumber(item) || !same_double(item->valuedouble, expected))
+    {
+        printf("FAIL parse %s: %.17g, strtod %.17g\n", numeral, (item != NULL) ? item->valuedouble : 0.0, expected);
+        failures++;
+    }
+    cJSON_Delete(item);
+
+    /* without a terminator the numeral has to end exactly at the end of the buffer */
+    unterminated = (char*)malloc(length);
+    if (unterminated == NULL)
+    {
+        printf("FAIL out of memory\n");
+        failures++;
+        return;
+    }
+    memcpy(unterminated, numeral, length);
+    item = cJSON_ParseWithLength(unterminated, length);
+    if (!cJSON_IsNumber(item) || !same_double(item->valuedouble, expected))
+    {
+        printf("FAIL parse with length %s: %.17g, strtod %.17g\n", numeral, (item != NULL) ? item->valuedouble : 0.0, expected);
+        failures++;
+    }
+    cJSON_Delete(item);
+    free(unterminated);
+}
+
+/* a number printed by cJSON has to parse back to the same double */
+static void check_round_trip(const double number)
+{
+    cJSON* item = cJSON_CreateNumber(number);
+    char* printed = cJSON_PrintUnformatted(item);
+    cJSON* parsed = cJSON_Parse(printed);
+
+    checked++;
+    if (!cJSON_IsNumber(parsed) || !same_double(parsed->valuedouble, number))
+    {
+        printf("FAIL round trip %.17g: printed %s\n", number, (printed != NULL) ? printed : "(null)");
+        failures++;
+    }
+    cJSON_Delete(parsed);
+    cJSON_free(printed);
+    cJSON_Delete(item);
+}
+
+static void check_corpus(const char* const filename)
+{
+    char line[512];
+    FILE* file = fopen(filename, "r");
+
+    if (file == NULL)
+    {
+        printf("FAIL cannot open %s\n", filename);
+        failures++;
+        return;
+    }
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if ((line[0] == '\0') || (line[0] == '#'))
+        {
+            continue;
+        }
+        check_numeral(line);
+    }
+    fclose(file);
+}
+
+static void check_generated(void)
+{
+    char numeral[64];
+    double number = 0;
+    uint64_t bits = 0;
+    int i = 0;
+
+    for (i = 0; i < RANDOM_COUNT; i++)
+    {
+        uint64_t shift = next_random() % 64;
+        uint64_t mantissa = next_random() >> shift;
+        int exponent = (int)(next_random() % 80) - 40;
+
+        /* integers and short decimals around the exact range, where the fast path decides */
+        sprintf(numeral, "%llu", (unsigned long long)mantissa);
+        check_numeral(numeral);
+        sprintf(numeral, "%llue%d", (unsigned long long)mantissa, exponent);
+        check_numeral(numeral);
+        sprintf(numeral, "-%llu.%03de%d", (unsigned long long)(mantissa >> 10), (int)(next_random() % 1000), exponent);
+        check_numeral(numeral);
+
+        /* any finite double */
+        bits = next_random();
+        memcpy(&number, &bits, sizeof(number));
+        if ((number != number) || (number > DBL_MAX) || (number < -DBL_MAX))
+        {
+            continue;
+        }
+        sprintf(numeral, "%.17g", number);
+        check_numeral(numeral);
+        check_round_trip(number);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    check_corpus((argc > 1) ? argv[1] : "tests/numbers.txt");
+    check_generated();
+
+    printf("number_test: %lu checks, %lu failures\n", checked, failures);
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}